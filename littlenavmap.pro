@@ -163,6 +163,12 @@ SOURCES += src/main.cpp\
     src/route/routenetwork.cpp \
     src/connect/connectdialog.cpp \
     src/connect/connectclient.cpp \
+    src/connect/simdatadispatcher.cpp \
+    src/connect/simdataprocessor.cpp \
+    src/connect/compactprotocol.cpp \
+    src/connect/simdatarecorder.cpp \
+    src/connect/replayconnecthandler.cpp \
+    src/connect/trafficgeneratorhandler.cpp \
     src/mapgui/mappainteraircraft.cpp \
     src/profile/profilewidget.cpp \
     src/common/aircrafttrack.cpp \
@@ -190,6 +196,7 @@ SOURCES += src/main.cpp\
     src/common/textplacement.cpp \
     src/route/routeleg.cpp \
     src/route/route.cpp \
+    src/route/routelegindex.cpp \
     src/search/abstractsearch.cpp \
     src/search/proceduresearch.cpp \
     src/common/proctypes.cpp \
@@ -215,8 +222,15 @@ SOURCES += src/main.cpp\
     src/userdata/userdataicons.cpp \
     src/mapgui/mappainteruser.cpp \
     src/userdata/userdataexportdialog.cpp \
+    src/weather/activeskysnapshot.cpp \
+    src/weather/airportweatheroverlay.cpp \
+    src/weather/metarcache.cpp \
+    src/weather/metarindex.cpp \
+    src/weather/weatherbulkreader.cpp \
     src/weather/weatherreporter.cpp \
     src/online/onlinedatacontroller.cpp \
+    src/online/onlinedownloader.cpp \
+    src/online/whazzupprocessor.cpp \
     src/search/onlineclientsearch.cpp \
     src/search/onlinecentersearch.cpp \
     src/search/onlineserversearch.cpp \
@@ -225,7 +239,9 @@ SOURCES += src/main.cpp\
     src/search/searchbasetable.cpp \
     src/mapgui/mapfunctions.cpp \
     src/common/vehicleicons.cpp \
-    src/route/routeexport.cpp
+    src/route/routeexport.cpp \
+    src/mapgui/mappaintprofiler.cpp \
+    src/mapgui/mapbenchmark.cpp
 
 HEADERS  += src/gui/mainwindow.h \
     src/search/columnlist.h \
@@ -265,6 +281,12 @@ HEADERS  += src/gui/mainwindow.h \
     src/route/routenetwork.h \
     src/connect/connectdialog.h \
     src/connect/connectclient.h \
+    src/connect/simdatadispatcher.h \
+    src/connect/simdataprocessor.h \
+    src/connect/compactprotocol.h \
+    src/connect/simdatarecorder.h \
+    src/connect/replayconnecthandler.h \
+    src/connect/trafficgeneratorhandler.h \
     src/mapgui/mappainteraircraft.h \
     src/profile/profilewidget.h \
     src/common/aircrafttrack.h \
@@ -292,6 +314,7 @@ HEADERS  += src/gui/mainwindow.h \
     src/common/textplacement.h \
     src/route/routeleg.h \
     src/route/route.h \
+    src/route/routelegindex.h \
     src/search/abstractsearch.h \
     src/search/proceduresearch.h \
     src/common/proctypes.h \
@@ -317,8 +340,16 @@ HEADERS  += src/gui/mainwindow.h \
     src/userdata/userdataicons.h \
     src/mapgui/mappainteruser.h \
     src/userdata/userdataexportdialog.h \
+    src/weather/activeskysnapshot.h \
+    src/weather/airportweatheroverlay.h \
+    src/weather/metarcache.h \
+    src/weather/metartypes.h \
+    src/weather/metarindex.h \
+    src/weather/weatherbulkreader.h \
     src/weather/weatherreporter.h \
     src/online/onlinedatacontroller.h \
+    src/online/onlinedownloader.h \
+    src/online/whazzupprocessor.h \
     src/search/onlineclientsearch.h \
     src/search/onlinecentersearch.h \
     src/search/onlineserversearch.h \
@@ -327,7 +358,9 @@ HEADERS  += src/gui/mainwindow.h \
     src/search/searchbasetable.h \
     src/mapgui/mapfunctions.h \
     src/common/vehicleicons.h \
-    src/route/routeexport.h
+    src/route/routeexport.h \
+    src/mapgui/mappaintprofiler.h \
+    src/mapgui/mapbenchmark.h
 
 FORMS    += src/gui/mainwindow.ui \
     src/db/databasedialog.ui \
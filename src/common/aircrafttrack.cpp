@@ -24,10 +24,15 @@
 #include <QDataStream>
 #include <QDateTime>
 #include <QFile>
+#include <QSaveFile>
+
+#include <limits>
+
+const QVector<float> AircraftTrack::SIMPLIFIED_TOLERANCE_METER({250.f, 1000.f, 5000.f, 20000.f});
 
 AircraftTrack::AircraftTrack()
 {
-
+  lastSimplified.resize(SIMPLIFIED_TOLERANCE_METER.size());
 }
 
 AircraftTrack::~AircraftTrack()
@@ -53,24 +58,111 @@ QDataStream& operator<<(QDataStream& dataStream, const at::AircraftTrackPos& tra
 
 void AircraftTrack::saveState()
 {
-  QFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
+  // Store the last position too since it will not be replaced anymore
+  if(hasPending)
+  {
+    appendInternal(pending.pos, pending.timestamp, pending.onGround);
+    hasPending = false;
+    skipped.clear();
+  }
+  flushJournal();
+}
+
+void AircraftTrack::flushJournal()
+{
+  QString filename = atools::settings::Settings::getConfigFilename(".track");
+
+  if(!journalValid || journalIndex < firstIndex || firstIndex - journalFirstIndex >= COMPACT_PRUNED_POSITIONS)
+  {
+    // Rewrite the whole file if it does not match the track or contains too many pruned positions
+    QSaveFile trackFile(filename);
+    if(trackFile.open(QIODevice::WriteOnly))
+    {
+      QDataStream out(&trackFile);
+      out << FILE_MAGIC_NUMBER << FILE_VERSION;
 
-  if(trackFile.open(QIODevice::WriteOnly))
+      for(int i = 0; i < numPositions; i += CHUNK_SIZE)
+        writeJournalBlock(out, i, std::min(i + CHUNK_SIZE, numPositions));
+
+      if(trackFile.commit())
+      {
+        journalValid = true;
+        journalFirstIndex = firstIndex;
+        journalIndex = firstIndex + static_cast<quint64>(numPositions);
+      }
+      else
+        qWarning() << "Cannot write track" << filename << ":" << trackFile.errorString();
+    }
+    else
+      qWarning() << "Cannot write track" << filename << ":" << trackFile.errorString();
+  }
+  else if(journalIndex < firstIndex + static_cast<quint64>(numPositions))
   {
-    QDataStream out(&trackFile);
-    out.setVersion(QDataStream::Qt_5_5);
-    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    // Append all positions stored since the last flush as a new block
+    QFile trackFile(filename);
+    if(trackFile.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+      QDataStream out(&trackFile);
+      writeJournalBlock(out, static_cast<int>(journalIndex - firstIndex), numPositions);
+      trackFile.close();
 
-    out << FILE_MAGIC_NUMBER << FILE_VERSION << *this;
-    trackFile.close();
+      if(out.status() == QDataStream::Ok)
+        journalIndex = firstIndex + static_cast<quint64>(numPositions);
+      else
+        // Rewrite on next flush
+        journalValid = false;
+    }
+    else
+      qWarning() << "Cannot write track" << filename << ":" << trackFile.errorString();
   }
-  else
-    qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
+}
+
+void AircraftTrack::writeJournalBlock(QDataStream& out, int from, int to) const
+{
+  QByteArray bytes;
+  QDataStream blockOut(&bytes, QIODevice::WriteOnly);
+  blockOut.setVersion(QDataStream::Qt_5_5);
+  blockOut.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  for(int i = from; i < to; i++)
+    blockOut << at(i);
+
+  out << BLOCK_MAGIC_NUMBER << static_cast<quint32>(to - from) << static_cast<quint32>(bytes.size())
+      << qChecksum(bytes.constData(), static_cast<uint>(bytes.size()));
+  out.writeRawData(bytes.constData(), bytes.size());
+}
+
+bool AircraftTrack::readJournalBlock(QDataStream& in)
+{
+  quint32 magic, num, size;
+  quint16 checksum;
+  in >> magic >> num >> size >> checksum;
+
+  if(in.status() != QDataStream::Ok || magic != BLOCK_MAGIC_NUMBER || size > MAX_BLOCK_BYTES)
+    return false;
+
+  QByteArray bytes(static_cast<int>(size), '\0');
+  if(in.readRawData(bytes.data(), bytes.size()) != bytes.size() ||
+     qChecksum(bytes.constData(), static_cast<uint>(bytes.size())) != checksum)
+    return false;
+
+  QDataStream blockIn(bytes);
+  blockIn.setVersion(QDataStream::Qt_5_5);
+  blockIn.setFloatingPointPrecision(QDataStream::SinglePrecision);
+  at::AircraftTrackPos trackPos;
+  for(quint32 i = 0; i < num; i++)
+  {
+    blockIn >> trackPos;
+    if(blockIn.status() != QDataStream::Ok)
+      return false;
+
+    appendInternal(trackPos.pos, trackPos.timestamp, trackPos.onGround);
+  }
+  return true;
 }
 
 void AircraftTrack::restoreState()
 {
-  clear();
+  clearTrack();
 
   QFile trackFile(atools::settings::Settings::getConfigFilename(".track"));
   if(trackFile.exists())
@@ -88,9 +180,44 @@ void AircraftTrack::restoreState()
       {
         in >> version;
         if(version == FILE_VERSION)
-          in >> *this;
+        {
+          // Read blocks until end of file or the first incomplete block from an interrupted write
+          journalValid = true;
+          while(!in.atEnd())
+          {
+            if(!readJournalBlock(in))
+            {
+              qWarning() << "Track" << trackFile.fileName() << "is truncated or damaged. Read"
+                         << numPositions << "positions";
+              journalValid = false;
+              break;
+            }
+          }
+          journalIndex = static_cast<quint64>(numPositions);
+        }
+        else if(version == FILE_VERSION_LIST)
+        {
+          // Old format with a list of positions - will be converted on next save
+          quint32 num;
+          in >> num;
+          at::AircraftTrackPos trackPos;
+          for(quint32 i = 0; i < num && in.status() == QDataStream::Ok; i++)
+          {
+            in >> trackPos;
+            if(in.status() == QDataStream::Ok)
+              appendInternal(trackPos.pos, trackPos.timestamp, trackPos.onGround);
+          }
+        }
         else
           qWarning() << "Cannot read track" << trackFile.fileName() << ". Invalid version number:" << version;
+
+        // Apply limit which might have been changed in options
+        while(numPositions > maxTrackEntries && chunks.size() > 1)
+        {
+          numPositions -= chunks.first().positions.size();
+          firstIndex += static_cast<quint64>(chunks.first().positions.size());
+          chunks.removeFirst();
+        }
       }
       else
         qWarning() << "Cannot read track" << trackFile.fileName() << ". Invalid magic number:" << magic;
@@ -102,6 +229,21 @@ void AircraftTrack::restoreState()
   }
 }
 
+void AircraftTrack::clearTrack()
+{
+  chunks.clear();
+  numPositions = 0;
+  firstIndex = 0;
+  hasPending = false;
+  skipped.clear();
+
+  // Truncate file on next flush
+  journalValid = false;
+  for(atools::geo::Pos& pos : lastSimplified)
+    pos = atools::geo::Pos();
+  generation++;
+}
+
 bool AircraftTrack::appendTrackPos(const atools::geo::Pos& pos, const QDateTime& timestamp, bool onGround)
 {
   bool pruned = false;
@@ -110,38 +252,223 @@ bool AircraftTrack::appendTrackPos(const atools::geo::Pos& pos, const QDateTime&
   long timeDiff = onGround ? MIN_POSITION_TIME_DIFF_GROUND_MS : MIN_POSITION_TIME_DIFF_MS;
 
   if(isEmpty())
-    append({pos, timestamp.toTime_t(), onGround});
+    appendInternal(pos, timestamp.toTime_t(), onGround);
   else
   {
+    at::AircraftTrackPos lastPos = last();
     long time = timestamp.toMSecsSinceEpoch();
-    long lastTime = last().timestamp * 1000L;
+    long lastTime = lastPos.timestamp * 1000L;
 
-    if(!pos.almostEqual(last().pos, epsilon) && !atools::almostEqual(lastTime, time, timeDiff))
+    if(!pos.almostEqual(lastPos.pos, epsilon) && !atools::almostEqual(lastTime, time, timeDiff))
     {
-      if(pos.distanceMeterTo(last().pos) > atools::geo::nmToMeter(MAX_POINT_DISTANCE_NM))
+      if(pos.distanceMeterTo(lastPos.pos) > atools::geo::nmToMeter(MAX_POINT_DISTANCE_NM))
       {
-        clear();
+        clearTrack();
         pruned = true;
       }
-      else
+      else if(numPositions > maxTrackEntries && chunks.size() > 1)
       {
-        if(size() > maxTrackEntries)
-        {
-          for(int i = 0; i < PRUNE_TRACK_ENTRIES; i++)
-            removeFirst();
-          pruned = true;
-        }
+        // Drop the oldest chunk at once instead of removing single positions from the front
+        numPositions -= chunks.first().positions.size();
+        firstIndex += static_cast<quint64>(chunks.first().positions.size());
+        chunks.removeFirst();
+        generation++;
+        pruned = true;
       }
-      append({pos, timestamp.toTime_t(), onGround});
+
+      if(isEmpty())
+        appendInternal(pos, timestamp.toTime_t(), onGround);
+      else
+        appendTolerance({pos, timestamp.toTime_t(), onGround});
     }
   }
   return pruned;
 }
 
+void AircraftTrack::appendTolerance(const at::AircraftTrackPos& trackPos)
+{
+  if(hasPending)
+  {
+    if(isWithinTolerance(trackPos))
+      // Drop pending position - new one is on the same line
+      skipped.append(pending);
+    else
+    {
+      appendInternal(pending.pos, pending.timestamp, pending.onGround);
+      skipped.clear();
+    }
+  }
+  pending = trackPos;
+  hasPending = true;
+}
+
+bool AircraftTrack::isWithinTolerance(const at::AircraftTrackPos& trackPos) const
+{
+  if(toleranceMeter <= 0.f || skipped.size() >= MAX_SKIPPED_POSITIONS || chunks.isEmpty() ||
+     pending.onGround != trackPos.onGround)
+    return false;
+
+  at::AircraftTrackPos anchor = unpack(chunks.last().positions.last(), chunks.last().baseTimestamp);
+  if(anchor.onGround != trackPos.onGround)
+    return false;
+
+  float tolerance = trackPos.onGround ? std::min(toleranceMeter, TOLERANCE_GROUND_METER) : toleranceMeter;
+
+  // Check all positions which would be replaced by the line from anchor to new position
+  auto within = [&anchor, &trackPos, tolerance, this](const atools::geo::Pos& pos) -> bool
+  {
+    atools::geo::LineDistance result;
+    pos.distanceMeterToLine(anchor.pos, trackPos.pos, result);
+    if(result.status != atools::geo::ALONG_TRACK || std::abs(result.distance) > tolerance)
+      return false;
+
+    // Compare with altitude interpolated along the line
+    float length = result.distanceFrom1 + result.distanceFrom2;
+    float fraction = length > 0.f ? result.distanceFrom1 / length : 0.f;
+    float alt = anchor.pos.getAltitude() + (trackPos.pos.getAltitude() - anchor.pos.getAltitude()) * fraction;
+    return std::abs(pos.getAltitude() - alt) <= toleranceAltFt;
+  };
+
+  if(!within(pending.pos))
+    return false;
+
+  for(const at::AircraftTrackPos& skippedPos : skipped)
+  {
+    if(!within(skippedPos.pos))
+      return false;
+  }
+  return true;
+}
+
+void AircraftTrack::appendInternal(const atools::geo::Pos& pos, quint32 timestamp, bool onGround)
+{
+  if(chunks.isEmpty() || chunks.last().positions.size() >= CHUNK_SIZE || !fitsChunk(chunks.last(), timestamp))
+  {
+    at::TrackChunk chunk;
+    chunk.positions.reserve(CHUNK_SIZE);
+    chunk.firstIndex = firstIndex + static_cast<quint64>(numPositions);
+    chunk.baseTimestamp = timestamp;
+    chunk.simplified.resize(SIMPLIFIED_TOLERANCE_METER.size());
+    chunk.bounding = atools::geo::Rect(pos);
+
+    // Cover the lines connecting to the previous chunk for all simplification levels
+    if(!chunks.isEmpty())
+    {
+      chunk.bounding.extend(unpackPos(chunks.last().positions.last()));
+      for(const atools::geo::Pos& lastPos : lastSimplified)
+      {
+        if(lastPos.isValid())
+          chunk.bounding.extend(lastPos);
+      }
+    }
+    chunks.append(chunk);
+  }
+
+  at::TrackChunk& chunk = chunks.last();
+  chunk.positions.append(pack(pos, timestamp, onGround, chunk.baseTimestamp));
+  chunk.bounding.extend(pos);
+  chunk.maxAltitude = std::max(chunk.maxAltitude, pos.getAltitude());
+  numPositions++;
+
+  appendSimplified(pos);
+}
+
+void AircraftTrack::appendSimplified(const atools::geo::Pos& pos)
+{
+  at::TrackChunk& chunk = chunks.last();
+  for(int i = 0; i < lastSimplified.size(); i++)
+  {
+    atools::geo::Pos& lastPos = lastSimplified[i];
+    if(!lastPos.isValid() || lastPos.distanceMeterTo(pos) >= SIMPLIFIED_TOLERANCE_METER.at(i))
+    {
+      chunk.simplified[i].append(pos);
+      lastPos = pos;
+    }
+  }
+}
+
+at::AircraftTrackPos AircraftTrack::at(int index) const
+{
+  if(index == numPositions)
+    return pending;
+
+  // Chunks can be smaller than CHUNK_SIZE - find the last chunk starting at or before the index
+  quint64 absIndex = firstIndex + static_cast<quint64>(index);
+  auto it = std::upper_bound(chunks.constBegin(), chunks.constEnd(), absIndex,
+                             [](quint64 idx, const at::TrackChunk& chunk) -> bool
+  {
+    return idx < chunk.firstIndex;
+  });
+  const at::TrackChunk& chunk = *(it - 1);
+  return unpack(chunk.positions.at(static_cast<int>(absIndex - chunk.firstIndex)), chunk.baseTimestamp);
+}
+
+bool AircraftTrack::fitsChunk(const at::TrackChunk& chunk, quint32 timestamp)
+{
+  return timestamp >= chunk.baseTimestamp && timestamp - chunk.baseTimestamp <= MAX_TIME_OFFSET;
+}
+
+at::PackedTrackPos AircraftTrack::pack(const atools::geo::Pos& pos, quint32 timestamp, bool onGround,
+                                       quint32 baseTimestamp)
+{
+  // Clamp to range of about +/-65000 ft
+  float alt = std::round(pos.getAltitude() / ALT_STEP_FT);
+  alt = std::max(static_cast<float>(std::numeric_limits<qint16>::min()),
+                 std::min(static_cast<float>(std::numeric_limits<qint16>::max()), alt));
+
+  return {static_cast<qint32>(std::round(pos.getLonX() * COORD_FACTOR)),
+          static_cast<qint32>(std::round(pos.getLatY() * COORD_FACTOR)),
+          static_cast<qint16>(alt),
+          static_cast<quint16>((timestamp - baseTimestamp) | (onGround ? ON_GROUND_FLAG : 0))};
+}
+
+at::AircraftTrackPos AircraftTrack::unpack(const at::PackedTrackPos& packed, quint32 baseTimestamp)
+{
+  return {unpackPos(packed), baseTimestamp + (packed.timeGround & MAX_TIME_OFFSET),
+          (packed.timeGround & ON_GROUND_FLAG) != 0};
+}
+
+atools::geo::Pos AircraftTrack::unpackPos(const at::PackedTrackPos& packed)
+{
+  return atools::geo::Pos(static_cast<float>(packed.lonX / COORD_FACTOR),
+                          static_cast<float>(packed.latY / COORD_FACTOR), packed.altitude * ALT_STEP_FT);
+}
+
+int AircraftTrack::getSimplifiedLevel(float toleranceMeter) const
+{
+  int level = -1;
+  for(int i = 0; i < SIMPLIFIED_TOLERANCE_METER.size(); i++)
+  {
+    if(SIMPLIFIED_TOLERANCE_METER.at(i) < toleranceMeter)
+      level = i;
+  }
+  return level;
+}
+
+int AircraftTrack::numChunkPositions(const at::TrackChunk& chunk, int level)
+{
+  return level < 0 ? chunk.positions.size() : chunk.simplified.at(level).size();
+}
+
+QVector<atools::geo::Pos> AircraftTrack::chunkPositions(const at::TrackChunk& chunk, int level, int from)
+{
+  if(level >= 0)
+    return chunk.simplified.at(level).mid(from);
+
+  QVector<atools::geo::Pos> positions;
+  positions.reserve(chunk.positions.size() - from);
+  for(int i = from; i < chunk.positions.size(); i++)
+    positions.append(unpackPos(chunk.positions.at(i)));
+  return positions;
+}
+
 float AircraftTrack::getMaxAltitude() const
 {
   float maxAlt = 0.f;
-  for(const at::AircraftTrackPos& trackPos : *this)
-    maxAlt = std::max(maxAlt, trackPos.pos.getAltitude());
+  for(const at::TrackChunk& chunk : chunks)
+    maxAlt = std::max(maxAlt, chunk.maxAltitude);
+
+  if(hasPending)
+    maxAlt = std::max(maxAlt, pending.pos.getAltitude());
   return maxAlt;
 }
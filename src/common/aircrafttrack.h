@@ -19,6 +19,10 @@
 #define LITTLENAVMAP_AIRCRAFTTRACK_H
 
 #include "geo/pos.h"
+#include "geo/rect.h"
+
+#include <QList>
+#include <QVector>
 
 namespace at {
 /* Track position. Can be converted to QVariant and thus be saved to settings */
@@ -32,29 +36,102 @@ struct AircraftTrackPos
 QDataStream& operator>>(QDataStream& dataStream, at::AircraftTrackPos& obj);
 QDataStream& operator<<(QDataStream& dataStream, const at::AircraftTrackPos& obj);
 
+/* Compact track position of 12 bytes. Coordinates are fixed point with a resolution of about one centimeter,
+ * altitude is stored in steps of two feet and the timestamp is relative to the chunk. */
+struct PackedTrackPos
+{
+  qint32 lonX, latY;
+  qint16 altitude;
+
+  /* Seconds since TrackChunk::baseTimestamp in bits 0-14 and on ground flag in bit 15 */
+  quint16 timeGround;
+};
+
+/* Block of track positions. Positions are only appended to the last chunk and chunks are removed
+ * from the front of the track as a whole. */
+struct TrackChunk
+{
+  QVector<PackedTrackPos> positions;
+
+  /* Absolute index of the first position and timestamp all position times are relative to */
+  quint64 firstIndex = 0;
+  quint32 baseTimestamp = 0;
+
+  /* Simplified positions for each level in AircraftTrack::SIMPLIFIED_TOLERANCE_METER */
+  QVector<QVector<atools::geo::Pos> > simplified;
+
+  /* Bounding rectangle of all positions including the last position of the previous chunk
+   * to cover the connecting line */
+  atools::geo::Rect bounding;
+  float maxAltitude = 0.f;
+};
+
 }
 
 Q_DECLARE_TYPEINFO(at::AircraftTrackPos, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(at::PackedTrackPos, Q_PRIMITIVE_TYPE);
 Q_DECLARE_METATYPE(at::AircraftTrackPos);
 
 /*
- * Stores the track of the flight simulator aircraft
+ * Stores the track of the flight simulator aircraft.
+ *
+ * Positions are kept in chunks of up to CHUNK_SIZE positions. A new chunk is also started if a timestamp
+ * cannot be stored relative to the current chunk. Appending and pruning are O(1) since pruning drops the first
+ * chunk. Index + getFirstIndex() is stable for a position until it is pruned.
+ *
+ * Positions are simplified while appending: the last received position is kept as pending and replaces
+ * the previous pending one as long as all skipped positions are within the lateral and altitude tolerance
+ * of the line from the last stored position. The pending position is accessible as the last track position
+ * but is not part of the chunks.
  */
-class AircraftTrack :
-  private QList<at::AircraftTrackPos>
+class AircraftTrack
 {
 public:
+  /* Read only iterator returning track positions by value */
+  class const_iterator
+  {
+public:
+    const_iterator(const AircraftTrack *trackParam, int indexParam)
+      : track(trackParam), index(indexParam)
+    {
+    }
+
+    at::AircraftTrackPos operator*() const
+    {
+      return track->at(index);
+    }
+
+    const_iterator& operator++()
+    {
+      index++;
+      return *this;
+    }
+
+    bool operator!=(const const_iterator& other) const
+    {
+      return index != other.index || track != other.track;
+    }
+
+private:
+    const AircraftTrack *track;
+    int index;
+  };
+
   AircraftTrack();
   ~AircraftTrack();
 
-  /* Saves and restores track into a separate file (little_navmap.track) */
+  /* Saves and restores track into a separate file (little_navmap.track).
+   * The file is a journal of checksummed blocks. Saving appends all positions added since the last save as a
+   * new block. The file is rewritten if the track was cleared or too many positions were pruned.
+   * Restoring stops at the first damaged block which can be caused by a crash while writing.
+   * saveState() also stores the pending position. */
   void saveState();
   void restoreState();
 
-  void clearTrack()
-  {
-    clear();
-  }
+  /* Append positions to the journal except the pending one. Call periodically. */
+  void flushJournal();
+
+  void clearTrack();
 
   /*
    * Add a track position. Accurracy depends on the ground flag which will cause more
@@ -65,25 +142,159 @@ public:
 
   float getMaxAltitude() const;
 
-  /* Pull only needed methods into public space */
-  using QList::isEmpty;
-  using QList::first;
-  using QList::last;
-  using QList::size;
-  using QList::at;
-  using QList::begin;
-  using QList::end;
+  bool isEmpty() const
+  {
+    return numPositions == 0 && !hasPending;
+  }
+
+  int size() const
+  {
+    return hasPending ? numPositions + 1 : numPositions;
+  }
+
+  /* Index is relative to the first position */
+  at::AircraftTrackPos at(int index) const;
+
+  at::AircraftTrackPos first() const
+  {
+    return at(0);
+  }
+
+  at::AircraftTrackPos last() const
+  {
+    return at(size() - 1);
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator end() const
+  {
+    return const_iterator(this, size());
+  }
+
+  /* Number of positions pruned since the last clear. Adding this to an index gives a stable index. */
+  quint64 getFirstIndex() const
+  {
+    return firstIndex;
+  }
 
   void setMaxTrackEntries(int value)
   {
     maxTrackEntries = value;
   }
 
+  /* Maximum lateral deviation in meter and altitude deviation in feet of skipped positions.
+   * Simplification is disabled if the lateral tolerance is zero. */
+  void setTolerance(float meter, float altFt)
+  {
+    toleranceMeter = meter;
+    toleranceAltFt = altFt;
+  }
+
+  /* Chunks for painters which can skip chunks outside of the view by using the bounding rectangle.
+   * Does not contain the pending position. */
+  const QList<at::TrackChunk>& getChunks() const
+  {
+    return chunks;
+  }
+
+  /*
+   * Simplified track for a zoom level is stored in TrackChunk::simplified. Each level skips positions closer
+   * than the level tolerance to the previous one. Full detail is taken directly from the chunk positions.
+   * Levels are updated incrementally when appending positions. The last track position is not
+   * necessarily part of a simplified level.
+   */
+  /* Get the highest simplification level having a tolerance smaller than the given value or -1 for
+   * all positions */
+  int getSimplifiedLevel(float toleranceMeter) const;
+
+  /* Number of positions in chunk for a simplification level. Level -1 refers to all positions. */
+  static int numChunkPositions(const at::TrackChunk& chunk, int level);
+
+  /* Positions of chunk for a simplification level starting at index from. Level -1 refers to all positions. */
+  static QVector<atools::geo::Pos> chunkPositions(const at::TrackChunk& chunk, int level, int from);
+
+  /* Changed whenever positions are removed from the track. Positions were only appended if the number is
+   * unchanged. Used to invalidate cached screen coordinates. */
+  quint32 getGeneration() const
+  {
+    return generation;
+  }
+
 private:
+  /* Replace pending position if skipping it stays within tolerance. Otherwise store pending. */
+  void appendTolerance(const at::AircraftTrackPos& trackPos);
+  bool isWithinTolerance(const at::AircraftTrackPos& trackPos) const;
+
+  /* Append without any checks */
+  void appendInternal(const atools::geo::Pos& pos, quint32 timestamp, bool onGround);
+
+  /* Append position to all levels of the last chunk where it is far enough from the last one */
+  void appendSimplified(const atools::geo::Pos& pos);
+
+  /* Write positions from index to index exclusive as one block */
+  void writeJournalBlock(QDataStream& out, int from, int to) const;
+
+  /* Read a block and append positions. Returns false if block is incomplete or damaged. */
+  bool readJournalBlock(QDataStream& in);
+
+  /* True if timestamp can be stored relative to the chunk base timestamp */
+  static bool fitsChunk(const at::TrackChunk& chunk, quint32 timestamp);
+
+  static at::PackedTrackPos pack(const atools::geo::Pos& pos, quint32 timestamp, bool onGround,
+                                 quint32 baseTimestamp);
+  static at::AircraftTrackPos unpack(const at::PackedTrackPos& packed, quint32 baseTimestamp);
+  static atools::geo::Pos unpackPos(const at::PackedTrackPos& packed);
+
+  QList<at::TrackChunk> chunks;
+  int numPositions = 0;
+  quint64 firstIndex = 0;
+  quint32 generation = 0;
+
+  /* Last received position which is not stored in the chunks yet */
+  at::AircraftTrackPos pending;
+  bool hasPending = false;
+
+  /* Positions dropped since the last stored position. Needed to check the error bound. */
+  QVector<at::AircraftTrackPos> skipped;
+
+  float toleranceMeter = 50.f, toleranceAltFt = 100.f;
+
+  /* True if the file matches the track. journalFirstIndex and journalIndex are the absolute index range
+   * of the positions in the file. */
+  bool journalValid = false;
+  quint64 journalFirstIndex = 0, journalIndex = 0;
+
+  /* Last position added to each simplification level across chunks */
+  QVector<atools::geo::Pos> lastSimplified;
+
+  /* Distance tolerance for each simplification level */
+  static const QVector<float> SIMPLIFIED_TOLERANCE_METER;
+
+  /* Maximum number of positions per chunk. Pruning removes up to this number of entries at once. */
+  static Q_DECL_CONSTEXPR int CHUNK_SIZE = 1024;
+
+  /* Fixed point coordinate factor */
+  static Q_DECL_CONSTEXPR double COORD_FACTOR = 10000000.;
+
+  /* Feet per altitude step */
+  static Q_DECL_CONSTEXPR float ALT_STEP_FT = 2.f;
+
+  /* Largest time offset in seconds and ground flag in PackedTrackPos::timeGround */
+  static Q_DECL_CONSTEXPR quint16 MAX_TIME_OFFSET = 0x7fff;
+  static Q_DECL_CONSTEXPR quint16 ON_GROUND_FLAG = 0x8000;
+
+  /* Limits the number of positions checked for each new one */
+  static Q_DECL_CONSTEXPR int MAX_SKIPPED_POSITIONS = 500;
+
+  /* Taxi paths need a smaller tolerance */
+  static Q_DECL_CONSTEXPR float TOLERANCE_GROUND_METER = 5.f;
+
   /* Maximum number of track points. If exceeded entries will be removed from beginning of the list */
   int maxTrackEntries = 20000;
-  /* Number of entries to remove at once */
-  static Q_DECL_CONSTEXPR int PRUNE_TRACK_ENTRIES = 200;
 
   /* Minimum time difference between recordings */
   static Q_DECL_CONSTEXPR int MIN_POSITION_TIME_DIFF_MS = 1000;
@@ -93,9 +304,19 @@ private:
   static Q_DECL_CONSTEXPR int MAX_POINT_DISTANCE_NM = 2000;
 
   static Q_DECL_CONSTEXPR quint32 FILE_MAGIC_NUMBER = 0x5B6C1A2B;
+  static Q_DECL_CONSTEXPR quint32 BLOCK_MAGIC_NUMBER = 0x5B6C1A2C;
 
   /* Version 2 to adds timstamp and single floating point precision */
-  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 2;
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION_LIST = 2;
+
+  /* Version 3 stores a journal of checksummed blocks */
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 3;
+
+  /* Rewrite file if it contains more pruned positions */
+  static Q_DECL_CONSTEXPR quint64 COMPACT_PRUNED_POSITIONS = CHUNK_SIZE * 4;
+
+  /* Sanity check for block size when reading */
+  static Q_DECL_CONSTEXPR quint32 MAX_BLOCK_BYTES = 64 * 1024 * 1024;
 };
 
 #endif // LITTLENAVMAP_AIRCRAFTTRACK_H
@@ -183,9 +183,22 @@ const QLatin1Literal OPTIONS_LANGUAGE("Options/Language");
 const QLatin1Literal OPTIONS_MARBLE_DEBUG("Options/MarbleDebug");
 const QLatin1Literal OPTIONS_CONNECTCLIENT_DEBUG("Options/ConnectClientDebug");
 const QLatin1Literal OPTIONS_DATAREADER_DEBUG("Options/DataReaderDebug");
+const QLatin1Literal OPTIONS_CONNECTCLIENT_COMPACT("Options/ConnectClientCompactProtocol");
+const QLatin1Literal OPTIONS_CONNECTCLIENT_STATISTICS("Options/ConnectClientStatistics");
+const QLatin1Literal OPTIONS_TRACK_TOLERANCE_METER("Options/AircraftTrackToleranceMeter");
+const QLatin1Literal OPTIONS_TRACK_TOLERANCE_ALT_FT("Options/AircraftTrackToleranceAltFt");
+const QLatin1Literal OPTIONS_ONLINE_EXTRAPOLATE_MS("Options/OnlineExtrapolateMs");
+const QLatin1Literal OPTIONS_ONLINE_EXTRAPOLATE_MAX_SECONDS("Options/OnlineExtrapolateMaxSeconds");
 const QLatin1Literal OPTIONS_VERSION("Options/Version");
 const QLatin1Literal OPTIONS_NO_USER_AGENT("Options/NoUserAgent");
 const QLatin1Literal OPTIONS_WEATHER_UPDATE("Options/WeatherUpdate");
+const QLatin1Literal OPTIONS_WEATHER_NOAA_BULK_URL("Options/WeatherNoaaBulkUrl");
+const QLatin1Literal OPTIONS_WEATHER_PRELOAD_TRACK_DIST_NM("Options/WeatherPreloadTrackDistanceNm");
+const QLatin1Literal OPTIONS_WEATHER_PRELOAD_PARALLEL("Options/WeatherPreloadParallelDownloads");
+
+/* Map painter profiling. Show statistics on the map and/or write them into little_navmap_paint_profile.csv */
+const QLatin1Literal OPTIONS_MAP_PROFILE_OVERLAY("Options/MapProfileOverlay");
+const QLatin1Literal OPTIONS_MAP_PROFILE_CSV("Options/MapProfileCsv");
 
 /* Used to override  default URL */
 const QLatin1Literal OPTIONS_UPDATE_URL("Update/Url");
@@ -20,15 +20,23 @@
 #include "atools.h"
 #include "geo/pos.h"
 #include "geo/line.h"
+#include "geo/linestring.h"
+#include "geo/calculations.h"
 
 #include <marble/ViewportParams.h>
+#include <marble/Quaternion.h>
 
 #include <QLineF>
+#include <QBitArray>
 
 using namespace Marble;
 using namespace atools::geo;
 
 const QSize CoordinateConverter::DEFAULT_WTOS_SIZE(100, 100);
+std::atomic<quint64> CoordinateConverter::wToSCallCount(0);
+
+/* Latitude limit of the Mercator projection in Marble */
+static const double MAX_MERCATOR_LAT = 85.05113;
 
 CoordinateConverter::CoordinateConverter(const ViewportParams *viewportParams)
   : viewport(viewportParams)
@@ -201,6 +209,158 @@ QPoint CoordinateConverter::wToS(const Marble::GeoDataCoordinates& coords, const
   }
 }
 
+int CoordinateConverter::wToS(const atools::geo::LineString& coords, QVector<QPointF>& points, QBitArray *visible,
+                              QBitArray *hidden, const QSize& size) const
+{
+  return wToSBatch(coords, points, visible, hidden, size);
+}
+
+int CoordinateConverter::wToS(const QVector<atools::geo::Pos>& coords, QVector<QPointF>& points, QBitArray *visible,
+                              QBitArray *hidden, const QSize& size) const
+{
+  return wToSBatch(coords, points, visible, hidden, size);
+}
+
+template<typename CONTAINER>
+int CoordinateConverter::wToSBatch(const CONTAINER& coords, QVector<QPointF>& points, QBitArray *visible,
+                                   QBitArray *hidden, const QSize& size) const
+{
+  const int num = coords.size();
+  points.resize(num);
+  if(visible != nullptr)
+    visible->fill(false, num);
+  if(hidden != nullptr)
+    hidden->fill(false, num);
+
+  if(num == 0)
+    return 0;
+
+  Marble::Projection projection = viewport->projection();
+  int numVisible = 0;
+
+  if((projection != Marble::Spherical && projection != Marble::Mercator) || viewport->radius() <= 0)
+  {
+    // Fall back to single point conversion for all other projections ========================
+    for(int i = 0; i < num; i++)
+    {
+      double x, y;
+      bool isHidden = false;
+      bool isVisible = wToS(coords.at(i), x, y, size, &isHidden);
+      points[i] = QPointF(x, y);
+
+      if(visible != nullptr && isVisible)
+        visible->setBit(i);
+      if(hidden != nullptr && isHidden)
+        hidden->setBit(i);
+      if(isVisible)
+        numVisible++;
+    }
+    return numVisible;
+  }
+
+  wToSCallCount.fetch_add(static_cast<quint64>(num), std::memory_order_relaxed);
+
+  // Copy coordinates into separate arrays and convert to radians ========================
+  QVector<double> lonRad(num), latRad(num), xs(num), ys(num);
+  QVector<bool> valid(num);
+  for(int i = 0; i < num; i++)
+  {
+    const Pos& pos = coords.at(i);
+    valid[i] = pos.isValid();
+    lonRad[i] = valid.at(i) ? atools::geo::toRadians(static_cast<double>(pos.getLonX())) : 0.;
+    latRad[i] = valid.at(i) ? atools::geo::toRadians(static_cast<double>(pos.getLatY())) : 0.;
+  }
+
+  const double width = viewport->width(), height = viewport->height();
+  const double radius = viewport->radius();
+  const double halfSizeW = size.width() / 2., halfSizeH = size.height() / 2.;
+
+  if(projection == Marble::Spherical)
+  {
+    // Rotate unit vectors by planet axis - same as Marble::SphericalProjection::screenCoordinates
+    // with altitude zero. No branches in the loop to allow the compiler to vectorize it.
+    const Marble::matrix& m = viewport->planetAxisMatrix();
+    QVector<double> zs(num);
+    for(int i = 0; i < num; i++)
+    {
+      double cosLat = std::cos(latRad.at(i));
+      double qx = cosLat * std::sin(lonRad.at(i)), qy = std::sin(latRad.at(i)), qz = cosLat * std::cos(lonRad.at(i));
+
+      xs[i] = width / 2. + radius * (m[0][0] * qx + m[1][0] * qy + m[2][0] * qz);
+      ys[i] = height / 2. - radius * (m[0][1] * qx + m[1][1] * qy + m[2][1] * qz);
+      zs[i] = m[0][2] * qx + m[1][2] * qy + m[2][2] * qz;
+    }
+
+    for(int i = 0; i < num; i++)
+    {
+      if(!valid.at(i))
+      {
+        points[i] = QPointF(0., 0.);
+        continue;
+      }
+
+      bool isHidden = zs.at(i) < 0.;
+      // Same margin as Marble::SphericalProjection::screenCoordinates
+      bool isVisible = !isHidden && xs.at(i) + halfSizeW >= 0. && xs.at(i) < width + halfSizeW &&
+                       ys.at(i) + halfSizeH >= 0. && ys.at(i) < height + halfSizeH;
+      points[i] = QPointF(xs.at(i), ys.at(i));
+
+      if(visible != nullptr && isVisible)
+        visible->setBit(i);
+      if(hidden != nullptr && isHidden)
+        hidden->setBit(i);
+      if(isVisible)
+        numVisible++;
+    }
+  }
+  else
+  {
+    // Same as Marble::MercatorProjection::screenCoordinates including the search for the
+    // leftmost repetition. Nothing is hidden in this projection.
+    const double rad2Pixel = 2. * radius / M_PI;
+    const double centerLon = viewport->centerLongitude();
+    const double centerLatInv = std::atanh(std::sin(viewport->centerLatitude()));
+    const double maxLat = atools::geo::toRadians(MAX_MERCATOR_LAT);
+    const double repeat = 4. * radius;
+
+    for(int i = 0; i < num; i++)
+    {
+      double lat = std::min(std::max(latRad.at(i), -maxLat), maxLat);
+      xs[i] = width / 2. + rad2Pixel * (lonRad.at(i) - centerLon);
+      ys[i] = height / 2. - rad2Pixel * (std::atanh(std::sin(lat)) - centerLatInv);
+    }
+
+    for(int i = 0; i < num; i++)
+    {
+      if(!valid.at(i))
+      {
+        points[i] = QPointF(0., 0.);
+        continue;
+      }
+
+      double x = xs.at(i), y = ys.at(i);
+      bool isVisible = false;
+      if(std::abs(latRad.at(i)) <= maxLat && y + halfSizeH >= 0. && y < height + halfSizeH)
+      {
+        // Move to the leftmost repetition which is still at least partially visible
+        double leftX = x - repeat * (std::ceil((x + halfSizeW) / repeat) - 1.);
+        if(leftX - halfSizeW < width)
+        {
+          x = leftX;
+          isVisible = true;
+        }
+      }
+      points[i] = QPointF(x, y);
+
+      if(visible != nullptr && isVisible)
+        visible->setBit(i);
+      if(isVisible)
+        numVisible++;
+    }
+  }
+  return numVisible;
+}
+
 bool CoordinateConverter::sToW(int x, int y, Marble::GeoDataCoordinates& coords) const
 {
   qreal lon, lat;
@@ -236,6 +396,8 @@ Pos CoordinateConverter::sToW(const QPointF& point) const
 bool CoordinateConverter::wToSInternal(const Marble::GeoDataCoordinates& coords, double& x, double& y,
                                        const QSize& size, bool *isHidden) const
 {
+  wToSCallCount.fetch_add(1, std::memory_order_relaxed);
+
   bool hidden;
   int numPoints;
   qreal xordinates[100];
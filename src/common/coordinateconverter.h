@@ -22,6 +22,11 @@
 
 #include <QPoint>
 #include <QSize>
+#include <QVector>
+
+#include <atomic>
+
+class QBitArray;
 
 namespace Marble {
 class ViewportParams;
@@ -31,6 +36,7 @@ namespace atools {
 namespace geo {
 class Pos;
 class Line;
+class LineString;
 }
 }
 
@@ -103,6 +109,24 @@ public:
   bool wToS(const atools::geo::Line& coords, QLineF& line, const QSize& size = DEFAULT_WTOS_SIZE,
             bool *isHidden = nullptr) const;
 
+  /*
+   * Convert a list of world coordinates to screen coordinates in one call.
+   * Viewport parameters are fetched only once and the projection is done in plain loops over arrays for the
+   * spherical and Mercator projections. Results are the same as calling wToS for each point.
+   * Other projections fall back to single point conversion.
+   *
+   * @param coords world coordinates. Invalid positions result in a null point which is not visible.
+   * @param points resulting screen coordinates. Will be resized to size of coords.
+   * @param visible if not null will be resized and contain a bit for each visible point
+   * @param hidden if not null will be resized and contain a bit for each point hidden behind the globe
+   * @param size estimated screen size of the object. Points are visible if the object is partially visible.
+   * @return number of visible points
+   */
+  int wToS(const atools::geo::LineString& coords, QVector<QPointF>& points, QBitArray *visible = nullptr,
+           QBitArray *hidden = nullptr, const QSize& size = DEFAULT_WTOS_SIZE) const;
+  int wToS(const QVector<atools::geo::Pos>& coords, QVector<QPointF>& points, QBitArray *visible = nullptr,
+           QBitArray *hidden = nullptr, const QSize& size = DEFAULT_WTOS_SIZE) const;
+
   bool sToW(int x, int y, Marble::GeoDataCoordinates& coords) const;
 
   /* Converte screen to world coordinates */
@@ -111,6 +135,13 @@ public:
   atools::geo::Pos sToW(const QPoint& point) const;
   atools::geo::Pos sToW(const QPointF& point) const;
 
+  /* Number of world to screen conversions done by all instances since program start. Used for profiling.
+   * Thread safe since converters are also used in background threads. */
+  static quint64 getWToSCallCount()
+  {
+    return wToSCallCount.load(std::memory_order_relaxed);
+  }
+
   /* Shortcuts for more readable code */
   static Q_DECL_CONSTEXPR Marble::GeoDataCoordinates::Unit DEG = Marble::GeoDataCoordinates::Degree;
   static Q_DECL_CONSTEXPR Marble::GeoDataCoordinates::BearingType INITBRG =
@@ -122,8 +153,13 @@ private:
   bool wToSInternal(const Marble::GeoDataCoordinates& coords, double& x, double& y, const QSize& size,
                     bool *isHidden) const;
 
+  template<typename CONTAINER>
+  int wToSBatch(const CONTAINER& coords, QVector<QPointF>& points, QBitArray *visible, QBitArray *hidden,
+                const QSize& size) const;
+
   const Marble::ViewportParams *viewport;
 
+  static std::atomic<quint64> wToSCallCount;
 };
 
 #endif // LITTLENAVMAP_COORDINATECONVERTER_H
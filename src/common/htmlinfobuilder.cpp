@@ -41,6 +41,8 @@
 #include "common/unit.h"
 #include "fs/weather/metar.h"
 #include "fs/weather/metarparser.h"
+#include "weather/metarcache.h"
+#include "weather/weatherreporter.h"
 #include "common/vehicleicons.h"
 
 #include <QSize>
@@ -274,26 +276,26 @@ void HtmlInfoBuilder::airportText(const MapAirport& airport, const map::WeatherC
     if(!fsMetar.isEmpty())
     {
       QString sim = tr("%1 ").arg(NavApp::getCurrentSimulatorShortName());
-      addMetarLine(html, tr("%1Station").arg(
-                     sim), fsMetar.metarForStation, fsMetar.requestIdent, fsMetar.timestamp, true);
-      addMetarLine(html, tr("%1Nearest").arg(
-                     sim), fsMetar.metarForNearest, fsMetar.requestIdent, fsMetar.timestamp, true);
-      addMetarLine(html, tr("%1Interpolated").arg(sim),
-                   fsMetar.metarForInterpolated, fsMetar.requestIdent, fsMetar.timestamp, true);
+      addMetarLine(html, tr("%1Station").arg(sim), fsMetar.metarForStation, metar::SIMULATOR,
+                   fsMetar.requestIdent, fsMetar.timestamp, true);
+      addMetarLine(html, tr("%1Nearest").arg(sim), fsMetar.metarForNearest, metar::SIMULATOR,
+                   fsMetar.requestIdent, fsMetar.timestamp, true);
+      addMetarLine(html, tr("%1Interpolated").arg(sim), fsMetar.metarForInterpolated, metar::SIMULATOR,
+                   fsMetar.requestIdent, fsMetar.timestamp, true);
     }
 
-    addMetarLine(html, weatherContext.asType, weatherContext.asMetar);
+    addMetarLine(html, weatherContext.asType, weatherContext.asMetar, metar::ACTIVESKY);
 
-    addMetarLine(html, tr("NOAA Station"), weatherContext.noaaMetar.metarForStation,
+    addMetarLine(html, tr("NOAA Station"), weatherContext.noaaMetar.metarForStation, metar::NOAA,
                  weatherContext.noaaMetar.requestIdent, weatherContext.noaaMetar.timestamp);
-    addMetarLine(html, tr("NOAA Nearest"), weatherContext.noaaMetar.metarForNearest,
+    addMetarLine(html, tr("NOAA Nearest"), weatherContext.noaaMetar.metarForNearest, metar::NOAA,
                  weatherContext.noaaMetar.requestIdent, weatherContext.noaaMetar.timestamp);
 
-    addMetarLine(html, tr("VATSIM"), weatherContext.vatsimMetar);
+    addMetarLine(html, tr("VATSIM"), weatherContext.vatsimMetar, metar::VATSIM);
 
-    addMetarLine(html, tr("IVAO Station"), weatherContext.ivaoMetar.metarForStation,
+    addMetarLine(html, tr("IVAO Station"), weatherContext.ivaoMetar.metarForStation, metar::IVAO,
                  weatherContext.ivaoMetar.requestIdent, weatherContext.ivaoMetar.timestamp);
-    addMetarLine(html, tr("IVAO Nearest"), weatherContext.ivaoMetar.metarForNearest,
+    addMetarLine(html, tr("IVAO Nearest"), weatherContext.ivaoMetar.metarForNearest, metar::IVAO,
                  weatherContext.ivaoMetar.requestIdent, weatherContext.ivaoMetar.timestamp);
     html.tableEnd();
   }
@@ -1038,6 +1040,7 @@ static const Flags WEATHER_TITLE_FLAGS = atools::util::html::BOLD | atools::util
 void HtmlInfoBuilder::weatherText(const map::WeatherContext& context, const MapAirport& airport,
                                   atools::util::HtmlBuilder& html) const
 {
+  MetarCache *metarCache = NavApp::getWeatherReporter()->getMetarCache();
 
   if(info)
   {
@@ -1055,7 +1058,8 @@ void HtmlInfoBuilder::weatherText(const map::WeatherContext& context, const MapA
 
       if(!metar.metarForStation.isEmpty())
       {
-        Metar met(metar.metarForStation, metar.requestIdent, metar.timestamp, true);
+        const Metar& met = *metarCache->getMetar(metar::SIMULATOR, metar.metarForStation, metar.requestIdent,
+                                                 metar.timestamp, true);
 
         html.p(tr("%1Station Weather").arg(sim), WEATHER_TITLE_FLAGS);
         decodedMetar(html, airport, map::MapAirport(), met, false /* interpolated */, fsxP3d);
@@ -1063,8 +1067,9 @@ void HtmlInfoBuilder::weatherText(const map::WeatherContext& context, const MapA
 
       if(!metar.metarForNearest.isEmpty())
       {
-        Metar met(metar.metarForNearest, metar.requestIdent, metar.timestamp, true);
-        QString reportIcao = met.getParsedMetar().isValid() ? met.getParsedMetar().getId() : met.getStation();
+        QSharedPointer<const Metar> met = metarCache->getMetar(metar::SIMULATOR, metar.metarForNearest,
+                                                               metar.requestIdent, metar.timestamp, true);
+        QString reportIcao = met->getParsedMetar().isValid() ? met->getParsedMetar().getId() : metar.requestIdent;
 
         html.p(tr("%2Nearest Weather - %1").arg(reportIcao).arg(sim), WEATHER_TITLE_FLAGS);
 
@@ -1079,13 +1084,14 @@ void HtmlInfoBuilder::weatherText(const map::WeatherContext& context, const MapA
                  atools::util::html::LINK_NO_UL);
         }
 
-        decodedMetar(html, airport, reportAirport, met, false /* interpolated */, fsxP3d);
+        decodedMetar(html, airport, reportAirport, *met, false /* interpolated */, fsxP3d);
       }
 
       if(!metar.metarForInterpolated.isEmpty())
       {
-        Metar met(metar.metarForInterpolated, metar.requestIdent, metar.timestamp, fsxP3d);
-        html.p(tr("%2Interpolated Weather - %1").arg(met.getStation()).arg(sim), WEATHER_TITLE_FLAGS);
+        const Metar& met = *metarCache->getMetar(metar::SIMULATOR, metar.metarForInterpolated, metar.requestIdent,
+                                                 metar.timestamp, fsxP3d);
+        html.p(tr("%2Interpolated Weather - %1").arg(metar.requestIdent).arg(sim), WEATHER_TITLE_FLAGS);
         decodedMetar(html, airport, map::MapAirport(), met, true /* interpolated */, fsxP3d);
       }
     }
@@ -1104,42 +1110,52 @@ void HtmlInfoBuilder::weatherText(const map::WeatherContext& context, const MapA
       else
         html.p(context.asType, WEATHER_TITLE_FLAGS);
 
-      decodedMetar(html, airport, map::MapAirport(), Metar(context.asMetar), false /* interpolated */,
-                   false /* FSX/P3D */);
+      decodedMetar(html, airport, map::MapAirport(), *metarCache->getMetar(metar::ACTIVESKY, context.asMetar,
+                                                                       QString(), QDateTime(),
+                                                                       metar::simFormat(metar::ACTIVESKY)),
+                   false /* interpolated */, false /* FSX/P3D */);
     }
 
     // NOAA or nearest
-    decodedMetars(html, context.noaaMetar, airport, tr("NOAA"));
+    decodedMetars(html, context.noaaMetar, airport, tr("NOAA"), metar::NOAA);
 
     // Vatsim metar ===========================
     if(!context.vatsimMetar.isEmpty())
     {
       html.p(tr("VATSIM Weather"), WEATHER_TITLE_FLAGS);
-      decodedMetar(html, airport, map::MapAirport(), Metar(context.vatsimMetar),
+      decodedMetar(html, airport, map::MapAirport(), *metarCache->getMetar(metar::VATSIM, context.vatsimMetar,
+                                                                       QString(), QDateTime(),
+                                                                       metar::simFormat(metar::VATSIM)),
                    false /* interpolated */, false /* FSX/P3D */);
     }
 
     // IVAO or nearest
-    decodedMetars(html, context.ivaoMetar, airport, tr("IVAO"));
+    decodedMetars(html, context.ivaoMetar, airport, tr("IVAO"), metar::IVAO);
   }
 }
 
 void HtmlInfoBuilder::decodedMetars(HtmlBuilder& html, const atools::fs::weather::MetarResult& metar,
-                                    const map::MapAirport& airport, const QString& name) const
+                                    const map::MapAirport& airport, const QString& name,
+                                    metar::Source source) const
 {
+  MetarCache *metarCache = NavApp::getWeatherReporter()->getMetarCache();
+
   if(metar.isValid())
   {
     if(!metar.metarForStation.isEmpty())
     {
       html.p(tr("%1 Station Weather").arg(name), WEATHER_TITLE_FLAGS);
       decodedMetar(html, airport, map::MapAirport(),
-                   Metar(metar.metarForStation, metar.requestIdent, metar.timestamp, true), false, false);
+                   *metarCache->getMetar(source, metar.metarForStation, metar.requestIdent, metar.timestamp,
+                                         metar::simFormat(source)),
+                   false, false);
     }
 
     if(!metar.metarForNearest.isEmpty())
     {
-      Metar met(metar.metarForNearest, metar.requestIdent, metar.timestamp, true);
-      QString reportIcao = met.getParsedMetar().isValid() ? met.getParsedMetar().getId() : met.getStation();
+      QSharedPointer<const Metar> met = metarCache->getMetar(source, metar.metarForNearest, metar.requestIdent,
+                                                             metar.timestamp, metar::simFormat(source));
+      QString reportIcao = met->getParsedMetar().isValid() ? met->getParsedMetar().getId() : metar.requestIdent;
 
       html.p(tr("%1 Nearest Weather - %2").arg(name).arg(reportIcao), WEATHER_TITLE_FLAGS);
 
@@ -1155,7 +1171,7 @@ void HtmlInfoBuilder::decodedMetars(HtmlBuilder& html, const atools::fs::weather
                atools::util::html::LINK_NO_UL);
       }
 
-      decodedMetar(html, airport, reportAirport, met, false, false);
+      decodedMetar(html, airport, reportAirport, *met, false, false);
     }
   }
 }
@@ -2877,19 +2893,21 @@ void HtmlInfoBuilder::rowForStrCap(HtmlBuilder& html, const SqlRecord *rec, cons
 }
 
 void HtmlInfoBuilder::addMetarLine(atools::util::HtmlBuilder& html, const QString& heading,
-                                   const QString& metar, const QString& station,
+                                   const QString& metarString, metar::Source source, const QString& station,
                                    const QDateTime& timestamp, bool fsMetar) const
 {
-  if(!metar.isEmpty())
+  if(!metarString.isEmpty())
   {
-    Metar m(metar, station, timestamp, fsMetar);
-    const atools::fs::weather::MetarParser& pm = m.getParsedMetar();
+    // Use the same format as the information panel to share the decoded report
+    QSharedPointer<const Metar> m = NavApp::getWeatherReporter()->getMetarCache()->
+                                    getMetar(source, metarString, station, timestamp, metar::simFormat(source));
+    const atools::fs::weather::MetarParser& pm = m->getParsedMetar();
 
     if(!pm.isValid())
       qWarning() << "Metar is not valid";
 
     // Add METAR suffix for tooltip
-    html.row2(heading + (info ? tr(":") : tr(" METAR:")), fsMetar ? m.getCleanMetar() : metar);
+    html.row2(heading + (info ? tr(":") : tr(" METAR:")), fsMetar ? m->getCleanMetar() : metarString);
   }
 }
 
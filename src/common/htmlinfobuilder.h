@@ -20,6 +20,7 @@
 
 #include "util/htmlbuilder.h"
 #include "fs/weather/metar.h"
+#include "weather/metarcache.h"
 
 #include <QCoreApplication>
 #include <QDateTime>
@@ -292,15 +293,16 @@ private:
 
   void dateAndTime(const atools::fs::sc::SimConnectUserAircraft *userAircraft,
                    atools::util::HtmlBuilder& html) const;
-  void addMetarLine(atools::util::HtmlBuilder& html, const QString& heading, const QString& metar,
-                    const QString& station = QString(),
+  /* Decoded report is taken from the MetarCache */
+  void addMetarLine(atools::util::HtmlBuilder& html, const QString& heading, const QString& metarString,
+                    metar::Source source, const QString& station = QString(),
                     const QDateTime& timestamp = QDateTime(), bool fsMetar = false) const;
 
   void decodedMetar(atools::util::HtmlBuilder& html, const map::MapAirport& airport,
                     const map::MapAirport& reportAirport, const atools::fs::weather::Metar& metar,
                     bool isInterpolated, bool isFsxP3d) const;
   void decodedMetars(atools::util::HtmlBuilder& html, const atools::fs::weather::MetarResult& metar,
-                     const map::MapAirport& airport, const QString& name) const;
+                     const map::MapAirport& airport, const QString& name, metar::Source source) const;
 
   bool buildWeatherContext(map::WeatherContext& lastContext, map::WeatherContext& newContext,
                            const map::MapAirport& airport);
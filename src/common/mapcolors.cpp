@@ -34,6 +34,11 @@ QColor airportDetailBackColor(255, 255, 255);
 QColor airportEmptyColor(110, 110, 110);
 QColor toweredAirportColor(15, 70, 130);
 QColor unToweredAirportColor(126, 58, 91);
+
+QColor airportWeatherVfrColor(0, 160, 0);
+QColor airportWeatherMvfrColor(0, 0, 230);
+QColor airportWeatherIfrColor(220, 0, 0);
+QColor airportWeatherLifrColor(200, 0, 200);
 QColor vorSymbolColor(Qt::darkBlue);
 QColor ndbSymbolColor(Qt::darkRed);
 QColor markerSymbolColor(Qt::darkMagenta);
@@ -56,6 +61,11 @@ QColor distanceColor(Qt::black);
 QColor compassRoseColor(Qt::darkRed);
 QColor compassRoseTextColor(Qt::black);
 
+QColor aircraftAiDotColor(QColor(0, 0, 180));
+QColor aircraftOnlineDotColor(QColor(0, 120, 0));
+QColor aircraftClusterColor(QColor(255, 255, 255, 200));
+QColor aircraftClusterTextColor(Qt::black);
+
 /* Elevation profile colors and pens */
 QColor profileSkyColor(QColor(204, 204, 255));
 QColor profileSkyDarkColor(QColor(100, 100, 160));
@@ -87,6 +97,30 @@ const QColor& colorForAirport(const map::MapAirport& ap)
     return unToweredAirportColor;
 }
 
+const QColor& colorForFlightCategory(metar::FlightCategory category)
+{
+  static const QColor unknownColor(Qt::transparent);
+
+  switch(category)
+  {
+    case metar::VFR:
+      return airportWeatherVfrColor;
+
+    case metar::MVFR:
+      return airportWeatherMvfrColor;
+
+    case metar::IFR:
+      return airportWeatherIfrColor;
+
+    case metar::LIFR:
+      return airportWeatherLifrColor;
+
+    case metar::UNKNOWN:
+      break;
+  }
+  return unknownColor;
+}
+
 const QColor& alternatingRowColor(int row, bool isSort)
 {
   /* Alternating colors */
@@ -478,6 +512,10 @@ void syncColors()
   syncColor(colorSettings, "EmptyColor", airportEmptyColor);
   syncColor(colorSettings, "ToweredColor", toweredAirportColor);
   syncColor(colorSettings, "UnToweredColor", unToweredAirportColor);
+  syncColor(colorSettings, "WeatherVfrColor", airportWeatherVfrColor);
+  syncColor(colorSettings, "WeatherMvfrColor", airportWeatherMvfrColor);
+  syncColor(colorSettings, "WeatherIfrColor", airportWeatherIfrColor);
+  syncColor(colorSettings, "WeatherLifrColor", airportWeatherLifrColor);
   colorSettings.endGroup();
 
   colorSettings.beginGroup("Navaid");
@@ -505,6 +543,13 @@ void syncColors()
   syncColor(colorSettings, "CompassRoseTextColor", compassRoseTextColor);
   colorSettings.endGroup();
 
+  colorSettings.beginGroup("Aircraft");
+  syncColor(colorSettings, "AiDotColor", aircraftAiDotColor);
+  syncColor(colorSettings, "OnlineDotColor", aircraftOnlineDotColor);
+  syncColorArgb(colorSettings, "ClusterColor", aircraftClusterColor);
+  syncColor(colorSettings, "ClusterTextColor", aircraftClusterTextColor);
+  colorSettings.endGroup();
+
   colorSettings.beginGroup("Profile");
   syncColor(colorSettings, "SkyColor", profileSkyColor);
   syncColor(colorSettings, "SkyDarkColor", profileSkyDarkColor);
@@ -18,6 +18,8 @@
 #ifndef LITTLENAVMAP_MAPCOLORS_H
 #define LITTLENAVMAP_MAPCOLORS_H
 
+#include "weather/metartypes.h"
+
 #include <QColor>
 #include <QPen>
 #include <QStyle>
@@ -61,6 +63,18 @@ extern QColor compassRoseColor;
 extern QColor compassRoseTextColor;
 extern QColor distanceColor;
 
+/* AI and online aircraft for lower levels of detail */
+extern QColor aircraftAiDotColor;
+extern QColor aircraftOnlineDotColor;
+extern QColor aircraftClusterColor;
+extern QColor aircraftClusterTextColor;
+
+/* Airport weather flight category symbols */
+extern QColor airportWeatherVfrColor;
+extern QColor airportWeatherMvfrColor;
+extern QColor airportWeatherIfrColor;
+extern QColor airportWeatherLifrColor;
+
 /* Elevation profile colors and pens */
 extern QColor profileSkyColor;
 extern QColor profileSkyDarkColor;
@@ -196,6 +210,9 @@ const QColor& colorOutlineForParkingType(const QString& type);
 /* Color for airport symbol */
 const QColor& colorForAirport(const map::MapAirport& ap);
 
+/* Color for airport weather symbol. Transparent for unknown category. */
+const QColor& colorForFlightCategory(metar::FlightCategory category);
+
 /* Alternating row background color for search tables */
 const QColor& alternatingRowColor(int row, bool isSort);
 
@@ -75,6 +75,8 @@ enum MapObjectType
   AIRSPACE_ONLINE = 1 << 28, /* Online network center */
   AIRCRAFT_ONLINE = 1 << 29, /* Online network client/aircraft */
 
+  AIRPORT_WEATHER = 1 << 30, /* Flight category and wind symbols for airports - not used to define objects */
+
   /* All online, AI and multiplayer aircraft */
   AIRCRAFT_ALL = AIRCRAFT | AIRCRAFT_AI | AIRCRAFT_AI_SHIP | AIRCRAFT_ONLINE,
 
@@ -24,6 +24,7 @@
 #include "common/unit.h"
 #include "geo/calculations.h"
 #include "util/paintercontextsaver.h"
+#include "fs/weather/metarparser.h"
 
 #include <QPainter>
 #include <QApplication>
@@ -276,6 +277,40 @@ void SymbolPainter::drawTrackLine(QPainter *painter, float x, float y, int size,
   painter->resetTransform();
 }
 
+void SymbolPainter::drawAirportWeather(QPainter *painter, const QColor& categoryColor, float windDirDeg,
+                                       float windSpeedKts, float x, float y, int size, bool fast)
+{
+  atools::util::PainterContextSaver saver(painter);
+  painter->setBackgroundMode(Qt::TransparentMode);
+
+  float radius = std::max(size / 5.f, 2.f);
+  QPointF center(x - size / 2.f - radius / 2.f, y - size / 2.f - radius / 2.f);
+
+  using atools::fs::weather::INVALID_METAR_VALUE;
+  if(windDirDeg < INVALID_METAR_VALUE && windSpeedKts < INVALID_METAR_VALUE && windSpeedKts >= 1.f)
+  {
+    // Line pointing to the direction the wind is coming from - length grows with speed up to 40 knots
+    float length = radius + size * (0.3f + std::min(windSpeedKts, 40.f) / 40.f * 0.5f);
+    QPointF end = center + QPointF(std::sin(atools::geo::toRadians(windDirDeg)) * length,
+                                   -std::cos(atools::geo::toRadians(windDirDeg)) * length);
+
+    if(!fast)
+    {
+      painter->setPen(QPen(mapcolors::textBoxColor, 3.f, Qt::SolidLine, Qt::RoundCap));
+      painter->drawLine(center, end);
+    }
+    painter->setPen(QPen(mapcolors::textPen.color(), 1.5f, Qt::SolidLine, Qt::RoundCap));
+    painter->drawLine(center, end);
+  }
+
+  if(categoryColor.alpha() > 0)
+  {
+    painter->setPen(fast ? QPen(categoryColor) : QPen(mapcolors::textBoxColor, 1.5f));
+    painter->setBrush(categoryColor);
+    painter->drawEllipse(center, radius, radius);
+  }
+}
+
 void SymbolPainter::drawUserpointSymbol(QPainter *painter, int x, int y, int size, bool routeFill, bool fast)
 {
   atools::util::PainterContextSaver saver(painter);
@@ -129,6 +129,12 @@ public:
   /* Aircraft track */
   void drawTrackLine(QPainter *painter, float x, float y, int size, float dir);
 
+  /* Small flight category dot placed at the upper left of the airport symbol with a line pointing into the wind.
+   * Wind is not drawn if direction or speed is not valid (INVALID_METAR_VALUE) or wind is calm.
+   * x and y are the center of the airport symbol. */
+  void drawAirportWeather(QPainter *painter, const QColor& categoryColor, float windDirDeg, float windSpeedKts,
+                          float x, float y, int size, bool fast);
+
   /* Waypoint texts have no background excepts for flight plan */
   void drawWaypointText(QPainter *painter, const map::MapWaypoint& wp, int x, int y,
                         textflags::TextFlags flags, int size, bool fill,
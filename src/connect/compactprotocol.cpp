@@ -0,0 +1,230 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/compactprotocol.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QVector>
+
+#include <limits>
+
+void CompactProtocol::reset()
+{
+  mode = cp::UNKNOWN;
+  flags = cp::NONE;
+  lastPacket.clear();
+  errorText.clear();
+}
+
+bool CompactProtocol::detect(QByteArray& buffer)
+{
+  if(mode != cp::UNKNOWN)
+    return true;
+
+  if(buffer.size() < static_cast<int>(sizeof(quint32)))
+    return false;
+
+  QDataStream stream(buffer);
+  quint32 magic;
+  stream >> magic;
+
+  if(magic != cp::MAGIC)
+  {
+    // Old server - leave buffer untouched
+    mode = cp::LEGACY;
+    return true;
+  }
+
+  if(buffer.size() < HELLO_SIZE)
+    return false;
+
+  quint16 version;
+  stream >> version >> flags;
+
+  if(version > cp::VERSION)
+  {
+    errorText = tr("Unsupported protocol version %1").arg(version);
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Compact protocol version" << version << "flags" << flags;
+  mode = cp::COMPACT;
+  buffer.remove(0, HELLO_SIZE);
+  return true;
+}
+
+cp::Result CompactProtocol::readFrame(QByteArray& buffer, QByteArray& packet)
+{
+  if(buffer.size() < FRAME_HEADER_SIZE)
+    return cp::INCOMPLETE;
+
+  QDataStream stream(buffer);
+  quint8 type, frameFlags;
+  quint32 size;
+  stream >> type >> frameFlags >> size;
+
+  if(size > MAX_FRAME_SIZE || (type != cp::KEYFRAME && type != cp::DELTA))
+  {
+    errorText = tr("Invalid frame type %1 or size %2").arg(type).arg(size);
+    return cp::ERROR;
+  }
+
+  if(static_cast<quint32>(buffer.size() - FRAME_HEADER_SIZE) < size)
+    return cp::INCOMPLETE;
+
+  QByteArray payload = buffer.mid(FRAME_HEADER_SIZE, static_cast<int>(size));
+  buffer.remove(0, FRAME_HEADER_SIZE + static_cast<int>(size));
+
+  if(frameFlags & cp::FRAME_COMPRESSED)
+  {
+    payload = qUncompress(payload);
+    if(payload.isEmpty())
+    {
+      errorText = tr("Cannot uncompress frame");
+      return cp::ERROR;
+    }
+  }
+
+  if(type == cp::KEYFRAME)
+    packet = payload;
+  else if(!applyDelta(payload, packet))
+    return cp::ERROR;
+
+  lastPacket = packet;
+  return cp::FRAME;
+}
+
+bool CompactProtocol::applyDelta(const QByteArray& delta, QByteArray& packet)
+{
+  if(lastPacket.isEmpty())
+  {
+    errorText = tr("Delta frame without keyframe");
+    return false;
+  }
+
+  QDataStream stream(delta);
+  quint32 size;
+  quint16 numPatches;
+  stream >> size >> numPatches;
+
+  if(size > MAX_FRAME_SIZE)
+  {
+    errorText = tr("Invalid delta size %1").arg(size);
+    return false;
+  }
+
+  packet = lastPacket;
+  packet.resize(static_cast<int>(size));
+
+  for(int i = 0; i < numPatches; i++)
+  {
+    quint32 offset;
+    QByteArray bytes;
+    stream >> offset >> bytes;
+
+    // Check without adding offset and size to avoid overflow
+    if(stream.status() != QDataStream::Ok || offset > size ||
+       static_cast<quint64>(bytes.size()) > static_cast<quint64>(size - offset))
+    {
+      errorText = tr("Invalid patch %1 in delta frame").arg(i);
+      return false;
+    }
+    packet.replace(static_cast<int>(offset), bytes.size(), bytes);
+  }
+  return true;
+}
+
+QByteArray CompactProtocol::helloBytes(quint16 flags)
+{
+  QByteArray bytes;
+  QDataStream stream(&bytes, QIODevice::WriteOnly);
+  stream << cp::MAGIC << cp::VERSION << flags;
+  return bytes;
+}
+
+QByteArray CompactProtocol::encodeFrame(const QByteArray& last, const QByteArray& current, bool compress)
+{
+  quint8 type = cp::KEYFRAME;
+  QByteArray payload = current;
+
+  if(!last.isEmpty())
+  {
+    // Collect runs of changed bytes ============================
+    QByteArray delta;
+    QDataStream stream(&delta, QIODevice::WriteOnly);
+    QVector<std::pair<int, int> > patches;
+
+    int minSize = std::min(last.size(), current.size());
+    int i = 0;
+    while(i < minSize)
+    {
+      if(last.at(i) != current.at(i))
+      {
+        int start = i, end = i + 1, equal = 0;
+        for(int j = i + 1; j < minSize && equal < PATCH_MERGE_DISTANCE; j++)
+        {
+          if(last.at(j) != current.at(j))
+          {
+            end = j + 1;
+            equal = 0;
+          }
+          else
+            equal++;
+        }
+        patches.append(std::make_pair(start, end - start));
+        i = end;
+      }
+      else
+        i++;
+    }
+
+    // Everything beyond the old size
+    if(current.size() > minSize)
+      patches.append(std::make_pair(minSize, current.size() - minSize));
+
+    if(patches.size() <= std::numeric_limits<quint16>::max())
+    {
+      stream << static_cast<quint32>(current.size()) << static_cast<quint16>(patches.size());
+      for(const std::pair<int, int>& patch : patches)
+        stream << static_cast<quint32>(patch.first) << current.mid(patch.first, patch.second);
+
+      if(delta.size() < current.size())
+      {
+        type = cp::DELTA;
+        payload = delta;
+      }
+    }
+  }
+
+  quint8 frameFlags = 0;
+  if(compress)
+  {
+    QByteArray compressed = qCompress(payload);
+    if(compressed.size() < payload.size())
+    {
+      payload = compressed;
+      frameFlags |= cp::FRAME_COMPRESSED;
+    }
+  }
+
+  QByteArray frame;
+  QDataStream stream(&frame, QIODevice::WriteOnly);
+  stream << type << frameFlags << static_cast<quint32>(payload.size());
+  frame.append(payload);
+  return frame;
+}
@@ -0,0 +1,149 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_COMPACTPROTOCOL_H
+#define LITTLENAVMAP_COMPACTPROTOCOL_H
+
+#include <QByteArray>
+#include <QCoreApplication>
+
+/*
+ * Compact framing for the Little Navconnect socket stream which reduces bandwidth for remote clients.
+ *
+ * Negotiation: a server supporting it advertises the protocol with a hello (magic, version, offered flags) as the
+ * first bytes after a client connects. The client answers with its own hello containing the accepted subset of the
+ * offered flags and the server continues with frames. The client never sends a hello unsolicited since old
+ * servers would take it for a reply.
+ * Any other first bytes from the server are treated as the legacy stream of plain SimConnectData packets.
+ *
+ * Hello: quint32 magic, quint16 version, quint16 flags
+ * Frame: quint8 type, quint8 frame flags, quint32 payload size, payload
+ *
+ * Payload of a keyframe is a complete SimConnectData packet as written by SimConnectData::write().
+ * Payload of a delta frame contains byte patches against the previous packet:
+ * quint32 resulting size, quint16 number of patches, followed by quint32 offset and QByteArray bytes per patch.
+ * Payloads can be zlib compressed (qCompress) if indicated by the frame flags.
+ *
+ * All values in network byte order as written by QDataStream.
+ */
+namespace cp {
+
+/* "LNMC" */
+const quint32 MAGIC = 0x4c4e4d43;
+const quint16 VERSION = 1;
+
+/* Flags exchanged in hello */
+enum ProtocolFlag : quint16
+{
+  NONE = 0,
+  ZLIB = 1 << 0, /* Frames may be compressed */
+  NO_ACK = 1 << 1 /* Client does not send a reply per packet */
+};
+
+enum FrameType : quint8
+{
+  KEYFRAME = 1,
+  DELTA = 2
+};
+
+/* Flags per frame */
+enum FrameFlag : quint8
+{
+  FRAME_COMPRESSED = 1 << 0
+};
+
+enum Mode
+{
+  UNKNOWN, /* Nothing received yet */
+  LEGACY, /* Old server sending plain packets */
+  COMPACT
+};
+
+enum Result
+{
+  INCOMPLETE, /* Need more data */
+  FRAME, /* Frame complete */
+  ERROR
+};
+
+}
+
+/*
+ * Decodes the compact stream into plain serialized SimConnectData packets. Also contains the encoding
+ * part which is used by the server.
+ */
+class CompactProtocol
+{
+  Q_DECLARE_TR_FUNCTIONS(CompactProtocol)
+
+public:
+  /* Forget mode and last packet. Call for each new connection. */
+  void reset();
+
+  /* Detect protocol from the start of the stream and consume the server hello if present.
+   * @return false if more data is needed or an error occured */
+  bool detect(QByteArray& buffer);
+
+  /* Take the next complete frame from the start of the buffer and reconstruct the serialized packet into
+   * packet */
+  cp::Result readFrame(QByteArray& buffer, QByteArray& packet);
+
+  /* Hello to be sent by client and server */
+  static QByteArray helloBytes(quint16 flags);
+
+  /* Build a frame for the serialized packet current. Uses a delta against last if it is smaller
+   * than a keyframe. */
+  static QByteArray encodeFrame(const QByteArray& last, const QByteArray& current, bool compress);
+
+  cp::Mode getMode() const
+  {
+    return mode;
+  }
+
+  /* Flags accepted by server */
+  quint16 getFlags() const
+  {
+    return flags;
+  }
+
+  const QString& getErrorText() const
+  {
+    return errorText;
+  }
+
+  /* Refuse insane frame sizes from a garbled stream or file */
+  static Q_DECL_CONSTEXPR quint32 MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+private:
+  /* Header size for hello and frames */
+  static Q_DECL_CONSTEXPR int HELLO_SIZE = 8;
+  static Q_DECL_CONSTEXPR int FRAME_HEADER_SIZE = 6;
+
+  /* Merge changed byte runs which are closer than this into one patch */
+  static Q_DECL_CONSTEXPR int PATCH_MERGE_DISTANCE = 8;
+
+  bool applyDelta(const QByteArray& delta, QByteArray& packet);
+
+  cp::Mode mode = cp::UNKNOWN;
+  quint16 flags = cp::NONE;
+
+  /* Last reconstructed packet for delta frames */
+  QByteArray lastPacket;
+  QString errorText;
+};
+
+#endif // LITTLENAVMAP_COMPACTPROTOCOL_H
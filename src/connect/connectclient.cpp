@@ -17,6 +17,10 @@
 
 #include "connect/connectclient.h"
 
+#include "connect/simdatadispatcher.h"
+#include "connect/simdataprocessor.h"
+#include "connect/replayconnecthandler.h"
+#include "connect/trafficgeneratorhandler.h"
 #include "navapp.h"
 #include "common/constants.h"
 #include "fs/sc/simconnectreply.h"
@@ -43,6 +47,26 @@ ConnectClient::ConnectClient(MainWindow *parent)
   atools::settings::Settings& settings = atools::settings::Settings::instance();
   verbose = settings.getAndStoreValue(lnm::OPTIONS_CONNECTCLIENT_DEBUG, false).toBool();
 
+  // Accept compression and no acknowledge if Little Navconnect advertises the compact protocol
+  requestCompactProtocol = settings.getAndStoreValue(lnm::OPTIONS_CONNECTCLIENT_COMPACT, true).toBool();
+
+  simDataDispatcher = new SimDataDispatcher(this);
+  connect(&statisticsTimer, &QTimer::timeout, this, &ConnectClient::logStatistics);
+  if(settings.getAndStoreValue(lnm::OPTIONS_CONNECTCLIENT_STATISTICS, false).toBool())
+    statisticsTimer.start(STATISTICS_INTERVAL_SEC * 1000);
+
+  // Decodes socket data and detects takeoff and landing in background
+  simDataProcessor = new SimDataProcessor(verbose);
+  simDataProcessor->moveToThread(&processorThread);
+  connect(simDataProcessor, &SimDataProcessor::packetProcessed, this, &ConnectClient::postSimConnectData);
+  connect(simDataProcessor, &SimDataProcessor::decodingFailed, this, &ConnectClient::decodingFailed);
+  connect(simDataProcessor, &SimDataProcessor::compactProtocolDetected, this,
+          &ConnectClient::compactProtocolDetected);
+  connect(simDataProcessor, &SimDataProcessor::aircraftTakeoff, this, &ConnectClient::aircraftTakeoffDetected);
+  connect(simDataProcessor, &SimDataProcessor::aircraftLanding, this, &ConnectClient::aircraftLandingDetected);
+  processorThread.setObjectName("SimDataProcessor");
+  processorThread.start();
+
   // Create FSX/P3D handler for SimConnect
   simConnectHandler = new atools::fs::sc::SimConnectHandler(verbose);
   simConnectHandler->loadSimConnect(QApplication::applicationFilePath() + ".simconnect");
@@ -62,7 +86,7 @@ ConnectClient::ConnectClient(MainWindow *parent)
   // We were able to connect
   dataReader->setReconnectRateSec(DIRECT_RECONNECT_SEC);
 
-  connect(dataReader, &DataReaderThread::postSimConnectData, this, &ConnectClient::postSimConnectData);
+  connect(dataReader, &DataReaderThread::postSimConnectData, simDataProcessor, &SimDataProcessor::processPacket);
   connect(dataReader, &DataReaderThread::postLogMessage, this, &ConnectClient::postLogMessage);
   connect(dataReader, &DataReaderThread::connectedToSimulator, this, &ConnectClient::connectedToSimulatorDirect);
   connect(dataReader, &DataReaderThread::disconnectedFromSimulator, this,
@@ -88,6 +112,7 @@ ConnectClient::~ConnectClient()
   qDebug() << Q_FUNC_INFO;
 
   flushQueuedRequestsTimer.stop();
+  statisticsTimer.stop();
   reconnectNetworkTimer.stop();
 
   disconnectClicked();
@@ -101,8 +126,19 @@ ConnectClient::~ConnectClient()
   qDebug() << Q_FUNC_INFO << "delete xpConnectHandler";
   delete xpConnectHandler;
 
+  qDebug() << Q_FUNC_INFO << "delete testHandler";
+  delete testHandler;
+
   qDebug() << Q_FUNC_INFO << "delete dialog";
   delete dialog;
+
+  qDebug() << Q_FUNC_INFO << "stop processorThread";
+  processorThread.quit();
+  processorThread.wait();
+  delete simDataProcessor;
+
+  qDebug() << Q_FUNC_INFO << "delete simDataDispatcher";
+  delete simDataDispatcher;
 }
 
 void ConnectClient::flushQueuedRequests()
@@ -138,7 +174,8 @@ void ConnectClient::connectToServerDialog()
 
 void ConnectClient::tryConnectOnStartup()
 {
-  if(dialog->isAutoConnect())
+  // Replay from command line has priority
+  if(dialog->isAutoConnect() && testHandler == nullptr)
   {
     reconnectNetworkTimer.stop();
 
@@ -150,6 +187,9 @@ void ConnectClient::tryConnectOnStartup()
 
 QString ConnectClient::simName() const
 {
+  if(testHandler != nullptr && dataReader->getHandler() == testHandler)
+    return testHandler->getName();
+
   if(dialog->isAnyConnectDirect())
   {
     if(dataReader->getHandler() == xpConnectHandler)
@@ -162,6 +202,9 @@ QString ConnectClient::simName() const
 
 QString ConnectClient::simShortName() const
 {
+  if(testHandler != nullptr && dataReader->getHandler() == testHandler)
+    return testHandler->getName();
+
   if(dialog->isAnyConnectDirect())
   {
     if(dataReader->getHandler() == xpConnectHandler)
@@ -179,6 +222,7 @@ void ConnectClient::connectedToSimulatorDirect()
   mainWindow->setConnectionStatusMessageText(tr("Connected (%1)").arg(simShortName()),
                                              tr("Connected to local flight simulator (%1).").arg(simName()));
   dialog->setConnected(isConnected());
+  resetProcessing();
   emit connectedToSimulator();
   emit weatherUpdated();
 }
@@ -197,6 +241,7 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   metarIdentCache.clear();
   outstandingReplies.clear();
   queuedRequests.clear();
+  resetProcessing();
 
   if(!NavApp::isShuttingDown())
   {
@@ -207,17 +252,48 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   manualDisconnect = false;
 }
 
-/* Posts data received directly from simconnect or the socket and caches any metar reports */
-void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
+/* Posts data received directly from simconnect or the socket and caches any metar reports.
+ * Called by the processor thread once a packet is decoded. */
+void ConnectClient::postSimConnectData(SimDataDispatcher::SimDataPtr dataPacket, quint32 epoch)
 {
-  emit dataPacketReceived(dataPacket);
+  if(!isConnected() || epoch != processingEpoch)
+    // Left over from a closed or reset connection - do not answer old packet ids
+    return;
+
+  if(socket != nullptr)
+  {
+    if(verbose)
+      qDebug() << "readFromSocket id " << dataPacket->getPacketId();
+
+    if(dataPacket->getPacketId() > 0 && !(compactProtocolFlags & cp::NO_ACK))
+    {
+      // Data was read completely and successfully - reply to server
+      atools::fs::sc::SimConnectReply reply;
+      reply.setPacketId(dataPacket->getPacketId());
+      writeReplyToSocket(reply);
+    }
+    else if(!dataPacket->getMetars().isEmpty())
+    {
+      for(const atools::fs::weather::MetarResult& metar : dataPacket->getMetars())
+        outstandingReplies.remove(metar.requestIdent);
+
+      if(outstandingReplies.isEmpty() && !queuedRequests.isEmpty())
+        requestWeather(queuedRequests.takeLast());
+    }
+
+    if(verbose)
+      qDebug() << "outstanding" << outstandingReplies;
+  }
 
-  if(!dataPacket.getMetars().isEmpty())
+  // Send around in the application
+  simDataDispatcher->dispatch(dataPacket);
+
+  if(!dataPacket->getMetars().isEmpty())
   {
     if(verbose)
-      qDebug() << "Metars number" << dataPacket.getMetars().size();
+      qDebug() << "Metars number" << dataPacket->getMetars().size();
 
-    for(atools::fs::weather::MetarResult metar : dataPacket.getMetars())
+    for(atools::fs::weather::MetarResult metar : dataPacket->getMetars())
     {
       QString ident = metar.requestIdent;
       if(verbose)
@@ -375,6 +451,54 @@ void ConnectClient::disconnectClicked()
   closeSocket(false);
 }
 
+void ConnectClient::startReplay(const QString& filename, float speed)
+{
+  qInfo() << Q_FUNC_INFO << filename << speed;
+  startTestHandler(new ReplayConnectHandler(filename, speed), speed > 0.f ? REPLAY_UPDATE_RATE_MS : 1);
+}
+
+void ConnectClient::startTrafficGenerator(const atools::geo::Pos& center, float radiusNm, int numAircraft,
+                                          int updateRateMs)
+{
+  qInfo() << Q_FUNC_INFO << center << radiusNm << numAircraft << updateRateMs;
+
+  // Avoid busy looping in the reader thread
+  startTestHandler(new TrafficGeneratorHandler(center, radiusNm, numAircraft), std::max(updateRateMs, 1));
+}
+
+void ConnectClient::startTestHandler(atools::fs::sc::ConnectHandler *handler, int updateRateMs)
+{
+  // Stops the reader thread before the handler can be replaced
+  disconnectClicked();
+
+  delete testHandler;
+  testHandler = handler;
+
+  dataReader->setHandler(testHandler);
+  dataReader->setUpdateRate(updateRateMs);
+  dataReader->start();
+
+  mainWindow->setConnectionStatusMessageText(tr("Connecting (%1)...").arg(simShortName()),
+                                             tr("Starting %1.").arg(simName()));
+
+  // Print throughput to the log
+  simDataDispatcher->resetStatistics();
+  statisticsTimer.start(STATISTICS_INTERVAL_SEC * 1000);
+}
+
+void ConnectClient::logStatistics()
+{
+  for(const QString& line : simDataDispatcher->getStatistics())
+    qInfo().noquote() << "Sim data" << line;
+  simDataDispatcher->resetStatistics();
+}
+
+void ConnectClient::startRecording(const QString& filename)
+{
+  qInfo() << Q_FUNC_INFO << filename;
+  QMetaObject::invokeMethod(simDataProcessor, "setRecordingFile", Qt::QueuedConnection, Q_ARG(QString, filename));
+}
+
 void ConnectClient::connectInternal()
 {
   if(dialog->isAnyConnectDirect())
@@ -476,9 +600,6 @@ void ConnectClient::closeSocket(bool allowRestart)
     socket = nullptr;
   }
 
-  delete simConnectData;
-  simConnectData = nullptr;
-
   QString msgTooltip, msg;
   if(error == QAbstractSocket::RemoteHostClosedError || error == QAbstractSocket::UnknownSocketError)
   {
@@ -506,6 +627,7 @@ void ConnectClient::closeSocket(bool allowRestart)
   metarIdentCache.clear();
   outstandingReplies.clear();
   queuedRequests.clear();
+  resetProcessing();
 
   if(socketConnected)
   {
@@ -564,68 +686,82 @@ void ConnectClient::connectedToServerSocket()
   silent = false;
 
   dialog->setConnected(isConnected());
+  resetProcessing();
 
   // Let other program parts know about the new connection
   emit connectedToSimulator();
   emit weatherUpdated();
 }
 
-/* Called by signal QTcpSocket::readyRead - read data from socket */
+/* Called by signal QTcpSocket::readyRead - read data from socket and pass it to the processor thread */
 void ConnectClient::readFromSocket()
 {
-  if(socket != nullptr)
+  if(socket != nullptr && socket->bytesAvailable() > 0)
   {
-    while(socket->bytesAvailable())
-    {
-      if(verbose)
-        qDebug() << "readFromSocket" << socket->bytesAvailable();
-      if(simConnectData == nullptr)
-        // Need to keep the data in background since this method can be called multiple times until the data is filled
-        simConnectData = new atools::fs::sc::SimConnectData;
+    if(verbose)
+      qDebug() << "readFromSocket" << socket->bytesAvailable();
 
-      bool read = simConnectData->read(socket);
-      if(simConnectData->getStatus() != atools::fs::sc::OK)
-      {
-        // Something went wrong - shutdown
-        QMessageBox::critical(mainWindow, QApplication::applicationName(),
-                              QString(tr("Error reading data from Little Navconnect: %1.")).
-                              arg(simConnectData->getStatusText()));
-        closeSocket(false);
-        return;
-      }
+    // Decoding is done in background - see postSimConnectData()
+    QMetaObject::invokeMethod(simDataProcessor, "decodeBytes", Qt::QueuedConnection,
+                              Q_ARG(QByteArray, socket->readAll()), Q_ARG(quint32, processingEpoch));
+  }
+}
 
-      if(verbose)
-        qDebug() << "readFromSocket 2" << socket->bytesAvailable();
-      if(read)
-      {
-        if(verbose)
-          qDebug() << "readFromSocket id " << simConnectData->getPacketId();
-
-        if(simConnectData->getPacketId() > 0)
-        {
-          // Data was read completely and successfully - reply to server
-          atools::fs::sc::SimConnectReply reply;
-          reply.setPacketId(simConnectData->getPacketId());
-          writeReplyToSocket(reply);
-        }
-        else if(!simConnectData->getMetars().isEmpty())
-        {
-          for(const atools::fs::weather::MetarResult& metar : simConnectData->getMetars())
-            outstandingReplies.remove(metar.requestIdent);
-
-          if(outstandingReplies.isEmpty() && !queuedRequests.isEmpty())
-            requestWeather(queuedRequests.takeLast());
-        }
-
-        // Send around in the application
-        postSimConnectData(*simConnectData);
-        delete simConnectData;
-        simConnectData = nullptr;
-      }
-      else
-        return;
-    }
-    if(verbose)
-      qDebug() << "outstanding" << outstandingReplies;
+/* Called by processor thread if the stream from Little Navconnect is garbled */
+void ConnectClient::decodingFailed(QString message, quint32 epoch)
+{
+  if(socket == nullptr || epoch != processingEpoch)
+    return;
+
+  // Something went wrong - shutdown
+  QMessageBox::critical(mainWindow, QApplication::applicationName(),
+                        QString(tr("Error reading data from Little Navconnect: %1.")).arg(message));
+  closeSocket(false);
+}
+
+void ConnectClient::aircraftTakeoffDetected(SimDataDispatcher::SimDataPtr data, quint32 epoch)
+{
+  if(epoch != processingEpoch)
+    // Detected before a reset - would log a bogus event
+    return;
+
+  emit aircraftTakeoff(data->getUserAircraft());
+}
+
+void ConnectClient::aircraftLandingDetected(SimDataDispatcher::SimDataPtr data, float flownDistanceNm,
+                                            float averageTasKts, quint32 epoch)
+{
+  if(epoch != processingEpoch)
+    return;
+
+  emit aircraftLanding(data->getUserAircraft(), flownDistanceNm, averageTasKts);
+}
+
+void ConnectClient::compactProtocolDetected(quint16 flags, quint32 epoch)
+{
+  if(epoch != processingEpoch)
+    // Hello of a previous connection
+    return;
+
+  // Server advertised the compact protocol with its hello - answer with the flags used by both sides
+  quint16 requested = requestCompactProtocol ? static_cast<quint16>(cp::ZLIB | cp::NO_ACK) : quint16(cp::NONE);
+  compactProtocolFlags = flags & requested;
+  qInfo() << Q_FUNC_INFO << "offered flags" << flags << "accepted flags" << compactProtocolFlags;
+
+  if(socket != nullptr && socketConnected)
+  {
+    socket->write(CompactProtocol::helloBytes(compactProtocolFlags));
+    if(!socket->flush())
+      qWarning() << "Hello to server not flushed";
   }
 }
+
+void ConnectClient::resetProcessing()
+{
+  compactProtocolFlags = cp::NONE;
+  simDataDispatcher->clear();
+
+  // Drop all bytes and packets which are still queued for or from the processor thread
+  processingEpoch++;
+  QMetaObject::invokeMethod(simDataProcessor, "reset", Qt::QueuedConnection, Q_ARG(quint32, processingEpoch));
+}
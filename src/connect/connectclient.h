@@ -21,14 +21,17 @@
 #include "fs/sc/simconnectdata.h"
 #include "util/timedcache.h"
 #include "connectdialog.h"
+#include "connect/simdatadispatcher.h"
 
 #include <QAbstractSocket>
 #include <QCache>
+#include <QThread>
 #include <QTimer>
 
 class QTcpSocket;
 class ConnectDialog;
 class MainWindow;
+class SimDataProcessor;
 
 namespace atools {
 namespace fs {
@@ -46,8 +49,10 @@ class SimConnectReply;
 }
 
 /*
- * Client for the Little Navconnect Simconnect agent/server. Receives data and passes it around by emitting a signal.
- * Does not use multithreading - runs completely in the event loop.
+ * Client for the Little Navconnect Simconnect agent/server. Receives data and passes it around using the
+ * SimDataDispatcher.
+ * Socket communication runs in the event loop. Decoding of packets and takeoff/landing detection is done
+ * by the SimDataProcessor in a separate thread.
  */
 class ConnectClient :
   public QObject
@@ -73,10 +78,25 @@ public:
 
   atools::fs::weather::MetarResult requestWeather(const QString& station, const atools::geo::Pos& pos);
 
+  /* Connect directly to a replay of a file recorded with startRecording() instead of a simulator.
+   * speed is a factor for the recorded timing. 0 replays as fast as possible. */
+  void startReplay(const QString& filename, float speed);
+
+  /* Write all received packets to the given file. Empty filename stops recording. */
+  void startRecording(const QString& filename);
+
+  /* Connect directly to a generator for numAircraft AI aircraft moving within radiusNm around center.
+   * Rates below 1 ms are raised to 1 ms. */
+  void startTrafficGenerator(const atools::geo::Pos& center, float radiusNm, int numAircraft, int updateRateMs);
+
+  /* Passes new data received from the server (Little Navconnect) or the simulator to all subscribers.
+   * Can be aircraft position or weather update. */
+  SimDataDispatcher *getSimDataDispatcher() const
+  {
+    return simDataDispatcher;
+  }
+
 signals:
-  /* Emitted when new data was received from the server (Little Navconnect).
-   * can be aircraft position or weather update */
-  void dataPacketReceived(atools::fs::sc::SimConnectData simConnectData);
 
   /* Emitted when a new SimConnect data was received that contains weather data */
   void weatherUpdated();
@@ -87,12 +107,23 @@ signals:
   /* Emitted when disconnected manually or due to error */
   void disconnectedFromSimulator();
 
+  /* Emitted when a takeoff or landing was detected */
+  void aircraftTakeoff(const atools::fs::sc::SimConnectUserAircraft& aircraft);
+  void aircraftLanding(const atools::fs::sc::SimConnectUserAircraft& aircraft, float flownDistanceNm,
+                       float averageTasKts);
+
 private:
   /* Try to reconnect every 5 seconds when network connection is lost */
   const int SOCKET_RECONNECT_SEC = 5;
   /* Try to reconnect every 5 seconds when the SimConnect or X-Plane connection is lost */
   const int DIRECT_RECONNECT_SEC = 5;
 
+  /* Fetch rate when replaying with recorded timing */
+  const int REPLAY_UPDATE_RATE_MS = 20;
+
+  /* Log dispatcher statistics every ten seconds when using a test handler or if enabled in settings */
+  const int STATISTICS_INTERVAL_SEC = 10;
+
   /* Any metar fetched from the Simulator will time out in 15 seconds */
   const int WEATHER_TIMEOUT_FS_SECS = 15;
 
@@ -103,7 +134,17 @@ private:
   void connectInternal();
   void writeReplyToSocket(atools::fs::sc::SimConnectReply& reply);
   void disconnectClicked();
-  void postSimConnectData(atools::fs::sc::SimConnectData dataPacket);
+  void postSimConnectData(SimDataDispatcher::SimDataPtr dataPacket, quint32 epoch);
+  void decodingFailed(QString message, quint32 epoch);
+  void compactProtocolDetected(quint16 flags, quint32 epoch);
+  void aircraftTakeoffDetected(SimDataDispatcher::SimDataPtr data, quint32 epoch);
+  void aircraftLandingDetected(SimDataDispatcher::SimDataPtr data, float flownDistanceNm, float averageTasKts,
+                               quint32 epoch);
+
+  /* Clear dispatcher and processor state on connect and disconnect */
+  void resetProcessing();
+  void startTestHandler(atools::fs::sc::ConnectHandler *handler, int updateRateMs);
+  void logStatistics();
   void postLogMessage(QString message, bool warning);
   void connectedToSimulatorDirect();
   void disconnectedFromSimulatorDirect();
@@ -125,15 +166,25 @@ private:
   atools::fs::sc::DataReaderThread *dataReader = nullptr;
   atools::fs::sc::SimConnectHandler *simConnectHandler = nullptr;
   atools::fs::sc::XpConnectHandler *xpConnectHandler = nullptr;
+  /* Replay or traffic generator */
+  atools::fs::sc::ConnectHandler *testHandler = nullptr;
+  SimDataDispatcher *simDataDispatcher = nullptr;
 
-  /* Have to keep it since it is read multiple times */
-  atools::fs::sc::SimConnectData *simConnectData = nullptr;
+  /* Lives in processorThread */
+  SimDataProcessor *simDataProcessor = nullptr;
+  QThread processorThread;
 
   QTcpSocket *socket = nullptr;
   /* Used to trigger reconnects on socket base connections */
-  QTimer reconnectNetworkTimer, flushQueuedRequestsTimer;
+  QTimer reconnectNetworkTimer, flushQueuedRequestsTimer, statisticsTimer;
   MainWindow *mainWindow;
-  bool verbose = false;
+  bool verbose = false, requestCompactProtocol = false;
+
+  /* Flags agreed with the server if the compact protocol is used. cp::ProtocolFlag. */
+  quint16 compactProtocolFlags = 0;
+
+  /* Incremented on each reset of the processor. Results of older epochs are dropped. */
+  quint32 processingEpoch = 0;
   atools::util::TimedCache<QString, atools::fs::weather::MetarResult> metarIdentCache;
   QSet<QString> outstandingReplies;
   QVector<atools::fs::sc::WeatherRequest> queuedRequests;
@@ -0,0 +1,176 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/replayconnecthandler.h"
+
+#include "connect/simdatarecorder.h"
+#include "fs/sc/simconnectdata.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+
+/* Size of file header and record timestamp */
+const int FILE_HEADER_SIZE = 6;
+const int TIMESTAMP_SIZE = 8;
+const int FRAME_HEADER_SIZE = 6;
+
+ReplayConnectHandler::ReplayConnectHandler(const QString& filenameParam, float speedParam)
+  : filename(filenameParam), speed(speedParam)
+{
+}
+
+ReplayConnectHandler::~ReplayConnectHandler()
+{
+  file.close();
+}
+
+bool ReplayConnectHandler::connect()
+{
+  if(file.isOpen())
+    return true;
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open replay" << filename << ":" << file.errorString();
+    state = atools::fs::sc::OPEN_ERROR;
+    return false;
+  }
+
+  QDataStream stream(&file);
+  quint32 magic;
+  quint16 version;
+  stream >> magic >> version;
+  if(magic != SimDataRecorder::FILE_MAGIC || version > SimDataRecorder::FILE_VERSION)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid replay file" << filename << "magic" << magic << "version" << version;
+    file.close();
+    state = atools::fs::sc::OPEN_ERROR;
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Replaying" << filename << "speed" << speed;
+  state = atools::fs::sc::STATEOK;
+  rewind();
+  return true;
+}
+
+void ReplayConnectHandler::rewind()
+{
+  file.seek(FILE_HEADER_SIZE);
+  protocol.reset();
+  nextValid = false;
+  replayTimer.start();
+}
+
+bool ReplayConnectHandler::fetchData(atools::fs::sc::SimConnectData& data, int radiusKm,
+                                     atools::fs::sc::Options options)
+{
+  Q_UNUSED(radiusKm);
+  Q_UNUSED(options);
+
+  if(!file.isOpen())
+    return false;
+
+  if(!nextValid && !readRecord())
+  {
+    if(state == atools::fs::sc::STATEOK)
+    {
+      // End of file - start over
+      qInfo() << Q_FUNC_INFO << "Replay restarted";
+      rewind();
+    }
+    return false;
+  }
+
+  // Pace only by the next packet - overdue packets are delivered one per fetch to keep all updates in order
+  if(speed > 0.f && nextTimestampMs > static_cast<qint64>(replayTimer.elapsed() * speed))
+    // Not due yet
+    return false;
+
+  QByteArray packet = nextPacket;
+  nextValid = false;
+
+  QBuffer buffer(&packet);
+  buffer.open(QIODevice::ReadOnly);
+  atools::fs::sc::SimConnectData replayData;
+  if(!replayData.read(&buffer) || replayData.getStatus() != atools::fs::sc::OK)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid packet in replay" << filename << replayData.getStatusText();
+    return false;
+  }
+
+  data = replayData;
+  return true;
+}
+
+bool ReplayConnectHandler::readRecord()
+{
+  QByteArray header = file.read(TIMESTAMP_SIZE + FRAME_HEADER_SIZE);
+  if(header.size() < TIMESTAMP_SIZE + FRAME_HEADER_SIZE)
+    // End of file or truncated last record
+    return false;
+
+  QDataStream stream(header);
+  quint8 type, frameFlags;
+  quint32 size;
+  stream >> nextTimestampMs >> type >> frameFlags >> size;
+
+  if(size > CompactProtocol::MAX_FRAME_SIZE)
+  {
+    // Avoid allocating huge buffers for corrupted files
+    qWarning() << Q_FUNC_INFO << "Invalid frame size in replay" << filename << size;
+    state = atools::fs::sc::FETCH_ERROR;
+    return false;
+  }
+
+  QByteArray frame = header.mid(TIMESTAMP_SIZE) + file.read(size);
+
+  cp::Result result = protocol.readFrame(frame, nextPacket);
+  if(result == cp::ERROR)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid frame in replay" << filename << protocol.getErrorText();
+    state = atools::fs::sc::FETCH_ERROR;
+    return false;
+  }
+
+  // Incomplete means truncated file
+  nextValid = result == cp::FRAME;
+  return nextValid;
+}
+
+bool ReplayConnectHandler::fetchWeatherData(atools::fs::sc::SimConnectData& data)
+{
+  Q_UNUSED(data);
+  return false;
+}
+
+void ReplayConnectHandler::addWeatherRequest(const atools::fs::sc::WeatherRequest& request)
+{
+  weatherRequest = request;
+}
+
+const atools::fs::sc::WeatherRequest& ReplayConnectHandler::getWeatherRequest() const
+{
+  return weatherRequest;
+}
+
+QString ReplayConnectHandler::getName() const
+{
+  return QLatin1Literal("Replay");
+}
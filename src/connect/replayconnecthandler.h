@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_REPLAYCONNECTHANDLER_H
+#define LITTLENAVMAP_REPLAYCONNECTHANDLER_H
+
+#include "fs/sc/connecthandler.h"
+#include "fs/sc/weatherrequest.h"
+#include "connect/compactprotocol.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+
+/*
+ * Connect handler for the DataReaderThread which plays back a file written by the SimDataRecorder.
+ * Allows to profile the application under identical load without a simulator.
+ *
+ * Packets are replayed in order with their recorded timing multiplied by a speed factor. Packets are never
+ * skipped. Overdue ones are delivered one per fetch. A speed of 0 delivers one packet per fetch at the update
+ * rate of the data reader. Replay starts over at the end of the file.
+ */
+class ReplayConnectHandler :
+  public atools::fs::sc::ConnectHandler
+{
+public:
+  ReplayConnectHandler(const QString& filenameParam, float speedParam);
+  virtual ~ReplayConnectHandler();
+
+  /* Opens the file */
+  virtual bool connect() override;
+
+  virtual bool isLoaded() const override
+  {
+    return true;
+  }
+
+  virtual bool fetchData(atools::fs::sc::SimConnectData& data, int radiusKm,
+                         atools::fs::sc::Options options) override;
+
+  /* Weather is not recorded separately */
+  virtual bool fetchWeatherData(atools::fs::sc::SimConnectData& data) override;
+  virtual void addWeatherRequest(const atools::fs::sc::WeatherRequest& request) override;
+  virtual const atools::fs::sc::WeatherRequest& getWeatherRequest() const override;
+
+  virtual bool isSimRunning() const override
+  {
+    return file.isOpen();
+  }
+
+  virtual bool isSimPaused() const override
+  {
+    return false;
+  }
+
+  virtual atools::fs::sc::State getState() const override
+  {
+    return state;
+  }
+
+  virtual QString getName() const override;
+
+  const QString& getFilename() const
+  {
+    return filename;
+  }
+
+  float getSpeed() const
+  {
+    return speed;
+  }
+
+private:
+  /* Read next record into nextPacket and nextTimestampMs. false on end of file or error. */
+  bool readRecord();
+  void rewind();
+
+  QString filename;
+  float speed;
+  QFile file;
+  CompactProtocol protocol;
+  atools::fs::sc::WeatherRequest weatherRequest;
+  atools::fs::sc::State state = atools::fs::sc::STATEOK;
+
+  /* Started at the beginning of the file */
+  QElapsedTimer replayTimer;
+
+  QByteArray nextPacket;
+  qint64 nextTimestampMs = 0L;
+  bool nextValid = false;
+};
+
+#endif // LITTLENAVMAP_REPLAYCONNECTHANDLER_H
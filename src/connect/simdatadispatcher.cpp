@@ -0,0 +1,145 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdatadispatcher.h"
+
+#include <QTimer>
+
+SimDataDispatcher::SimDataDispatcher(QObject *parent)
+  : QObject(parent)
+{
+}
+
+SimDataDispatcher::~SimDataDispatcher()
+{
+  for(Subscriber *subscriber : subscribers)
+  {
+    subscriber->timer->stop();
+    delete subscriber->timer;
+    delete subscriber;
+  }
+  subscribers.clear();
+}
+
+void SimDataDispatcher::subscribe(QObject *receiver, int minIntervalMs, Callback callback)
+{
+  Subscriber *subscriber = new Subscriber;
+  subscriber->receiver = receiver;
+  subscriber->minIntervalMs = minIntervalMs;
+  subscriber->callback = callback;
+
+  subscriber->timer = new QTimer();
+  subscriber->timer->setSingleShot(true);
+  connect(subscriber->timer, &QTimer::timeout, this, [this, subscriber]()
+  {
+    deliver(subscriber);
+  });
+
+  subscribers.append(subscriber);
+}
+
+void SimDataDispatcher::dispatch(const atools::fs::sc::SimConnectData& data)
+{
+  // Only copy made for all consumers
+  dispatch(SimDataPtr(new atools::fs::sc::SimConnectData(data)));
+}
+
+void SimDataDispatcher::dispatch(SimDataPtr data)
+{
+  latest = data;
+  latestTimer.start();
+  numDispatched++;
+
+  for(Subscriber *subscriber : subscribers)
+  {
+    if(subscriber->receiver.isNull())
+      continue;
+
+    qint64 elapsed = subscriber->lastDelivery.isValid() ? subscriber->lastDelivery.elapsed() : -1L;
+
+    if(subscriber->minIntervalMs <= 0 || elapsed < 0 || elapsed >= subscriber->minIntervalMs)
+    {
+      // Due - deliver now and drop any pending delivery
+      subscriber->timer->stop();
+      deliver(subscriber);
+    }
+    else if(!subscriber->timer->isActive())
+      // Too early - deliver latest snapshot when interval is over
+      subscriber->timer->start(static_cast<int>(subscriber->minIntervalMs - elapsed));
+  }
+}
+
+void SimDataDispatcher::clear()
+{
+  for(Subscriber *subscriber : subscribers)
+  {
+    subscriber->timer->stop();
+    subscriber->lastDelivery.invalidate();
+  }
+  latest.reset();
+}
+
+void SimDataDispatcher::deliver(Subscriber *subscriber)
+{
+  if(latest.isNull() || subscriber->receiver.isNull())
+    return;
+
+  // Keep a reference in case a new packet replaces the snapshot while the consumer is running
+  SimDataPtr snapshot = latest;
+  qint64 latencyNs = latestTimer.nsecsElapsed();
+  subscriber->lastDelivery.start();
+
+  QElapsedTimer callbackTimer;
+  callbackTimer.start();
+  subscriber->callback(*snapshot);
+  qint64 callbackNs = callbackTimer.nsecsElapsed();
+
+  subscriber->numDelivered++;
+  subscriber->latencyNs += latencyNs;
+  subscriber->maxLatencyNs = std::max(subscriber->maxLatencyNs, latencyNs);
+  subscriber->callbackNs += callbackNs;
+  subscriber->maxCallbackNs = std::max(subscriber->maxCallbackNs, callbackNs);
+}
+
+QStringList SimDataDispatcher::getStatistics() const
+{
+  QStringList stats;
+  stats.append(QString("Packets %1").arg(numDispatched));
+
+  for(const Subscriber *subscriber : subscribers)
+  {
+    double num = std::max(subscriber->numDelivered, static_cast<quint64>(1));
+    stats.append(QString("%1: delivered %2, latency avg %3 ms max %4 ms, consumer avg %5 ms max %6 ms").
+                 arg(subscriber->receiver.isNull() ? "deleted" : subscriber->receiver->metaObject()->className()).
+                 arg(subscriber->numDelivered).
+                 arg(subscriber->latencyNs / num / 1000000., 0, 'f', 2).
+                 arg(subscriber->maxLatencyNs / 1000000., 0, 'f', 2).
+                 arg(subscriber->callbackNs / num / 1000000., 0, 'f', 2).
+                 arg(subscriber->maxCallbackNs / 1000000., 0, 'f', 2));
+  }
+  return stats;
+}
+
+void SimDataDispatcher::resetStatistics()
+{
+  numDispatched = 0;
+  for(Subscriber *subscriber : subscribers)
+  {
+    subscriber->numDelivered = 0;
+    subscriber->latencyNs = subscriber->maxLatencyNs = subscriber->callbackNs = subscriber->maxCallbackNs = 0L;
+  }
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_SIMDATADISPATCHER_H
+#define LITTLENAVMAP_SIMDATADISPATCHER_H
+
+#include "fs/sc/simconnectdata.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+class QTimer;
+
+/*
+ * Keeps the latest simulator data packet as an immutable shared snapshot and passes it to all subscribed consumers.
+ *
+ * Each consumer has its own minimum delivery interval. Packets arriving in between are coalesced and only the
+ * latest snapshot is delivered once the interval is over. This avoids copying packets which would be
+ * dropped by the receiver anyway and makes sure that the last packet of a burst is not lost.
+ */
+class SimDataDispatcher :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  typedef std::function<void (const atools::fs::sc::SimConnectData&)> Callback;
+  typedef QSharedPointer<const atools::fs::sc::SimConnectData> SimDataPtr;
+
+  explicit SimDataDispatcher(QObject *parent);
+  virtual ~SimDataDispatcher();
+
+  /* Add a consumer. Consumers are called in the order of subscription for each packet.
+   * minIntervalMs: deliver not more often than this. 0 delivers every packet.
+   * receiver: callback is not called anymore once this object is deleted. */
+  void subscribe(QObject *receiver, int minIntervalMs, Callback callback);
+
+  /* Takes the packet as new snapshot and delivers it to all consumers which are due */
+  void dispatch(const atools::fs::sc::SimConnectData& data);
+
+  /* As above but without copying an already shared packet */
+  void dispatch(SimDataPtr data);
+
+  /* Stop all pending deliveries and drop the snapshot. Next packet is delivered to all consumers immediately. */
+  void clear();
+
+  /* Number of packets, deliveries, latency from arrival to delivery and time spent in the consumers per
+   * consumer since last reset. Used to measure throughput of the pipeline. */
+  QStringList getStatistics() const;
+  void resetStatistics();
+
+  /* Latest snapshot or null if nothing was received since last clear */
+  SimDataPtr getLatest() const
+  {
+    return latest;
+  }
+
+private:
+  struct Subscriber
+  {
+    QPointer<QObject> receiver;
+    int minIntervalMs;
+    Callback callback;
+    QElapsedTimer lastDelivery;
+
+    /* Single shot timer for coalesced delivery */
+    QTimer *timer;
+
+    /* Statistics */
+    quint64 numDelivered = 0;
+    qint64 latencyNs = 0L, maxLatencyNs = 0L, callbackNs = 0L, maxCallbackNs = 0L;
+  };
+
+  void deliver(Subscriber *subscriber);
+
+  /* Pointers since timer connections refer to the subscribers */
+  QVector<Subscriber *> subscribers;
+  SimDataPtr latest;
+
+  /* Started when latest was received */
+  QElapsedTimer latestTimer;
+  quint64 numDispatched = 0;
+};
+
+Q_DECLARE_METATYPE(SimDataDispatcher::SimDataPtr);
+
+#endif // LITTLENAVMAP_SIMDATADISPATCHER_H
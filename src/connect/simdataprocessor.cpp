@@ -0,0 +1,272 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdataprocessor.h"
+
+#include "geo/calculations.h"
+
+#include <QBuffer>
+#include <QDebug>
+
+using atools::geo::Pos;
+
+/* Delay takeoff and landing messages to avoid false recognition of bumpy landings */
+const int TAKEOFF_LANDING_TIMEOUT_MS = 5000;
+
+SimDataProcessor::SimDataProcessor(bool verboseParam)
+  : verbose(verboseParam)
+{
+}
+
+SimDataProcessor::~SimDataProcessor()
+{
+  delete partialData;
+}
+
+void SimDataProcessor::decodeBytes(const QByteArray& bytes, quint32 requestEpoch)
+{
+  if(requestEpoch != epoch)
+  {
+    // Received before the last reset
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Dropping bytes from epoch" << requestEpoch << "current" << epoch;
+    return;
+  }
+
+  buffer.append(bytes);
+
+  if(protocol.getMode() == cp::UNKNOWN)
+  {
+    // Check the start of the stream for a compact protocol hello
+    if(!protocol.detect(buffer))
+    {
+      if(!protocol.getErrorText().isEmpty())
+        fail(protocol.getErrorText());
+      return;
+    }
+
+    if(protocol.getMode() == cp::COMPACT)
+      emit compactProtocolDetected(protocol.getFlags(), epoch);
+  }
+
+  if(protocol.getMode() == cp::COMPACT)
+    decodeCompact();
+  else
+    decodeLegacy();
+}
+
+void SimDataProcessor::decodeLegacy()
+{
+  QBuffer device(&buffer);
+  device.open(QIODevice::ReadOnly);
+
+  while(device.bytesAvailable() > 0)
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << device.bytesAvailable();
+
+    if(partialData == nullptr)
+      partialData = new atools::fs::sc::SimConnectData;
+
+    bool read = partialData->read(&device);
+    if(partialData->getStatus() != atools::fs::sc::OK)
+    {
+      // Something went wrong - drop all and let the client shut down the connection
+      QString message = partialData->getStatusText();
+      device.close();
+      fail(message);
+      return;
+    }
+
+    if(!read)
+      // Wait for more data
+      break;
+
+    process(SimDataDispatcher::SimDataPtr(partialData));
+    partialData = nullptr;
+  }
+
+  // Remove consumed bytes
+  qint64 pos = device.pos();
+  device.close();
+  buffer.remove(0, static_cast<int>(pos));
+}
+
+void SimDataProcessor::decodeCompact()
+{
+  QByteArray packet;
+  cp::Result result;
+  while((result = protocol.readFrame(buffer, packet)) == cp::FRAME)
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "packet size" << packet.size();
+
+    // Frames always contain complete packets
+    QBuffer device(&packet);
+    device.open(QIODevice::ReadOnly);
+    atools::fs::sc::SimConnectData *data = new atools::fs::sc::SimConnectData;
+    bool read = data->read(&device);
+    device.close();
+
+    if(!read || data->getStatus() != atools::fs::sc::OK)
+    {
+      QString message = data->getStatus() != atools::fs::sc::OK ?
+                        data->getStatusText() : tr("Incomplete packet in frame");
+      delete data;
+      fail(message);
+      return;
+    }
+    process(SimDataDispatcher::SimDataPtr(data));
+  }
+
+  if(result == cp::ERROR)
+    fail(protocol.getErrorText());
+}
+
+void SimDataProcessor::fail(const QString& message)
+{
+  clear();
+  emit decodingFailed(message, epoch);
+}
+
+void SimDataProcessor::processPacket(atools::fs::sc::SimConnectData data)
+{
+  process(SimDataDispatcher::SimDataPtr(new atools::fs::sc::SimConnectData(data)));
+}
+
+void SimDataProcessor::reset(quint32 newEpoch)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "epoch" << newEpoch;
+
+  epoch = newEpoch;
+  clear();
+}
+
+void SimDataProcessor::clear()
+{
+  buffer.clear();
+  protocol.reset();
+  delete partialData;
+  partialData = nullptr;
+
+  takeoffLandingTimer.invalidate();
+  takeoffTimeMs = takeoffLastSampleTimeMs = 0L;
+  takeoffLandingDistanceNm = takeoffLandingAverageTasKts = 0.;
+  takeoffLandingLastAircraft = atools::fs::sc::SimConnectUserAircraft();
+  lastUserAircraft = atools::fs::sc::SimConnectUserAircraft();
+}
+
+void SimDataProcessor::process(SimDataDispatcher::SimDataPtr data)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "id" << data->getPacketId();
+
+  emit packetProcessed(data, epoch);
+
+  if(recorder.isOpen())
+    recorder.write(*data);
+
+  updateTakeoffLanding(data);
+}
+
+void SimDataProcessor::setRecordingFile(const QString& filename)
+{
+  if(filename.isEmpty())
+    recorder.close();
+  else
+    recorder.open(filename);
+}
+
+void SimDataProcessor::updateTakeoffLanding(const SimDataDispatcher::SimDataPtr& data)
+{
+  const atools::fs::sc::SimConnectUserAircraft& aircraft = data->getUserAircraft();
+  if(!aircraft.isValid())
+    return;
+
+  // Calculate travel distance since last takeoff event ===================================
+  if(!takeoffLandingLastAircraft.isValid())
+    // Set for the first time
+    takeoffLandingLastAircraft = aircraft;
+  else if(!aircraft.isSimReplay() && !takeoffLandingLastAircraft.isSimReplay())
+  {
+    // Use less accuracy for longer routes
+    float epsilon = takeoffLandingDistanceNm > 20. ? Pos::POS_EPSILON_500M : Pos::POS_EPSILON_10M;
+
+    // Check manhattan distance in degree to minimize samples
+    if(takeoffLandingLastAircraft.getPosition().distanceSimpleTo(aircraft.getPosition()) > epsilon)
+    {
+      if(takeoffTimeMs > 0)
+      {
+        // Calculate averaget TAS
+        qint64 currentSampleTime = aircraft.getZuluTime().toMSecsSinceEpoch();
+
+        // Only every ten seconds since the simulator timestamps are not precise enough
+        if(currentSampleTime > takeoffLastSampleTimeMs + 10000)
+        {
+          qint64 lastPeriod = currentSampleTime - takeoffLastSampleTimeMs;
+          qint64 flightimeToCurrentPeriod = currentSampleTime - takeoffTimeMs;
+
+          if(flightimeToCurrentPeriod > 0)
+            takeoffLandingAverageTasKts = ((takeoffLandingAverageTasKts * (takeoffLastSampleTimeMs - takeoffTimeMs)) +
+                                           (aircraft.getTrueAirspeedKts() * lastPeriod)) / flightimeToCurrentPeriod;
+          takeoffLastSampleTimeMs = currentSampleTime;
+        }
+      }
+
+      takeoffLandingDistanceNm +=
+        atools::geo::meterToNm(takeoffLandingLastAircraft.getPosition().distanceMeterTo(aircraft.getPosition()));
+
+      takeoffLandingLastAircraft = aircraft;
+    }
+  }
+
+  // Check for takeoff or landing events ===================================
+  if(lastUserAircraft.isValid() &&
+     !aircraft.isSimPaused() && !aircraft.isSimReplay() &&
+     !lastUserAircraft.isSimPaused() && !lastUserAircraft.isSimReplay())
+  {
+    // (Re)start timer to send takeoff/landing event
+    if(lastUserAircraft.isFlying() != aircraft.isFlying())
+      takeoffLandingTimer.start();
+  }
+  lastUserAircraft = aircraft;
+
+  if(takeoffLandingTimer.isValid() && takeoffLandingTimer.elapsed() > TAKEOFF_LANDING_TIMEOUT_MS)
+  {
+    takeoffLandingTimer.invalidate();
+
+    if(aircraft.isFlying())
+    {
+      // In air after status has changed
+      qDebug() << Q_FUNC_INFO << "Takeoff detected" << aircraft.getZuluTime();
+
+      takeoffLandingDistanceNm = 0.;
+      takeoffLandingAverageTasKts = aircraft.getTrueAirspeedKts();
+      takeoffLastSampleTimeMs = takeoffTimeMs = aircraft.getZuluTime().toMSecsSinceEpoch();
+
+      emit aircraftTakeoff(data, epoch);
+    }
+    else
+    {
+      // On ground after status has changed
+      qDebug() << Q_FUNC_INFO << "Landing detected takeoffLandingDistanceNm" << takeoffLandingDistanceNm;
+      emit aircraftLanding(data, static_cast<float>(takeoffLandingDistanceNm),
+                           static_cast<float>(takeoffLandingAverageTasKts), epoch);
+    }
+  }
+}
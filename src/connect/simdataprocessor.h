@@ -0,0 +1,119 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_SIMDATAPROCESSOR_H
+#define LITTLENAVMAP_SIMDATAPROCESSOR_H
+
+#include "connect/simdatadispatcher.h"
+#include "connect/compactprotocol.h"
+#include "connect/simdatarecorder.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+
+/*
+ * Decodes simulator data packets and calculates derived state. Lives in its own thread which is owned by the
+ * ConnectClient so that neither decoding of the Little Navconnect stream nor the takeoff and landing
+ * detection stall the GUI at high simulator update rates.
+ *
+ * Only the decoded and shared packets are posted to the GUI thread. Methods are called through queued
+ * connections or QMetaObject::invokeMethod.
+ *
+ * Each reset starts a new epoch. Requests and results carry the epoch they belong to which allows to drop
+ * everything that was still queued in either direction when the connection was reset.
+ */
+class SimDataProcessor :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  SimDataProcessor(bool verboseParam);
+  virtual ~SimDataProcessor();
+
+  /* Appends bytes received from the Little Navconnect socket and decodes all complete packets.
+   * Bytes are ignored if requestEpoch is not the one of the last reset. */
+  Q_INVOKABLE void decodeBytes(const QByteArray& bytes, quint32 requestEpoch);
+
+  /* Process a packet which was already decoded by the DataReaderThread */
+  void processPacket(atools::fs::sc::SimConnectData data);
+
+  /* Clear partially received data and derived state and start a new epoch. Call on connect and disconnect. */
+  Q_INVOKABLE void reset(quint32 newEpoch);
+
+  /* Write all packets to the given file. Stops recording if filename is empty. */
+  Q_INVOKABLE void setRecordingFile(const QString& filename);
+
+signals:
+  /* Packet decoded and processed. Can be aircraft position or weather update. */
+  void packetProcessed(SimDataDispatcher::SimDataPtr data, quint32 epoch);
+
+  /* Stream from Little Navconnect cannot be decoded. Connection should be closed. */
+  void decodingFailed(QString message, quint32 epoch);
+
+  /* Server advertised the compact protocol. flags are the offered cp::ProtocolFlag values. */
+  void compactProtocolDetected(quint16 flags, quint32 epoch);
+
+  /* Takeoff or landing was detected and confirmed after a delay to avoid false recognition of bumpy landings */
+  void aircraftTakeoff(SimDataDispatcher::SimDataPtr data, quint32 epoch);
+  void aircraftLanding(SimDataDispatcher::SimDataPtr data, float flownDistanceNm, float averageTasKts,
+                       quint32 epoch);
+
+private:
+  void process(SimDataDispatcher::SimDataPtr data);
+  void decodeLegacy();
+  void decodeCompact();
+  void fail(const QString& message);
+  void clear();
+  void updateTakeoffLanding(const SimDataDispatcher::SimDataPtr& data);
+
+  bool verbose = false;
+
+  /* Set by reset() */
+  quint32 epoch = 0;
+
+  /* Bytes received from socket which are not decoded yet */
+  QByteArray buffer;
+  CompactProtocol protocol;
+  SimDataRecorder recorder;
+
+  /* Have to keep it since it is read multiple times until complete */
+  atools::fs::sc::SimConnectData *partialData = nullptr;
+
+  /* Started when flying state changes. Event is sent when state is stable for a while. */
+  QElapsedTimer takeoffLandingTimer;
+
+  /* Simulator zulu time timestamp of takeoff event */
+  qint64 takeoffTimeMs = 0L;
+
+  /* Flown distance from takeoff event */
+  double takeoffLandingDistanceNm = 0.;
+
+  /* Average true airspeed from takeoff event */
+  double takeoffLandingAverageTasKts = 0.;
+
+  /* Last sample from average value calculation */
+  qint64 takeoffLastSampleTimeMs = 0L;
+
+  /* Used for distance calculation */
+  atools::fs::sc::SimConnectUserAircraft takeoffLandingLastAircraft;
+
+  /* User aircraft from last packet for takeoff and landing detection */
+  atools::fs::sc::SimConnectUserAircraft lastUserAircraft;
+};
+
+#endif // LITTLENAVMAP_SIMDATAPROCESSOR_H
@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/simdatarecorder.h"
+
+#include "connect/compactprotocol.h"
+#include "fs/sc/simconnectdata.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDebug>
+
+SimDataRecorder::SimDataRecorder()
+{
+}
+
+SimDataRecorder::~SimDataRecorder()
+{
+  close();
+}
+
+bool SimDataRecorder::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::WriteOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open recording" << filename << ":" << file.errorString();
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream << FILE_MAGIC << FILE_VERSION;
+
+  qInfo() << Q_FUNC_INFO << "Recording to" << filename;
+  lastPacket.clear();
+  numPackets = 0;
+  timer.start();
+  return true;
+}
+
+void SimDataRecorder::close()
+{
+  if(file.isOpen())
+  {
+    qInfo() << Q_FUNC_INFO << "Recorded" << numPackets << "packets to" << file.fileName();
+    file.close();
+  }
+  lastPacket.clear();
+}
+
+void SimDataRecorder::write(const atools::fs::sc::SimConnectData& data)
+{
+  if(!file.isOpen())
+    return;
+
+  // Serialize - write() is not const
+  QByteArray packet;
+  QBuffer buffer(&packet);
+  buffer.open(QIODevice::WriteOnly);
+  atools::fs::sc::SimConnectData(data).write(&buffer);
+  buffer.close();
+
+  if(numPackets % KEYFRAME_INTERVAL == 0)
+    lastPacket.clear();
+
+  QByteArray frame = CompactProtocol::encodeFrame(lastPacket, packet, true);
+
+  QDataStream stream(&file);
+  stream << static_cast<qint64>(timer.elapsed());
+  stream.writeRawData(frame.constData(), frame.size());
+
+  lastPacket = packet;
+  numPackets++;
+
+  if(stream.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Error writing recording" << file.fileName() << ":" << file.errorString();
+    close();
+  }
+}
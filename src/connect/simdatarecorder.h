@@ -0,0 +1,73 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_SIMDATARECORDER_H
+#define LITTLENAVMAP_SIMDATARECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+/*
+ * Writes all simulator data packets into a binary file which can be played back by the ReplayConnectHandler.
+ *
+ * File format: quint32 magic, quint16 version followed by one record per packet.
+ * Record: qint64 milliseconds since start of recording followed by a frame as written by
+ * CompactProtocol::encodeFrame(). Frames are delta encoded against the previous packet and compressed.
+ */
+class SimDataRecorder
+{
+public:
+  /* "LNMR" */
+  static Q_DECL_CONSTEXPR quint32 FILE_MAGIC = 0x4c4e4d52;
+  static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 1;
+
+  SimDataRecorder();
+  ~SimDataRecorder();
+
+  /* Create or overwrite file and start the clock. @return false if file cannot be created */
+  bool open(const QString& filename);
+  void close();
+
+  bool isOpen() const
+  {
+    return file.isOpen();
+  }
+
+  /* Append packet with current timestamp */
+  void write(const atools::fs::sc::SimConnectData& data);
+
+private:
+  QFile file;
+  QElapsedTimer timer;
+
+  /* Serialized last packet for delta encoding */
+  QByteArray lastPacket;
+
+  /* Write a keyframe every now and then to limit the size of deltas */
+  static Q_DECL_CONSTEXPR int KEYFRAME_INTERVAL = 100;
+  int numPackets = 0;
+};
+
+#endif // LITTLENAVMAP_SIMDATARECORDER_H
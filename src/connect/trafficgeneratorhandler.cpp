@@ -0,0 +1,153 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/trafficgeneratorhandler.h"
+
+#include "fs/sc/simconnectdata.h"
+#include "geo/calculations.h"
+
+#include <QDebug>
+
+using atools::geo::Pos;
+
+/* Fixed seed for repeatable runs */
+const unsigned int RANDOM_SEED = 4711;
+
+TrafficGeneratorHandler::TrafficGeneratorHandler(const atools::geo::Pos& centerParam, float radiusNmParam,
+                                                 int numAircraftParam)
+  : center(centerParam), radiusNm(radiusNmParam), numAircraft(numAircraftParam)
+{
+}
+
+TrafficGeneratorHandler::~TrafficGeneratorHandler()
+{
+}
+
+bool TrafficGeneratorHandler::connect()
+{
+  if(connected)
+    return true;
+
+  qInfo() << Q_FUNC_INFO << "Generating" << numAircraft << "aircraft around" << center << "radius" << radiusNm;
+
+  random.seed(RANDOM_SEED);
+  std::uniform_real_distribution<float> distDist(0.f, atools::geo::nmToMeter(radiusNm));
+  std::uniform_real_distribution<float> courseDist(0.f, 360.f);
+  std::uniform_real_distribution<float> speedDist(60.f, 480.f);
+  std::uniform_real_distribution<float> altDist(0.f, 40000.f);
+
+  targets.clear();
+
+  // User aircraft
+  Target user;
+  user.pos = center.endpoint(atools::geo::nmToMeter(radiusNm / 2.f), 0.f);
+  user.pos.setAltitude(5000.f);
+  user.lastPos = user.pos;
+  user.courseDeg = 90.f;
+  user.speedKts = 250.f;
+  targets.append(user);
+
+  for(int i = 0; i < numAircraft; i++)
+  {
+    Target target;
+    target.pos = center.endpoint(distDist(random), courseDist(random));
+    target.pos.setAltitude(altDist(random));
+    target.lastPos = target.pos;
+    target.courseDeg = courseDist(random);
+    target.speedKts = speedDist(random);
+    targets.append(target);
+  }
+
+  timer.start();
+  lastUpdateMs = 0L;
+  connected = true;
+  return true;
+}
+
+bool TrafficGeneratorHandler::fetchData(atools::fs::sc::SimConnectData& data, int radiusKm,
+                                        atools::fs::sc::Options options)
+{
+  Q_UNUSED(radiusKm);
+  Q_UNUSED(options);
+
+  if(!connected)
+    return false;
+
+  qint64 now = timer.elapsed();
+  float seconds = (now - lastUpdateMs) / 1000.f;
+  lastUpdateMs = now;
+
+  for(Target& target : targets)
+    move(target, seconds);
+
+  // User aircraft circles the center
+  Target& user = targets.first();
+  user.courseDeg = atools::geo::normalizeCourse(center.angleDegTo(user.pos) + 90.f);
+
+  data = atools::fs::sc::SimConnectData::buildDebugForPosition(user.pos, user.lastPos);
+
+  // Build AI aircraft from the debug user aircraft - there is no other way to set positions from outside
+  QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = data.getAiAircraft();
+  aiAircraft.reserve(targets.size() - 1);
+  for(int i = 1; i < targets.size(); i++)
+  {
+    const Target& target = targets.at(i);
+    atools::fs::sc::SimConnectAircraft aircraft =
+      atools::fs::sc::SimConnectData::buildDebugForPosition(target.pos, target.lastPos).getUserAircraft();
+
+    // Copy of the user aircraft - needs an id of its own and must not be detected as user
+    aircraft.setObjectId(static_cast<unsigned int>(i));
+    aircraft.setFlags(aircraft.getFlags() & ~atools::fs::sc::IS_USER);
+    aiAircraft.append(aircraft);
+  }
+  return true;
+}
+
+void TrafficGeneratorHandler::move(Target& target, float seconds)
+{
+  if(seconds <= 0.f || target.speedKts <= 0.f)
+    return;
+
+  // Turn back towards center when leaving the area
+  if(target.pos.distanceMeterTo(center) > atools::geo::nmToMeter(radiusNm))
+    target.courseDeg = target.pos.angleDegTo(center);
+
+  target.lastPos = target.pos;
+  target.pos = target.pos.endpoint(atools::geo::nmToMeter(target.speedKts * seconds / 3600.f), target.courseDeg);
+  target.pos.setAltitude(target.lastPos.getAltitude());
+}
+
+bool TrafficGeneratorHandler::fetchWeatherData(atools::fs::sc::SimConnectData& data)
+{
+  Q_UNUSED(data);
+  return false;
+}
+
+void TrafficGeneratorHandler::addWeatherRequest(const atools::fs::sc::WeatherRequest& request)
+{
+  weatherRequest = request;
+}
+
+const atools::fs::sc::WeatherRequest& TrafficGeneratorHandler::getWeatherRequest() const
+{
+  return weatherRequest;
+}
+
+QString TrafficGeneratorHandler::getName() const
+{
+  return QLatin1Literal("TrafficGenerator");
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_TRAFFICGENERATORHANDLER_H
+#define LITTLENAVMAP_TRAFFICGENERATORHANDLER_H
+
+#include "fs/sc/connecthandler.h"
+#include "fs/sc/weatherrequest.h"
+#include "geo/pos.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <random>
+
+/*
+ * Connect handler for the DataReaderThread which generates a configurable number of AI aircraft moving
+ * around a center position. Used to stress test the whole simulator data pipeline from decoding to
+ * painting without a simulator or a mega event.
+ *
+ * The random generator uses a fixed seed so that each run produces the same traffic.
+ * The user aircraft circles the center.
+ */
+class TrafficGeneratorHandler :
+  public atools::fs::sc::ConnectHandler
+{
+public:
+  TrafficGeneratorHandler(const atools::geo::Pos& centerParam, float radiusNmParam, int numAircraftParam);
+  virtual ~TrafficGeneratorHandler();
+
+  /* Creates the initial traffic */
+  virtual bool connect() override;
+
+  virtual bool isLoaded() const override
+  {
+    return true;
+  }
+
+  /* Moves all aircraft by the time elapsed since last call */
+  virtual bool fetchData(atools::fs::sc::SimConnectData& data, int radiusKm,
+                         atools::fs::sc::Options options) override;
+
+  /* No weather */
+  virtual bool fetchWeatherData(atools::fs::sc::SimConnectData& data) override;
+  virtual void addWeatherRequest(const atools::fs::sc::WeatherRequest& request) override;
+  virtual const atools::fs::sc::WeatherRequest& getWeatherRequest() const override;
+
+  virtual bool isSimRunning() const override
+  {
+    return connected;
+  }
+
+  virtual bool isSimPaused() const override
+  {
+    return false;
+  }
+
+  virtual atools::fs::sc::State getState() const override
+  {
+    return atools::fs::sc::STATEOK;
+  }
+
+  virtual QString getName() const override;
+
+  int getNumAircraft() const
+  {
+    return numAircraft;
+  }
+
+private:
+  /* One generated aircraft */
+  struct Target
+  {
+    atools::geo::Pos pos, lastPos;
+    float courseDeg, speedKts;
+  };
+
+  void move(Target& target, float seconds);
+
+  atools::geo::Pos center;
+  float radiusNm;
+  int numAircraft;
+  bool connected = false;
+
+  /* First is user aircraft */
+  QVector<Target> targets;
+  QElapsedTimer timer;
+  qint64 lastUpdateMs = 0L;
+  std::mt19937 random;
+
+  atools::fs::sc::WeatherRequest weatherRequest;
+};
+
+#endif // LITTLENAVMAP_TRAFFICGENERATORHANDLER_H
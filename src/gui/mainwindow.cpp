@@ -24,7 +24,9 @@
 #include "common/mapcolors.h"
 #include "gui/application.h"
 #include "weather/weatherreporter.h"
+#include "weather/airportweatheroverlay.h"
 #include "connect/connectclient.h"
+#include "connect/simdatadispatcher.h"
 #include "common/elevationprovider.h"
 #include "db/databasemanager.h"
 #include "gui/dialog.h"
@@ -785,8 +787,10 @@ void MainWindow::connectAllSlots()
   connect(userdataController, &UserdataController::userdataChanged, this, &MainWindow::updateMapObjectsShown);
   connect(userdataController, &UserdataController::refreshUserdataSearch, userSearch, &UserdataSearch::refreshData);
 
-  connect(mapWidget, &MapWidget::aircraftTakeoff, userdataController, &UserdataController::aircraftTakeoff);
-  connect(mapWidget, &MapWidget::aircraftLanding, userdataController, &UserdataController::aircraftLanding);
+  connect(NavApp::getConnectClient(), &ConnectClient::aircraftTakeoff, userdataController,
+          &UserdataController::aircraftTakeoff);
+  connect(NavApp::getConnectClient(), &ConnectClient::aircraftLanding, userdataController,
+          &UserdataController::aircraftLanding);
 
   // Online search ===================================================================================
   OnlineClientSearch *clientSearch = searchController->getOnlineClientSearch();
@@ -825,6 +829,8 @@ void MainWindow::connectAllSlots()
           mapWidget, &MapWidget::onlineClientAndAtcUpdated);
   connect(onlinedataController, &OnlinedataController::onlineNetworkChanged,
           mapWidget, &MapWidget::onlineNetworkChanged);
+  connect(onlinedataController, &OnlinedataController::onlineClientPositionsUpdated,
+          mapWidget, &MapWidget::onlineClientPositionsUpdated);
 
   // Update info
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated,
@@ -1002,6 +1008,7 @@ void MainWindow::connectAllSlots()
   connect(ui->actionMapShowSoftAirports, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowEmptyAirports, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowAddonAirports, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
+  connect(ui->actionMapShowAirportWeather, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowVor, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowNdb, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
   connect(ui->actionMapShowWp, &QAction::toggled, this, &MainWindow::updateMapObjectsShown);
@@ -1070,11 +1077,28 @@ void MainWindow::connectAllSlots()
   connect(ui->actionConnectSimulator, &QAction::triggered, connectClient, &ConnectClient::connectToServerDialog);
 
   // Deliver first to route controller to update active leg and distances
-  connect(connectClient, &ConnectClient::dataPacketReceived, routeController, &RouteController::simDataChanged);
+  SimDataDispatcher *simDataDispatcher = connectClient->getSimDataDispatcher();
+  simDataDispatcher->subscribe(routeController, RouteController::MIN_SIM_UPDATE_TIME_MS,
+                               [this](const atools::fs::sc::SimConnectData& data)
+  {
+    routeController->simDataChanged(data);
+  });
 
-  connect(connectClient, &ConnectClient::dataPacketReceived, mapWidget, &MapWidget::simDataChanged);
-  connect(connectClient, &ConnectClient::dataPacketReceived, profileWidget, &ProfileWidget::simDataChanged);
-  connect(connectClient, &ConnectClient::dataPacketReceived, infoController, &InfoController::simulatorDataReceived);
+  // Map needs all packets to record the track and detect takeoff and landing
+  simDataDispatcher->subscribe(mapWidget, 0, [this](const atools::fs::sc::SimConnectData& data)
+  {
+    mapWidget->simDataChanged(data);
+  });
+  simDataDispatcher->subscribe(profileWidget, ProfileWidget::MIN_SIM_UPDATE_TIME_MS,
+                               [this](const atools::fs::sc::SimConnectData& data)
+  {
+    profileWidget->simDataChanged(data);
+  });
+  simDataDispatcher->subscribe(infoController, InfoController::MIN_SIM_UPDATE_TIME_MS,
+                               [this](const atools::fs::sc::SimConnectData& data)
+  {
+    infoController->simulatorDataReceived(data);
+  });
 
   connect(connectClient, &ConnectClient::disconnectedFromSimulator, routeController,
           &RouteController::disconnectedFromSimulator);
@@ -1098,6 +1122,9 @@ void MainWindow::connectAllSlots()
 
   connect(weatherReporter, &WeatherReporter::weatherUpdated, mapWidget, &MapWidget::updateTooltip);
   connect(weatherReporter, &WeatherReporter::weatherUpdated, infoController, &InfoController::updateAirport);
+  connect(weatherReporter->getAirportWeatherOverlay(), &AirportWeatherOverlay::overlayUpdated,
+          mapWidget, &MapWidget::airportWeatherUpdated);
+  connect(routeController, &RouteController::routeChanged, weatherReporter, &WeatherReporter::routeChanged);
 
   connect(connectClient, &ConnectClient::weatherUpdated, mapWidget, &MapWidget::updateTooltip);
   connect(connectClient, &ConnectClient::weatherUpdated, infoController, &InfoController::updateAirport);
@@ -2441,7 +2468,7 @@ void MainWindow::restoreStateMain()
   {
     widgetState.restore({ui->actionMapShowAirports, ui->actionMapShowSoftAirports,
                          ui->actionMapShowEmptyAirports,
-                         ui->actionMapShowAddonAirports,
+                         ui->actionMapShowAddonAirports, ui->actionMapShowAirportWeather,
                          ui->actionMapShowVor, ui->actionMapShowNdb, ui->actionMapShowWp,
                          ui->actionMapShowIls,
                          ui->actionMapShowVictorAirways, ui->actionMapShowJetAirways,
@@ -2571,7 +2598,7 @@ void MainWindow::saveActionStates()
   atools::gui::WidgetState widgetState(lnm::MAINWINDOW_WIDGET);
   widgetState.save({mapProjectionComboBox, mapThemeComboBox,
                     ui->actionMapShowAirports, ui->actionMapShowSoftAirports, ui->actionMapShowEmptyAirports,
-                    ui->actionMapShowAddonAirports,
+                    ui->actionMapShowAddonAirports, ui->actionMapShowAirportWeather,
                     ui->actionMapShowVor, ui->actionMapShowNdb, ui->actionMapShowWp, ui->actionMapShowIls,
                     ui->actionMapShowVictorAirways, ui->actionMapShowJetAirways,
                     ui->actionShowAirspaces, ui->actionShowAirspacesOnline,
@@ -807,32 +807,26 @@ void InfoController::updateAiAircraftText()
     ui->textBrowserAircraftAiInfo->clear();
 }
 
-void InfoController::simulatorDataReceived(atools::fs::sc::SimConnectData data)
+void InfoController::simulatorDataReceived(const atools::fs::sc::SimConnectData& data)
 {
   if(databaseLoadStatus)
     return;
 
-  if(atools::almostNotEqual(QDateTime::currentDateTime().toMSecsSinceEpoch(),
-                            lastSimUpdate, static_cast<qint64>(MIN_SIM_UPDATE_TIME_MS)))
-  {
-    // Last update was more than 500 ms ago
-    updateAiAirports(data);
+  updateAiAirports(data);
 
-    Ui::MainWindow *ui = NavApp::getMainUi();
+  Ui::MainWindow *ui = NavApp::getMainUi();
 
-    lastSimData = data;
-    if(data.getUserAircraft().getPosition().isValid() && ui->dockWidgetAircraft->isVisible())
-    {
-      if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_USER)
-        updateUserAircraftText();
+  lastSimData = data;
+  if(data.getUserAircraft().getPosition().isValid() && ui->dockWidgetAircraft->isVisible())
+  {
+    if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_USER)
+      updateUserAircraftText();
 
-      if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_USER_PROGRESS)
-        updateAircraftProgressText();
+    if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_USER_PROGRESS)
+      updateAircraftProgressText();
 
-      if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_AI)
-        updateAiAircraftText();
-    }
-    lastSimUpdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
+    if(ui->tabWidgetAircraft->currentIndex() == ic::AIRCRAFT_AI)
+      updateAiAircraftText();
   }
 }
 
@@ -872,7 +866,6 @@ void InfoController::disconnectedFromSimulator()
 {
   qDebug() << Q_FUNC_INFO;
   lastSimData = atools::fs::sc::SimConnectData();
-  lastSimUpdate = 0;
   updateAircraftInfo();
 }
 
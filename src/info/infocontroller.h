@@ -63,6 +63,9 @@ class InfoController :
   Q_OBJECT
 
 public:
+  /* Do not update aircraft information more than every 0.5 seconds */
+  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 500;
+
   InfoController(MainWindow *parent);
   virtual ~InfoController();
 
@@ -82,8 +85,8 @@ public:
   void preDatabaseLoad();
   void postDatabaseLoad();
 
-  /* Update aircraft and aircraft progress tab */
-  void simulatorDataReceived(atools::fs::sc::SimConnectData data);
+  /* Update aircraft and aircraft progress tab. Update rate is limited by the SimDataDispatcher. */
+  void simulatorDataReceived(const atools::fs::sc::SimConnectData& data);
   void connectedToSimulator();
   void disconnectedFromSimulator();
 
@@ -107,9 +110,6 @@ signals:
   void showRect(const atools::geo::Rect& rect, bool doubleClick);
 
 private:
-  /* Do not update aircraft information more than every 0.5 seconds */
-  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 500;
-
   void updateTextEditFontSizes();
   void setTextEditFontSize(QTextEdit *textEdit, float origSize, int percent);
   void anchorClicked(const QUrl& url);
@@ -125,7 +125,6 @@ private:
 
   bool databaseLoadStatus = false;
   atools::fs::sc::SimConnectData lastSimData;
-  qint64 lastSimUpdate = 0;
 
   /* Airport and navaids that are currently shown in the tabs */
   map::MapSearchResult currentSearchResult;
@@ -34,10 +34,14 @@
 #include "common/aircrafttrack.h"
 #include "fs/sc/simconnectdata.h"
 #include "fs/sc/simconnectreply.h"
+#include "connect/simdatadispatcher.h"
+#include "connect/connectclient.h"
 #include "common/maptypes.h"
 #include "common/proctypes.h"
 #include "common/unit.h"
 #include "userdata/userdataicons.h"
+#include "mapgui/mapbenchmark.h"
+#include "mapgui/mapwidget.h"
 
 #include <QCommandLineParser>
 #include <QDebug>
@@ -46,6 +50,7 @@
 #include <QStyleFactory>
 #include <QSharedMemory>
 #include <QMessageBox>
+#include <QTimer>
 
 #include <marble/MarbleGlobal.h>
 #include <marble/MarbleDirs.h>
@@ -88,6 +93,7 @@ int main(int argc, char *argv[])
   qRegisterMetaType<atools::fs::sc::SimConnectData>();
   qRegisterMetaType<atools::fs::sc::SimConnectReply>();
   qRegisterMetaType<atools::fs::sc::WeatherRequest>();
+  qRegisterMetaType<SimDataDispatcher::SimDataPtr>();
 
   // Set application information
   int retval = 0;
@@ -116,6 +122,63 @@ int main(int argc, char *argv[])
                                       QObject::tr("settings-directory"));
     parser.addOption(settingsDirOpt);
 
+    QCommandLineOption benchmarkOpt("map-benchmark",
+                                    QObject::tr("Replay map viewports from <viewport-file>, print a rendering "
+                                                "benchmark report and exit. "
+                                                "Use together with \"-platform offscreen\" to run without display."),
+                                    QObject::tr("viewport-file"));
+    parser.addOption(benchmarkOpt);
+
+    QCommandLineOption benchmarkReportOpt("map-benchmark-report",
+                                          QObject::tr("Write map benchmark report to <report-file>."),
+                                          QObject::tr("report-file"));
+    parser.addOption(benchmarkReportOpt);
+
+    QCommandLineOption benchmarkFramesOpt("map-benchmark-frames",
+                                          QObject::tr("Number of measured map benchmark frames per viewport."),
+                                          QObject::tr("frames"));
+    parser.addOption(benchmarkFramesOpt);
+
+    QCommandLineOption simRecordOpt("sim-record",
+                                    QObject::tr("Record all simulator data packets to <record-file>."),
+                                    QObject::tr("record-file"));
+    parser.addOption(simRecordOpt);
+
+    QCommandLineOption simReplayOpt("sim-replay",
+                                    QObject::tr("Replay simulator data from <record-file> instead of connecting "
+                                                "to a simulator."),
+                                    QObject::tr("record-file"));
+    parser.addOption(simReplayOpt);
+
+    QCommandLineOption simReplaySpeedOpt("sim-replay-speed",
+                                         QObject::tr("Replay speed factor. 1 is recorded speed and "
+                                                     "0 is as fast as possible."),
+                                         QObject::tr("speed"), "1");
+    parser.addOption(simReplaySpeedOpt);
+
+    QCommandLineOption simTrafficOpt("sim-traffic",
+                                     QObject::tr("Generate <number> moving AI aircraft instead of connecting "
+                                                 "to a simulator and log throughput statistics."),
+                                     QObject::tr("number"));
+    parser.addOption(simTrafficOpt);
+
+    QCommandLineOption simTrafficCenterOpt("sim-traffic-center",
+                                           QObject::tr("Center of generated traffic as <longitude,latitude>. "
+                                                       "Default is the map center."),
+                                           QObject::tr("longitude,latitude"));
+    parser.addOption(simTrafficCenterOpt);
+
+    QCommandLineOption simTrafficRadiusOpt("sim-traffic-radius",
+                                           QObject::tr("Radius of generated traffic area in NM."),
+                                           QObject::tr("radius"), "100");
+    parser.addOption(simTrafficRadiusOpt);
+
+    QCommandLineOption simTrafficRateOpt("sim-traffic-rate",
+                                         QObject::tr("Update rate of generated traffic in milliseconds. "
+                                                     "Must be at least 1."),
+                                         QObject::tr("milliseconds"), "200");
+    parser.addOption(simTrafficRateOpt);
+
     // Process the actual command line arguments given by the user
     parser.process(*QCoreApplication::instance());
 
@@ -258,8 +321,51 @@ int main(int argc, char *argv[])
       // Hide splash once main window is shown
       NavApp::finishSplashScreen();
 
+      if(parser.isSet(simRecordOpt))
+        NavApp::getConnectClient()->startRecording(parser.value(simRecordOpt));
+
+      if(parser.isSet(simReplayOpt))
+        NavApp::getConnectClient()->startReplay(parser.value(simReplayOpt),
+                                                parser.value(simReplaySpeedOpt).toFloat());
+
+      if(parser.isSet(simTrafficOpt))
+      {
+        atools::geo::Pos center(NavApp::getMapWidget()->centerLongitude(),
+                                NavApp::getMapWidget()->centerLatitude());
+        QStringList centerValues = parser.value(simTrafficCenterOpt).split(',');
+        if(centerValues.size() == 2)
+          center = atools::geo::Pos(centerValues.at(0).toFloat(), centerValues.at(1).toFloat());
+
+        // 0 would make the reader thread loop without waiting
+        int rateMs = parser.value(simTrafficRateOpt).toInt();
+        if(rateMs < 1)
+        {
+          qWarning() << "Invalid traffic update rate" << parser.value(simTrafficRateOpt) << "using 1 ms";
+          rateMs = 1;
+        }
+
+        NavApp::getConnectClient()->startTrafficGenerator(center, parser.value(simTrafficRadiusOpt).toFloat(),
+                                                          parser.value(simTrafficOpt).toInt(), rateMs);
+      }
+
+      MapBenchmark *benchmark = nullptr;
+      if(parser.isSet(benchmarkOpt))
+      {
+        // Run benchmark once the event loop is running and exit afterwards
+        benchmark = new MapBenchmark(NavApp::getMapWidget(), parser.value(benchmarkOpt),
+                                     parser.value(benchmarkReportOpt));
+        if(parser.isSet(benchmarkFramesOpt))
+          benchmark->setFrames(parser.value(benchmarkFramesOpt).toInt(), 3);
+
+        QTimer::singleShot(0, [benchmark]() {
+          QApplication::exit(benchmark->run() ? 0 : 1);
+        });
+      }
+
       qDebug() << "Before app.exec()";
       retval = app.exec();
+
+      delete benchmark;
     }
 
     qInfo() << "app.exec() done, retval is" << retval << (retval == 0 ? "(ok)" : "(error)");
@@ -0,0 +1,275 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapbenchmark.h"
+
+#include "navapp.h"
+#include "mapgui/mapwidget.h"
+#include "mapgui/mappaintlayer.h"
+#include "route/routecontroller.h"
+#include "fs/sc/simconnectdata.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QTextStream>
+
+#include <marble/MarbleGlobal.h>
+
+/* Names for the map features column */
+static const QHash<QString, map::MapObjectTypes> FEATURE_NAMES(
+{
+  {"airport", map::AIRPORT},
+  {"airport_weather", map::AIRPORT_WEATHER},
+  {"vor", map::VOR},
+  {"ndb", map::NDB},
+  {"waypoint", map::WAYPOINT},
+  {"ils", map::ILS},
+  {"airwayv", map::AIRWAYV},
+  {"airwayj", map::AIRWAYJ},
+  {"airspace", map::AIRSPACE},
+  {"airspace_online", map::AIRSPACE_ONLINE},
+  {"aircraft_ai", map::AIRCRAFT_AI},
+  {"aircraft_online", map::AIRCRAFT_ONLINE},
+  {"aircraft_ship", map::AIRCRAFT_AI_SHIP},
+  {"aircraft_track", map::AIRCRAFT_TRACK},
+  {"userpoint", map::USERPOINT}
+});
+
+MapBenchmark::MapBenchmark(MapWidget *mapWidgetParam, const QString& viewportFilename,
+                           const QString& reportFilename)
+  : mapWidget(mapWidgetParam), viewportFile(viewportFilename), reportFile(reportFilename)
+{
+}
+
+MapBenchmark::~MapBenchmark()
+{
+}
+
+bool MapBenchmark::readViewports()
+{
+  viewports.clear();
+
+  QFile file(viewportFile);
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    qWarning() << "Cannot read benchmark viewports" << viewportFile << ":" << file.errorString();
+    return false;
+  }
+
+  QTextStream stream(&file);
+  int lineNum = 0;
+  while(!stream.atEnd())
+  {
+    QString line = stream.readLine().trimmed();
+    lineNum++;
+
+    if(line.isEmpty() || line.startsWith('#'))
+      continue;
+
+    QStringList cols = line.split(';');
+    if(cols.size() < 3)
+    {
+      qWarning() << "Invalid benchmark viewport in line" << lineNum << ":" << line;
+      continue;
+    }
+
+    bool okLon, okLat, okDist;
+    Viewport viewport;
+    viewport.center = atools::geo::Pos(cols.at(0).toFloat(&okLon), cols.at(1).toFloat(&okLat));
+    viewport.distanceKm = cols.at(2).toFloat(&okDist);
+    if(!okLon || !okLat || !okDist)
+    {
+      qWarning() << "Invalid benchmark viewport in line" << lineNum << ":" << line;
+      continue;
+    }
+
+    viewport.projection = cols.value(3).trimmed().toLower();
+
+    QString features = cols.value(4).trimmed().toLower();
+    if(!features.isEmpty())
+    {
+      viewport.hasFeatures = true;
+      for(const QString& feature : features.split(',', QString::SkipEmptyParts))
+      {
+        if(FEATURE_NAMES.contains(feature.trimmed()))
+          viewport.features |= FEATURE_NAMES.value(feature.trimmed());
+        else
+          qWarning() << "Unknown benchmark map feature in line" << lineNum << ":" << feature;
+      }
+    }
+
+    viewport.flightplan = cols.value(5).trimmed();
+
+    QStringList aircraft = cols.value(6).split(',', QString::SkipEmptyParts);
+    if(aircraft.size() >= 2)
+      viewport.aircraft = atools::geo::Pos(aircraft.at(0).toFloat(), aircraft.at(1).toFloat(),
+                                           aircraft.value(2, "0").toFloat());
+
+    viewports.append(viewport);
+  }
+  file.close();
+
+  qInfo() << "Read" << viewports.size() << "benchmark viewports from" << viewportFile;
+  return !viewports.isEmpty();
+}
+
+void MapBenchmark::applyViewport(const Viewport& viewport)
+{
+  if(viewport.projection == "mercator")
+    mapWidget->setProjection(Marble::Mercator);
+  else if(viewport.projection == "spherical")
+    mapWidget->setProjection(Marble::Spherical);
+
+  if(viewport.hasFeatures)
+  {
+    map::MapObjectTypes allFeatures = map::NONE;
+    for(map::MapObjectTypes type : FEATURE_NAMES.values())
+      allFeatures |= type;
+
+    mapWidget->setShowMapFeatures(allFeatures, false);
+    mapWidget->setShowMapFeatures(viewport.features, true);
+  }
+
+  if(!viewport.flightplan.isEmpty())
+    NavApp::getRouteController()->loadFlightplan(viewport.flightplan);
+
+  if(viewport.aircraft.isValid())
+    mapWidget->simDataChanged(atools::fs::sc::SimConnectData::buildDebugForPosition(viewport.aircraft,
+                                                                                     viewport.aircraft));
+
+  mapWidget->setDistance(viewport.distanceKm);
+  mapWidget->centerOn(viewport.center.getLonX(), viewport.center.getLatY(), false);
+}
+
+bool MapBenchmark::run()
+{
+  if(!readViewports())
+    return false;
+
+  MapPaintProfiler *profiler = mapWidget->getMapPaintLayer()->getProfiler();
+  profiler->setCollect(true);
+
+  frameNsecs.clear();
+  frameStats.clear();
+
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  // Fixed size keeps the layout of the main window from resizing the map
+  mapWidget->setFixedSize(size);
+
+  QElapsedTimer benchmarkTimer;
+  benchmarkTimer.start();
+
+  for(int i = 0; i < viewports.size(); i++)
+  {
+    applyViewport(viewports.at(i));
+
+    // Render a few frames to get caches and map tiles loaded
+    for(int j = 0; j < warmupFrames; j++)
+    {
+      QApplication::processEvents();
+      mapWidget->render(&image);
+    }
+
+    for(int j = 0; j < frames; j++)
+    {
+      QApplication::processEvents();
+
+      QElapsedTimer timer;
+      timer.start();
+      mapWidget->render(&image);
+      frameNsecs.append(timer.nsecsElapsed());
+      frameStats.append(profiler->getLastFrame());
+    }
+    qInfo() << "Benchmark viewport" << (i + 1) << "of" << viewports.size() << "done";
+  }
+  profiler->setCollect(false);
+
+  // Build report ===================================================
+  QStringList report;
+  QVector<qint64> sorted(frameNsecs), sortedLayer;
+  for(const MapPaintProfiler::FrameStats& stats : frameStats)
+    sortedLayer.append(stats.nsecs);
+  std::sort(sorted.begin(), sorted.end());
+  std::sort(sortedLayer.begin(), sortedLayer.end());
+
+  report << QString("Viewports %1, frames %2, size %3x%4, total %5 s").
+    arg(viewports.size()).arg(frameNsecs.size()).arg(size.width()).arg(size.height()).
+    arg(benchmarkTimer.elapsed() / 1000., 0, 'f', 1);
+
+  report << QString("Percentile;frame_ms;paint_layer_ms");
+  for(int percent : {50, 90, 95, 99, 100})
+    report << QString("%1;%2;%3").arg(percent).
+      arg(percentile(sorted, percent) / 1000000., 0, 'f', 3).
+      arg(percentile(sortedLayer, percent) / 1000000., 0, 'f', 3);
+
+  report << QString("Painter;average_ms;max_ms;average_objects;average_wtos;average_cache_hits;"
+                    "average_cache_misses");
+  double num = std::max(frameStats.size(), 1);
+  for(int i = 0; i < MapPaintProfiler::NUM_PAINTERS; i++)
+  {
+    double ms = 0., maxMs = 0., objects = 0., wToS = 0., hits = 0., misses = 0.;
+    for(const MapPaintProfiler::FrameStats& stats : frameStats)
+    {
+      const MapPaintProfiler::PainterStats& painter = stats.painters[i];
+      ms += painter.nsecs / 1000000.;
+      maxMs = std::max(maxMs, painter.nsecs / 1000000.);
+      objects += painter.objects;
+      wToS += painter.wToS;
+      hits += painter.cacheHits;
+      misses += painter.cacheMisses;
+    }
+
+    report << QString("%1;%2;%3;%4;%5;%6;%7").
+      arg(MapPaintProfiler::painterName(static_cast<MapPaintProfiler::PainterId>(i))).
+      arg(ms / num, 0, 'f', 3).arg(maxMs, 0, 'f', 3).arg(objects / num, 0, 'f', 1).
+      arg(wToS / num, 0, 'f', 1).arg(hits / num, 0, 'f', 1).arg(misses / num, 0, 'f', 1);
+  }
+
+  for(const QString& line : report)
+    qInfo().noquote() << line;
+
+  if(!reportFile.isEmpty())
+  {
+    QFile file(reportFile);
+    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+      QTextStream stream(&file);
+      stream << report.join('\n') << endl;
+      file.close();
+      qInfo() << "Benchmark report written to" << reportFile;
+    }
+    else
+    {
+      qWarning() << "Cannot write benchmark report" << reportFile << ":" << file.errorString();
+      return false;
+    }
+  }
+  return true;
+}
+
+qint64 MapBenchmark::percentile(const QVector<qint64>& sortedValues, int percent)
+{
+  if(sortedValues.isEmpty())
+    return 0L;
+
+  int index = static_cast<int>(std::ceil(percent / 100. * sortedValues.size())) - 1;
+  return sortedValues.at(std::min(std::max(index, 0), sortedValues.size() - 1));
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_MAPBENCHMARK_H
+#define LITTLENAVMAP_MAPBENCHMARK_H
+
+#include "mapgui/mappaintprofiler.h"
+#include "common/mapflags.h"
+#include "geo/pos.h"
+
+#include <QSize>
+#include <QVector>
+
+class MapWidget;
+
+/*
+ * Replays a list of recorded viewports on the map widget, renders each one into an offscreen image and
+ * reports frame time percentiles as well as a per painter breakdown collected by the MapPaintProfiler.
+ *
+ * Started from the command line option "--map-benchmark". Run with "-platform offscreen" to
+ * use it without a display.
+ *
+ * Viewport file has one viewport per line and ';' separated columns. Empty lines and lines starting with '#'
+ * are ignored. Only the first three columns are required:
+ * longitude;latitude;distance in km;projection (mercator or spherical);comma separated map features;
+ * flight plan file;user aircraft position as longitude,latitude,altitude in ft
+ *
+ * Features are any of: airport,airport_weather,vor,ndb,waypoint,ils,airwayv,airwayj,airspace,airspace_online,
+ * aircraft_ai,aircraft_online,aircraft_ship,aircraft_track,userpoint. An empty column keeps the current features.
+ */
+class MapBenchmark
+{
+  Q_DECLARE_TR_FUNCTIONS(MapBenchmark)
+
+public:
+  MapBenchmark(MapWidget *mapWidgetParam, const QString& viewportFilename, const QString& reportFilename);
+  ~MapBenchmark();
+
+  /* Image size used for rendering */
+  void setSize(const QSize& value)
+  {
+    size = value;
+  }
+
+  /* Number of measured frames and unmeasured warm up frames per viewport */
+  void setFrames(int measured, int warmup)
+  {
+    frames = measured;
+    warmupFrames = warmup;
+  }
+
+  /* Run the benchmark and write the report. Blocks until all viewports are replayed.
+   * @return false if the viewport file could not be read or the report not be written */
+  bool run();
+
+private:
+  /* One recorded viewport */
+  struct Viewport
+  {
+    atools::geo::Pos center;
+    float distanceKm;
+    QString projection, flightplan;
+    bool hasFeatures = false;
+    map::MapObjectTypes features = map::NONE;
+    atools::geo::Pos aircraft;
+  };
+
+  bool readViewports();
+  void applyViewport(const Viewport& viewport);
+
+  /* Returns value at percentile 0-100 from the sorted list */
+  static qint64 percentile(const QVector<qint64>& sortedValues, int percent);
+
+  MapWidget *mapWidget;
+  QString viewportFile, reportFile;
+  QVector<Viewport> viewports;
+
+  QSize size = QSize(1280, 1024);
+  int frames = 10, warmupFrames = 3;
+
+  /* Frame and painter statistics for all measured frames */
+  QVector<qint64> frameNsecs;
+  QVector<MapPaintProfiler::FrameStats> frameStats;
+};
+
+#endif // LITTLENAVMAP_MAPBENCHMARK_H
@@ -413,6 +413,12 @@ MapLayer& MapLayer::onlineAircraftText(bool value)
   return *this;
 }
 
+MapLayer& MapLayer::aiAircraftDetail(layer::AiAircraftDetail detail)
+{
+  layerAiAircraftDetail = detail;
+  return *this;
+}
+
 MapLayer& MapLayer::airportMaxTextLength(int size)
 {
   maximumTextLengthAirport = size;
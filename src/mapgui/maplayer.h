@@ -29,6 +29,14 @@ enum AirportSource
   LARGE /* use airport_large table as source */
 };
 
+/* Level of detail for AI, multiplayer and online aircraft */
+enum AiAircraftDetail
+{
+  AI_ICON, /* Full icon including labels */
+  AI_DOT, /* Simple dot for each aircraft */
+  AI_CLUSTER /* Aircraft aggregated into markers showing the number of aircraft */
+};
+
 /* Do not show anything at all above this zoom distance */
 constexpr float DISTANCE_CUT_OFF_LIMIT = 4000.f;
 
@@ -176,6 +184,9 @@ public:
   MapLayer& onlineAircraft(bool value = true);
   MapLayer& onlineAircraftText(bool value = true);
 
+  /* Level of detail for all AI and online aircraft */
+  MapLayer& aiAircraftDetail(layer::AiAircraftDetail detail);
+
   bool operator<(const MapLayer& other) const;
 
   float getMaxRange() const
@@ -499,6 +510,11 @@ public:
     return layerOnlineAircraftText;
   }
 
+  layer::AiAircraftDetail getAiAircraftDetail() const
+  {
+    return layerAiAircraftDetail;
+  }
+
   int getMaxTextLengthAirport() const
   {
     return maximumTextLengthAirport;
@@ -548,6 +564,7 @@ private:
        layerOnlineAircraft = false,
        layerAiShipLarge = false, layerAiShipSmall = false,
        layerAiAircraftGroundText = false, layerAiAircraftText = false, layerOnlineAircraftText = false;
+  layer::AiAircraftDetail layerAiAircraftDetail = layer::AI_ICON;
 
 };
 
@@ -24,16 +24,39 @@
 #include "mapgui/mapfunctions.h"
 #include "util/paintercontextsaver.h"
 #include "geo/calculations.h"
+#include "common/mapcolors.h"
 
 #include <marble/GeoPainter.h>
 #include <marble/ViewportParams.h>
 
+#include <QBitArray>
+#include <QHash>
+
 using atools::fs::sc::SimConnectAircraft;
 
 const int NUM_CLOSEST_AI_LABELS = 5;
 const float DIST_METER_CLOSEST_AI_LABELS = atools::geo::nmToMeter(20);
 const float DIST_FT_CLOSEST_AI_LABELS = 5000;
 
+/* Reduce level of detail if more aircraft are visible */
+const int MAX_AI_ICONS = 300;
+const int MAX_AI_DOTS = 5000;
+
+/* Size of the screen grid cells in pixel used to aggregate aircraft into clusters */
+const int AI_CLUSTER_CELL_SIZE = 64;
+
+/* Size of the dots in pixel */
+const float AI_DOT_SIZE = 5.f;
+
+/* Dot color depending on type of aircraft. Ships are not drawn as dots. */
+static const QColor& aiDotColor(const SimConnectAircraft& aircraft)
+{
+  if(aircraft.isOnline())
+    return mapcolors::aircraftOnlineDotColor;
+  else
+    return mapcolors::aircraftAiDotColor;
+}
+
 MapPainterAircraft::MapPainterAircraft(MapWidget *mapWidget, MapScale *mapScale)
   : MapPainterVehicle(mapWidget, mapScale)
 {
@@ -63,14 +86,17 @@ void MapPainterAircraft::render(PaintContext *context)
   // Draw AI and online aircraft - not boats ====================================================================
   if(context->objectTypes & map::AIRCRAFT_AI)
   {
-    // Merge simulator aircraft and online aircraft
-    QVector<const atools::fs::sc::SimConnectAircraft *> allAircraft;
+    // Rectangle slightly larger than the view to avoid popping up icons at the border
+    atools::geo::Rect cullRect = cullingRect(context->viewportRect);
+
+    // Merge simulator aircraft and online aircraft and remove all outside of the view before projection
+    QVector<const SimConnectAircraft *> allAircraft;
     const QList<atools::fs::sc::SimConnectAircraft> *onlineAircraft = NavApp::getOnlinedataController()->getAircraft(
       context->viewport->viewLatLonAltBox(), context->mapLayer, context->lazyUpdate);
 
     for(const atools::fs::sc::SimConnectAircraft& ac : *onlineAircraft)
     {
-      if(ac.getCategory() != atools::fs::sc::BOAT)
+      if(aiAircraftVisible(context, cullRect, ac))
         allAircraft.append(&ac);
     }
 
@@ -78,44 +104,24 @@ void MapPainterAircraft::render(PaintContext *context)
     {
       for(const SimConnectAircraft& ac : mapWidget->getAiAircraft())
       {
-        if(ac.getCategory() != atools::fs::sc::BOAT)
+        if(aiAircraftVisible(context, cullRect, ac))
           allAircraft.append(&ac);
       }
     }
 
-    // Sort by distance to user aircraft
-    struct AiDistType
-    {
-      const SimConnectAircraft *aircraft;
-      float distanceLateralMeter, distanceVerticalFt;
-    };
-
-    QVector<AiDistType> aiSorted;
-
-    for(const SimConnectAircraft *ac : allAircraft)
-      aiSorted.append({ac,
-                       pos.distanceMeterTo(ac->getPosition()),
-                       std::abs(pos.getAltitude() - ac->getPosition().getAltitude())});
+    // Reduce level of detail if too many aircraft are visible to keep frame time constant
+    layer::AiAircraftDetail detail = context->mapLayer->getAiAircraftDetail();
+    if(detail == layer::AI_ICON && allAircraft.size() > MAX_AI_ICONS)
+      detail = layer::AI_DOT;
+    if(detail == layer::AI_DOT && allAircraft.size() > MAX_AI_DOTS)
+      detail = layer::AI_CLUSTER;
 
-    std::sort(aiSorted.begin(), aiSorted.end(), [](const AiDistType& ai1,
-                                                   const AiDistType& ai2) -> bool
-    {
-      // returns ​true if the first argument is less than (i.e. is ordered before) the second.
-      return ai1.distanceLateralMeter > ai2.distanceLateralMeter;
-    });
-
-    int num = aiSorted.size();
-    for(const AiDistType& adt : aiSorted)
-    {
-      const SimConnectAircraft& ac = *adt.aircraft;
-      if(mapfunc::aircraftVisible(ac, context->mapLayer))
-      {
-        paintAiVehicle(context, ac,
-                       --num < NUM_CLOSEST_AI_LABELS &&
-                       adt.distanceLateralMeter < DIST_METER_CLOSEST_AI_LABELS &&
-                       adt.distanceVerticalFt < DIST_FT_CLOSEST_AI_LABELS);
-      }
-    }
+    if(detail == layer::AI_CLUSTER)
+      paintAiClusters(context, allAircraft);
+    else if(detail == layer::AI_DOT)
+      paintAiDots(context, allAircraft);
+    else
+      paintAiIcons(context, allAircraft, pos);
   }
 
   // Draw user aircraft ====================================================================
@@ -136,3 +142,161 @@ void MapPainterAircraft::render(PaintContext *context)
     }
   }
 }
+
+bool MapPainterAircraft::aiAircraftVisible(const PaintContext *context, const atools::geo::Rect& cullRect,
+                                           const SimConnectAircraft& ac) const
+{
+  // Some simulators report the user aircraft in the AI list too. Skip it since it is drawn separately on top
+  // and would otherwise count for the level of detail and be hidden in a dot or cluster.
+  return ac.getCategory() != atools::fs::sc::BOAT && !ac.isUser() && ac.getPosition().isValid() &&
+         mapfunc::aircraftVisible(ac, context->mapLayer) &&
+         (!cullRect.isValid() || cullRect.contains(ac.getPosition()));
+}
+
+atools::geo::Rect MapPainterAircraft::cullingRect(const atools::geo::Rect& viewportRect) const
+{
+  if(!viewportRect.isValid() || viewportRect.getWest() > viewportRect.getEast())
+    // Do not cull - conversion to screen coordinates will do
+    return atools::geo::Rect();
+
+  float marginLon = viewportRect.getWidthDegree() * 0.05f, marginLat = viewportRect.getHeightDegree() * 0.05f;
+  float west = viewportRect.getWest() - marginLon, east = viewportRect.getEast() + marginLon;
+  float north = viewportRect.getNorth() + marginLat, south = viewportRect.getSouth() - marginLat;
+
+  if(west < -180.f || east > 180.f || north > 90.f || south < -90.f)
+    // Too close to the anti meridian or poles - do not cull
+    return atools::geo::Rect();
+
+  return atools::geo::Rect(west, north, east, south);
+}
+
+void MapPainterAircraft::paintAiIcons(const PaintContext *context, const QVector<const SimConnectAircraft *>& aircraft,
+                                      const atools::geo::Pos& userPos)
+{
+  // Sort by distance to user aircraft
+  struct AiDistType
+  {
+    const SimConnectAircraft *aircraft;
+    float distanceLateralMeter, distanceVerticalFt;
+  };
+
+  QVector<AiDistType> aiSorted;
+
+  for(const SimConnectAircraft *ac : aircraft)
+    aiSorted.append({ac,
+                     userPos.distanceMeterTo(ac->getPosition()),
+                     std::abs(userPos.getAltitude() - ac->getPosition().getAltitude())});
+
+  std::sort(aiSorted.begin(), aiSorted.end(), [](const AiDistType& ai1,
+                                                 const AiDistType& ai2) -> bool
+  {
+    // returns ​true if the first argument is less than (i.e. is ordered before) the second.
+    return ai1.distanceLateralMeter > ai2.distanceLateralMeter;
+  });
+
+  int num = aiSorted.size();
+  for(const AiDistType& adt : aiSorted)
+  {
+    paintAiVehicle(context, *adt.aircraft,
+                   --num < NUM_CLOSEST_AI_LABELS &&
+                   adt.distanceLateralMeter < DIST_METER_CLOSEST_AI_LABELS &&
+                   adt.distanceVerticalFt < DIST_FT_CLOSEST_AI_LABELS);
+  }
+}
+
+void MapPainterAircraft::paintAiDots(const PaintContext *context, const QVector<const SimConnectAircraft *>& aircraft)
+{
+  // Split by dot color and convert all positions of one color at once
+  QHash<QRgb, QVector<atools::geo::Pos> > positionsByColor;
+  for(const SimConnectAircraft *ac : aircraft)
+    positionsByColor[aiDotColor(*ac).rgba()].append(ac->getPosition());
+
+  QBitArray visible;
+  QVector<QPointF> points, visiblePoints;
+  float size = context->szF(context->symbolSizeAircraftAi, AI_DOT_SIZE);
+
+  for(auto it = positionsByColor.constBegin(); it != positionsByColor.constEnd(); ++it)
+  {
+    wToS(it.value(), points, &visible);
+
+    visiblePoints.clear();
+    for(int i = 0; i < points.size(); i++)
+    {
+      if(visible.testBit(i))
+        visiblePoints.append(points.at(i));
+    }
+
+    context->painter->setPen(QPen(QColor::fromRgba(it.key()), size, Qt::SolidLine, Qt::RoundCap));
+    context->painter->QPainter::drawPoints(visiblePoints.data(), visiblePoints.size());
+  }
+}
+
+void MapPainterAircraft::paintAiClusters(const PaintContext *context,
+                                         const QVector<const SimConnectAircraft *>& aircraft)
+{
+  QVector<atools::geo::Pos> positions;
+  positions.reserve(aircraft.size());
+  for(const SimConnectAircraft *ac : aircraft)
+    positions.append(ac->getPosition());
+
+  QBitArray visible;
+  QVector<QPointF> points;
+  wToS(positions, points, &visible);
+
+  // Aggregate aircraft into screen grid cells - sum up coordinates to get the center later
+  struct Cluster
+  {
+    double x = 0., y = 0.;
+    int count = 0;
+
+    /* Aircraft for single clusters to pick the color */
+    const SimConnectAircraft *first = nullptr;
+  };
+
+  QHash<quint32, Cluster> clusters;
+  for(int i = 0; i < points.size(); i++)
+  {
+    if(!visible.testBit(i))
+      continue;
+
+    const QPointF& pt = points.at(i);
+    quint32 cell = static_cast<quint32>(std::max(pt.x(), 0.) / AI_CLUSTER_CELL_SIZE) << 16 |
+                   static_cast<quint32>(std::max(pt.y(), 0.) / AI_CLUSTER_CELL_SIZE);
+    Cluster& cluster = clusters[cell];
+    if(cluster.first == nullptr)
+      cluster.first = aircraft.at(i);
+    cluster.x += pt.x();
+    cluster.y += pt.y();
+    cluster.count++;
+  }
+
+  if(clusters.isEmpty())
+    return;
+
+  Marble::GeoPainter *painter = context->painter;
+  context->szFont(context->textSizeAircraftAi);
+  QFontMetrics metrics = painter->fontMetrics();
+  painter->setBrush(mapcolors::aircraftClusterColor);
+
+  for(const Cluster& cluster : clusters)
+  {
+    QPointF center(cluster.x / cluster.count, cluster.y / cluster.count);
+
+    if(cluster.count == 1)
+    {
+      painter->setPen(QPen(aiDotColor(*cluster.first), context->szF(context->symbolSizeAircraftAi, AI_DOT_SIZE),
+                           Qt::SolidLine, Qt::RoundCap));
+      painter->QPainter::drawPoint(center);
+    }
+    else
+    {
+      // Circle with number of aircraft
+      QString text = QString::number(cluster.count);
+      float radius = std::max(metrics.width(text), metrics.height()) / 2.f + 3.f;
+      painter->setPen(QPen(mapcolors::aircraftClusterTextColor, 1.5));
+      painter->QPainter::drawEllipse(center, radius, radius);
+      painter->QPainter::drawText(QRectF(center.x() - radius, center.y() - radius, radius * 2.f, radius * 2.f),
+                                  Qt::AlignCenter, text);
+    }
+  }
+}
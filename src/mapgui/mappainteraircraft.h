@@ -20,6 +20,12 @@
 
 #include "mapgui/mappaintervehicle.h"
 
+namespace atools {
+namespace geo {
+class Rect;
+}
+}
+
 /*
  * Draws the simulator user aircraft and aircraft track
  */
@@ -32,6 +38,25 @@ public:
 
   virtual void render(PaintContext *context) override;
 
+private:
+  /* Full icons and labels for the closest aircraft */
+  void paintAiIcons(const PaintContext *context, const QVector<const atools::fs::sc::SimConnectAircraft *>& aircraft,
+                    const atools::geo::Pos& userPos);
+
+  /* Colored dots for each aircraft */
+  void paintAiDots(const PaintContext *context, const QVector<const atools::fs::sc::SimConnectAircraft *>& aircraft);
+
+  /* Markers showing the number of aircraft in each screen grid cell */
+  void paintAiClusters(const PaintContext *context,
+                       const QVector<const atools::fs::sc::SimConnectAircraft *>& aircraft);
+
+  /* true if aircraft is to be shown for the current layer and within the culling rectangle */
+  bool aiAircraftVisible(const PaintContext *context, const atools::geo::Rect& cullRect,
+                         const atools::fs::sc::SimConnectAircraft& ac) const;
+
+  /* Viewport rectangle with a margin or an invalid rectangle if culling is not possible */
+  atools::geo::Rect cullingRect(const atools::geo::Rect& viewportRect) const;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERMARKAIRCRAFT_H
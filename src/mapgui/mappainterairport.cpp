@@ -17,6 +17,7 @@
 
 #include "mapgui/mappainterairport.h"
 
+#include "navapp.h"
 #include "common/symbolpainter.h"
 #include "mapgui/mapscale.h"
 #include "mapgui/maplayer.h"
@@ -29,6 +30,7 @@
 #include "mapgui/mapwidget.h"
 #include "route/routecontroller.h"
 #include "util/paintercontextsaver.h"
+#include "weather/airportweatheroverlay.h"
 #include "atools.h"
 
 #include <QElapsedTimer>
@@ -199,6 +201,34 @@ void MapPainterAirport::render(PaintContext *context)
                                      context->mapLayer->getMaxTextLengthAirport());
     }
   }
+
+  if(context->objectTypes.testFlag(map::AIRPORT_WEATHER))
+    drawAirportWeather(context, visibleAirports);
+}
+
+/* Draw flight category and wind from the background calculated table on top of the airport symbols */
+void MapPainterAirport::drawAirportWeather(PaintContext *context,
+                                           const QList<std::pair<const map::MapAirport *, QPointF> >& airports)
+{
+  AirportWeatherOverlay *overlay = NavApp::getWeatherReporter()->getAirportWeatherOverlay();
+
+  // Start background update if the visible airports changed - the table of the last update is drawn meanwhile
+  QVector<const MapAirport *> airportPtrs;
+  airportPtrs.reserve(airports.size());
+  for(const std::pair<const MapAirport *, QPointF>& airport : airports)
+    airportPtrs.append(airport.first);
+  overlay->updateAirports(airportPtrs);
+
+  int size = context->sz(context->symbolSizeAirport, context->mapLayerEffective->getAirportSymbolSize());
+  for(const std::pair<const MapAirport *, QPointF>& airport : airports)
+  {
+    const AirportWeatherOverlay::AirportWeather *weather = overlay->getWeather(airport.first->id);
+    if(weather != nullptr)
+      symbolPainter->drawAirportWeather(context->painter, mapcolors::colorForFlightCategory(weather->category),
+                                        weather->windDirDeg, weather->windSpeedKts,
+                                        static_cast<float>(airport.second.x()),
+                                        static_cast<float>(airport.second.y()), size, context->drawFast);
+  }
 }
 
 /* Draws the full airport diagram including runway, taxiways, apron, parking and more */
@@ -276,9 +306,7 @@ void MapPainterAirport::drawFsApron(const PaintContext *context, const map::MapA
 /* Draw X-Plane aprons including bezier curves */
 QPainterPath MapPainterAirport::pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast)
 {
-  bool visible;
   QPainterPath apronPath;
-  atools::fs::common::Node lastNode;
 
   // Create a copy and close the geometry
   atools::fs::common::Boundary boundary = boundaryNodes;
@@ -286,59 +314,56 @@ QPainterPath MapPainterAirport::pathForBoundary(const atools::fs::common::Bounda
   if(!boundary.isEmpty())
     boundary.append(boundary.first());
 
-  int i = 0;
-  for(const atools::fs::common::Node& node : boundary)
+  // Convert all nodes and control points at once - control points follow the nodes
+  // Invalid control points result in null points
+  int num = boundary.size();
+  QVector<Pos> positions(num * 2);
+  for(int i = 0; i < num; i++)
   {
-    // QPen pen = painter->pen();
-    // painter->setPen(QPen(QColor(200, 200, 200), 1, Qt::SolidLine, Qt::FlatCap));
-    QPointF lastPt = wToSF(lastNode.node, DEFAULT_WTOS_SIZE, &visible);
-    QPointF pt = wToSF(node.node, DEFAULT_WTOS_SIZE, &visible);
-    // painter->drawEllipse(pt, 5, 5);
-    // painter->drawText(pt, QString("%1").arg(i));
-    // if(node.control.isValid())
-    // {
-    // QPointF ctlpt = wToSF(node.control, DEFAULT_WTOS_SIZE, &visible);
-    // painter->drawEllipse(ctlpt, 5, 2);
-    // painter->drawText(ctlpt + QPointF(0, 10), QString("C_%1").arg(i));
-    // painter->drawEllipse(pt + (pt - ctlpt), 2, 5);
-    // painter->drawText(pt + (pt - ctlpt) + QPointF(0, 10), QString("CX_%1").arg(i));
-    // painter->drawLine(ctlpt, pt + (pt - ctlpt));
-    // }
-    // painter->setPen(pen);
+    positions[i] = boundary.at(i).node;
+    positions[num + i] = boundary.at(i).control;
+  }
+
+  QVector<QPointF> points;
+  wToS(positions, points);
+
+  for(int i = 0; i < num; i++)
+  {
+    const QPointF& pt = points.at(i);
 
     if(i == 0)
       // Fist point
-      apronPath.moveTo(wToS(node.node, DEFAULT_WTOS_SIZE, &visible));
+      apronPath.moveTo(pt.toPoint());
     else if(fast)
       // Use lines only for fast drawing
       apronPath.lineTo(pt);
     else
     {
-      if(lastNode.control.isValid() && node.control.isValid())
+      const QPointF& lastPt = points.at(i - 1);
+      bool lastControlValid = boundary.at(i - 1).control.isValid(), controlValid = boundary.at(i).control.isValid();
+
+      if(lastControlValid && controlValid)
       {
         // Two successive control points - use cubic curve
-        QPointF ctlpt = wToSF(lastNode.control, DEFAULT_WTOS_SIZE, &visible);
-        QPointF ctlpt2 = wToSF(node.control, DEFAULT_WTOS_SIZE, &visible);
+        const QPointF& ctlpt = points.at(num + i - 1);
+        const QPointF& ctlpt2 = points.at(num + i);
         apronPath.cubicTo(ctlpt, pt + (pt - ctlpt2), pt);
       }
-      else if(lastNode.control.isValid())
+      else if(lastControlValid)
       {
         // One control point - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(wToSF(lastNode.control, DEFAULT_WTOS_SIZE, &visible), pt);
+          apronPath.quadTo(points.at(num + i - 1), pt);
       }
-      else if(node.control.isValid())
+      else if(controlValid)
       {
         // One control point - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(pt + (pt - wToSF(node.control, DEFAULT_WTOS_SIZE, &visible)), pt);
+          apronPath.quadTo(pt + (pt - points.at(num + i)), pt);
       }
       else
         apronPath.lineTo(pt);
     }
-
-    lastNode = node;
-    i++;
   }
   return apronPath;
 }
@@ -51,6 +51,8 @@ public:
 
 private:
   void drawAirportSymbol(PaintContext *context, const map::MapAirport& ap, float x, float y);
+  void drawAirportWeather(PaintContext *context,
+                          const QList<std::pair<const map::MapAirport *, QPointF> >& airports);
 
   // void drawWindPointer(const PaintContext *context, const maptypes::MapAirport& ap, int x, int y);
 
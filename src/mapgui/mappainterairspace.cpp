@@ -23,6 +23,7 @@
 #include "mapgui/maplayer.h"
 #include "query/mapquery.h"
 #include "query/airspacequery.h"
+#include "geo/calculations.h"
 
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
@@ -35,6 +36,82 @@ using namespace Marble;
 using namespace atools::geo;
 using namespace map;
 
+/* Polygons having only screen segments shorter than this are drawn directly without Marble tessellation */
+static const float MAX_UNTESSELLATED_LENGTH = 20.f;
+
+/* Polygons have to be closer than this to the view center on the globe to be drawn directly */
+static const float MAX_BATCH_CENTER_DISTANCE_NM = 80.f * 60.f;
+
+/* Decide without projecting if the polygon can be drawn directly from batch converted screen coordinates.
+ * Needs spherical or Mercator projection, the whole polygon on the visible side of the globe and all segments
+ * short enough to skip Marble tessellation. Mercator polygons must not cross the anti-meridian since the batch
+ * conversion does not unwrap longitudes. */
+static bool useBatchConversion(const ViewportParams *viewport, const Rect& bounding, const LineString& lines)
+{
+  if(lines.isEmpty() || !bounding.isValid())
+    return false;
+
+  // Screen pixels per radian on the sphere
+  double pixelPerRad;
+  if(viewport->projection() == Marble::Spherical)
+  {
+    // Check distance of the bounding rectangle from the view center - nothing hidden behind the globe
+    Pos center(static_cast<float>(viewport->centerLongitude() * 180. / M_PI),
+               static_cast<float>(viewport->centerLatitude() * 180. / M_PI));
+    for(const Pos& corner : {bounding.getTopLeft(), bounding.getTopRight(), bounding.getBottomLeft(),
+                             bounding.getBottomRight()})
+    {
+      if(center.distanceMeterTo(corner) > nmToMeter(MAX_BATCH_CENTER_DISTANCE_NM))
+        return false;
+    }
+    pixelPerRad = viewport->radius();
+  }
+  else if(viewport->projection() == Marble::Mercator)
+  {
+    // Vertices on both sides would be projected up to one world width apart
+    if(bounding.crossesAntiMeridian())
+      return false;
+
+    // Scale grows with latitude - use the one of the highest latitude
+    double maxLat = std::min(std::max(std::abs(bounding.getNorth()), std::abs(bounding.getSouth())), 85.f);
+    pixelPerRad = 2. * viewport->radius() / M_PI / std::cos(maxLat * M_PI / 180.);
+  }
+  else
+    return false;
+
+  // Longest allowed segment in degree
+  double maxSegmentDeg = MAX_UNTESSELLATED_LENGTH / pixelPerRad * 180. / M_PI;
+  double maxSegmentDegSq = maxSegmentDeg * maxSegmentDeg;
+
+  // Longitude is scaled by the widest latitude circle which overestimates the length
+  double minLat = bounding.getSouth() > 0.f ? bounding.getSouth() :
+                  (bounding.getNorth() < 0.f ? -bounding.getNorth() : 0.);
+  double lonScale = std::cos(minLat * M_PI / 180.);
+
+  // Approximate the segments of the closed polygon as straight lines in degrees - much cheaper than projecting
+  for(int i = 0; i < lines.size(); i++)
+  {
+    const Pos& pos1 = lines.at(i);
+    const Pos& pos2 = lines.at(i == lines.size() - 1 ? 0 : i + 1);
+
+    double lonDiff = std::abs(pos2.getLonX() - pos1.getLonX());
+    if(lonDiff > 180.)
+    {
+      // Crossing the anti-meridian - only the globe can draw this without Marble
+      if(viewport->projection() == Marble::Mercator)
+        return false;
+
+      lonDiff = 360. - lonDiff;
+    }
+    lonDiff *= lonScale;
+    double latDiff = pos2.getLatY() - pos1.getLatY();
+
+    if(lonDiff * lonDiff + latDiff * latDiff > maxSegmentDegSq)
+      return false;
+  }
+  return true;
+}
+
 MapPainterAirspace::MapPainterAirspace(MapWidget *mapWidget, MapScale *mapScale,
                                        const Route *routeParam)
   : MapPainter(mapWidget, mapScale), route(routeParam)
@@ -92,6 +169,7 @@ void MapPainterAirspace::render(PaintContext *context)
 
     painter->setBackgroundMode(Qt::TransparentMode);
 
+    QVector<QPointF> points;
     for(const MapAirspace *airspace : airspaces)
     {
       if(!(airspace->type & context->airspaceFilterByLayer.types))
@@ -104,9 +182,6 @@ void MapPainterAirspace::render(PaintContext *context)
 
         // qDebug() << airspace.getId() << airspace.name;
 
-        Marble::GeoDataLinearRing linearRing;
-        linearRing.setTessellate(true);
-
         painter->setPen(mapcolors::penForAirspace(*airspace));
 
         if(!context->drawFast)
@@ -115,10 +190,23 @@ void MapPainterAirspace::render(PaintContext *context)
         const LineString *lines =
           (airspace->online ? airspaceQueryOnline : airspaceQuery)->getAirspaceGeometry(airspace->id);
 
-        for(const Pos& pos : *lines)
-          linearRing.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0, DEG));
-
-        painter->drawPolygon(linearRing);
+        // Convert all points at once and draw directly if Marble would neither clip at the globe horizon
+        // nor tessellate - decided before converting to avoid projecting twice
+        if(useBatchConversion(context->viewport, airspace->bounding, *lines))
+        {
+          wToS(*lines, points);
+          painter->QPainter::drawPolygon(points.data(), points.size());
+        }
+        else
+        {
+          Marble::GeoDataLinearRing linearRing;
+          linearRing.setTessellate(true);
+
+          for(const Pos& pos : *lines)
+            linearRing.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0, DEG));
+
+          painter->drawPolygon(linearRing);
+        }
       }
     }
   }
@@ -30,6 +30,7 @@
 #include "common/vehicleicons.h"
 
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using namespace Marble;
 using namespace atools::geo;
@@ -128,63 +129,136 @@ void MapPainterVehicle::paintTrack(const PaintContext *context)
 
   if(!aircraftTrack.isEmpty())
   {
-    QPolygon polyline;
-
     GeoPainter *painter = context->painter;
+    const ViewportParams *viewport = context->viewport;
 
     float size = context->sz(context->thicknessTrail, 2);
     painter->setPen(mapcolors::aircraftTrailPen(size));
-    bool lastVisible = false;
-
-    int x1, y1;
-    int x2 = -1, y2 = -1;
     QRect vpRect(painter->viewport());
-    wToS(aircraftTrack.first().pos, x1, y1);
 
-    for(int i = 1; i < aircraftTrack.size(); i++)
+    // Use the simplified track where skipped positions are closer than the minimum line length on screen
+    float pixelPerKm = scale->getPixelForMeter(1000.f);
+    int level = pixelPerKm > 0.f ?
+                aircraftTrack.getSimplifiedLevel(1000.f / pixelPerKm * AIRCRAFT_TRACK_MIN_LINE_LENGTH) : -1;
+    const QList<at::TrackChunk>& chunks = aircraftTrack.getChunks();
+
+    // Start over if viewport, level or track changed - otherwise extend cached polylines
+    if(trackCache.level != level || trackCache.generation != aircraftTrack.getGeneration() ||
+       trackCache.centerLon != viewport->centerLongitude() || trackCache.centerLat != viewport->centerLatitude() ||
+       trackCache.radius != viewport->radius() || trackCache.projection != viewport->projection() ||
+       trackCache.rect != vpRect || trackCache.chunkIndex >= chunks.size())
     {
-      const at::AircraftTrackPos& trackPos = aircraftTrack.at(i);
-      wToS(trackPos.pos, x2, y2);
-
-      QRect rect(QPoint(x1, y1), QPoint(x2, y2));
-      rect = rect.normalized();
-      rect.adjust(-1, -1, 1, 1);
+      trackCache = TrackCache();
+      trackCache.level = level;
+      trackCache.generation = aircraftTrack.getGeneration();
+      trackCache.centerLon = viewport->centerLongitude();
+      trackCache.centerLat = viewport->centerLatitude();
+      trackCache.radius = viewport->radius();
+      trackCache.projection = viewport->projection();
+      trackCache.rect = vpRect;
+    }
 
-      // Current line is visible (most likely)
-      bool nowVisible = rect.intersects(vpRect);
+    // Convert only positions which were appended since the last call
+    for(; trackCache.chunkIndex < chunks.size(); trackCache.chunkIndex++)
+    {
+      const at::TrackChunk& chunk = chunks.at(trackCache.chunkIndex);
+      int numPositions = AircraftTrack::numChunkPositions(chunk, level);
+      bool lastChunk = trackCache.chunkIndex == chunks.size() - 1;
 
-      if(lastVisible || nowVisible)
+      if(!lastChunk && trackCache.numProcessed == 0 && numPositions > 0 &&
+         !chunk.bounding.overlaps(context->viewportRect))
       {
-        if(!polyline.isEmpty())
+        // Completed chunk is not visible - close polyline and continue with its last position
+        if(!trackCache.polyline.isEmpty())
         {
-          const QPoint& lastPt = polyline.last();
-          // Last line or this one are visible add coords
-          if(atools::geo::manhattanDistance(lastPt.x(), lastPt.y(), x2, y2) > AIRCRAFT_TRACK_MIN_LINE_LENGTH)
-            polyline.append(QPoint(x1, y1));
+          trackCache.polyline.append(QPoint(trackCache.x1, trackCache.y1));
+          trackCache.polylines.append(trackCache.polyline);
+          trackCache.polyline.clear();
         }
-        else
-          // Always add first visible point
-          polyline.append(QPoint(x1, y1));
-      }
 
-      if(lastVisible && !nowVisible)
+        bool visible;
+        QPoint pt = wToS(AircraftTrack::chunkPositions(chunk, level, numPositions - 1).first(),
+                         DEFAULT_WTOS_SIZE, &visible);
+        trackCache.x1 = pt.x();
+        trackCache.y1 = pt.y();
+        trackCache.hasFirst = true;
+        trackCache.lastVisible = false;
+      }
+      else if(trackCache.numProcessed < numPositions)
       {
-        // Not visible anymore draw previous line segment
-        painter->drawPolyline(polyline);
-        polyline.clear();
+        appendTrackPoints(AircraftTrack::chunkPositions(chunk, level, trackCache.numProcessed), vpRect);
+        trackCache.numProcessed = numPositions;
       }
 
-      lastVisible = nowVisible;
-      x1 = x2;
-      y1 = y2;
+      if(lastChunk)
+        // Keep position in the last chunk which can still grow
+        break;
+
+      trackCache.numProcessed = 0;
     }
 
-    // Draw rest
-    if(!polyline.isEmpty())
-    {
-      polyline.append(QPoint(x2, y2));
+    for(const QPolygon& polyline : trackCache.polylines)
       painter->drawPolyline(polyline);
+
+    // Draw rest up to the last track position which is not necessarily part of a simplified level
+    QPolygon polyline(trackCache.polyline);
+    polyline.append(QPoint(trackCache.x1, trackCache.y1));
+    bool visible;
+    polyline.append(wToS(aircraftTrack.last().pos, DEFAULT_WTOS_SIZE, &visible));
+    painter->drawPolyline(polyline);
+  }
+}
+
+void MapPainterVehicle::appendTrackPoints(const QVector<atools::geo::Pos>& positions, const QRect& vpRect)
+{
+  QVector<QPointF> points;
+  wToS(positions, points);
+
+  for(const QPointF& point : points)
+  {
+    int x2 = atools::roundToInt(point.x()), y2 = atools::roundToInt(point.y());
+
+    if(!trackCache.hasFirst)
+    {
+      // First point
+      trackCache.hasFirst = true;
+      trackCache.x1 = x2;
+      trackCache.y1 = y2;
+      continue;
     }
+
+    QRect rect(QPoint(trackCache.x1, trackCache.y1), QPoint(x2, y2));
+    rect = rect.normalized();
+    rect.adjust(-1, -1, 1, 1);
+
+    // Current line is visible (most likely)
+    bool nowVisible = rect.intersects(vpRect);
+
+    QPolygon& polyline = trackCache.polyline;
+    if(trackCache.lastVisible || nowVisible)
+    {
+      if(!polyline.isEmpty())
+      {
+        const QPoint& lastPt = polyline.last();
+        // Last line or this one are visible add coords
+        if(atools::geo::manhattanDistance(lastPt.x(), lastPt.y(), x2, y2) > AIRCRAFT_TRACK_MIN_LINE_LENGTH)
+          polyline.append(QPoint(trackCache.x1, trackCache.y1));
+      }
+      else
+        // Always add first visible point
+        polyline.append(QPoint(trackCache.x1, trackCache.y1));
+    }
+
+    if(trackCache.lastVisible && !nowVisible)
+    {
+      // Not visible anymore - keep previous line segment
+      trackCache.polylines.append(polyline);
+      polyline.clear();
+    }
+
+    trackCache.lastVisible = nowVisible;
+    trackCache.x1 = x2;
+    trackCache.y1 = y2;
   }
 }
 
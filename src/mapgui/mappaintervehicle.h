@@ -21,6 +21,7 @@
 #include "mapgui/mappainter.h"
 
 #include <QCache>
+#include <QPolygon>
 
 namespace Marble {
 class GeoDataLineString;
@@ -83,6 +84,35 @@ protected:
 
   static Q_DECL_CONSTEXPR int WIND_POINTER_SIZE = 40;
 
+private:
+  /* Screen coordinates of the aircraft track. Extended with newly appended track positions as long as
+   * viewport, simplification level and track generation do not change. */
+  struct TrackCache
+  {
+    /* Values the cache was built for. Level -1 is used for the full track. */
+    int level = -2, radius = 0, projection = -1;
+    quint32 generation = 0;
+    double centerLon = 0., centerLat = 0.;
+    QRect rect;
+
+    /* Chunk currently processed and number of its simplified positions already converted */
+    int chunkIndex = 0, numProcessed = 0;
+    bool hasFirst = false;
+
+    /* Last converted position and visibility of the segment to it */
+    int x1 = 0, y1 = 0;
+    bool lastVisible = false;
+
+    /* Finished polylines and the currently open one */
+    QVector<QPolygon> polylines;
+    QPolygon polyline;
+  };
+
+  /* Convert track positions to screen and add them to the cached polylines */
+  void appendTrackPoints(const QVector<atools::geo::Pos>& positions, const QRect& vpRect);
+
+  TrackCache trackCache;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERVECHICLE_H
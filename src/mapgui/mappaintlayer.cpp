@@ -287,7 +287,7 @@ void MapPaintLayer::initMapLayerSettings()
          approachTextAndDetail(false).
          aiAircraftGround(false).aiAircraftSmall(false).aiShipSmall(false).
          aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
+         onlineAircraftText(false).aiAircraftDetail(layer::AI_DOT).
          ndb(false).waypoint(false).marker(false).ils(false).
          airportRouteInfo(false).waypointRouteName(false).
          userpoint().userpointInfo(false).userpoinSymbolSize(16).
@@ -299,7 +299,7 @@ void MapPaintLayer::initMapLayerSettings()
          approachTextAndDetail(false).
          aiAircraftGround(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
          aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
+         onlineAircraftText(false).aiAircraftDetail(layer::AI_DOT).
          airspaceOther(false).airspaceRestricted(false).airspaceSpecial(false).
          vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
          airportRouteInfo(false).vorRouteInfo(false).ndbRouteInfo(false).waypointRouteName(false).
@@ -312,7 +312,7 @@ void MapPaintLayer::initMapLayerSettings()
          approachTextAndDetail(false).
          aiAircraftGround(false).aiAircraftLarge(false).aiAircraftSmall(false).aiShipLarge(false).aiShipSmall(false).
          aiAircraftGroundText(false).aiAircraftText(false).
-         onlineAircraftText(false).
+         onlineAircraftText(false).aiAircraftDetail(layer::AI_CLUSTER).
          airspaceFir(false).airspaceOther(false).airspaceRestricted(false).airspaceSpecial(false).
          airspaceIcao(false).
          vor(false).ndb(false).waypoint(false).marker(false).ils(false).airway(false).
@@ -355,6 +355,18 @@ void MapPaintLayer::initMapLayerSettings()
   qDebug() << *layers;
 }
 
+void MapPaintLayer::renderPainter(MapPainter *painter, MapPaintProfiler::PainterId id, PaintContext *context)
+{
+  if(profiler.isEnabled())
+  {
+    profiler.beginPainter(id, context->objectCount);
+    painter->render(context);
+    profiler.endPainter(id, context->objectCount);
+  }
+  else
+    painter->render(context);
+}
+
 /* Update the stored layer pointers after zoom distance has changed */
 void MapPaintLayer::updateLayers()
 {
@@ -381,6 +393,7 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport,
     // Check if no painting wanted during scroll
     if(!(mapScrollDetail == opts::NONE && mapWidget->viewContext() == Marble::Animation))
     {
+      profiler.beginFrame();
       updateLayers();
 
       PaintContext context;
@@ -445,53 +458,56 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport,
         painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
       }
 
-      mapPainterShip->render(&context);
+      renderPainter(mapPainterShip, MapPaintProfiler::SHIP, &context);
 
       if(mapWidget->distance() < layer::DISTANCE_CUT_OFF_LIMIT)
       {
         if(!context.isOverflow())
-          mapPainterAirspace->render(&context);
+          renderPainter(mapPainterAirspace, MapPaintProfiler::AIRSPACE, &context);
 
         if(context.mapLayerEffective->isAirportDiagram())
         {
           // Put ILS below and navaids on top of airport diagram
-          mapPainterIls->render(&context);
+          renderPainter(mapPainterIls, MapPaintProfiler::ILS, &context);
 
           if(!context.isOverflow())
-            mapPainterAirport->render(&context);
+            renderPainter(mapPainterAirport, MapPaintProfiler::AIRPORT, &context);
 
           if(!context.isOverflow())
-            mapPainterNav->render(&context);
+            renderPainter(mapPainterNav, MapPaintProfiler::NAV, &context);
         }
         else
         {
           // Airports on top of all
           if(!context.isOverflow())
-            mapPainterIls->render(&context);
+            renderPainter(mapPainterIls, MapPaintProfiler::ILS, &context);
 
           if(!context.isOverflow())
-            mapPainterNav->render(&context);
+            renderPainter(mapPainterNav, MapPaintProfiler::NAV, &context);
 
           if(!context.isOverflow())
-            mapPainterAirport->render(&context);
+            renderPainter(mapPainterAirport, MapPaintProfiler::AIRPORT, &context);
         }
       }
 
       if(!context.isOverflow())
-        mapPainterUser->render(&context);
+        renderPainter(mapPainterUser, MapPaintProfiler::USER, &context);
 
       // if(!context.isOverflow()) always paint route even if number of objets is too large
-      mapPainterRoute->render(&context);
+      renderPainter(mapPainterRoute, MapPaintProfiler::ROUTE, &context);
 
       // if(!context.isOverflow())
-      mapPainterMark->render(&context);
+      renderPainter(mapPainterMark, MapPaintProfiler::MARK, &context);
 
-      mapPainterAircraft->render(&context);
+      renderPainter(mapPainterAircraft, MapPaintProfiler::AIRCRAFT, &context);
 
       if(context.isOverflow())
         overflow = PaintContext::MAX_OBJECT_COUNT;
       else
         overflow = 0;
+
+      profiler.endFrame(context.objectCount);
+      profiler.paintOverlay(painter);
     }
 
     // Dim the map by drawing a semi-transparent black rectangle
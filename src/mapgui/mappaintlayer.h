@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_MAPPAINTLAYER_H
 
 #include "mapgui/mappainter.h"
+#include "mapgui/mappaintprofiler.h"
 
 #include <QPen>
 
@@ -104,10 +105,19 @@ public:
     return overflow;
   }
 
+  /* Collects painter statistics if enabled in the configuration file */
+  MapPaintProfiler *getProfiler()
+  {
+    return &profiler;
+  }
+
 private:
   void initMapLayerSettings();
   void updateLayers();
 
+  /* Call painter and collect statistics if profiling is enabled */
+  void renderPainter(MapPainter *painter, MapPaintProfiler::PainterId id, PaintContext *context);
+
   /* Implemented from LayerInterface: We  draw above all but below user tools */
   virtual QStringList renderPosition() const override
   {
@@ -147,6 +157,8 @@ private:
   const MapLayer *mapLayer = nullptr, *mapLayerEffective = nullptr;
   int overflow = 0;
 
+  MapPaintProfiler profiler;
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTLAYER_H
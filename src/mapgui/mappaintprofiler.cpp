@@ -0,0 +1,351 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mappaintprofiler.h"
+
+#include "navapp.h"
+#include "common/constants.h"
+#include "common/coordinateconverter.h"
+#include "query/mapquery.h"
+#include "query/airspacequery.h"
+#include "settings/settings.h"
+#include "util/paintercontextsaver.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QPainter>
+#include <QTextStream>
+
+MapPaintProfiler::MapPaintProfiler()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  setEnabled(settings.getAndStoreValue(lnm::OPTIONS_MAP_PROFILE_OVERLAY, false).toBool(),
+             settings.getAndStoreValue(lnm::OPTIONS_MAP_PROFILE_CSV, false).toBool());
+}
+
+MapPaintProfiler::~MapPaintProfiler()
+{
+  closeCsv();
+}
+
+void MapPaintProfiler::setEnabled(bool overlay, bool csv)
+{
+  showOverlay = overlay;
+
+  if(csv != writeCsv)
+  {
+    writeCsv = csv;
+    if(writeCsv)
+      openCsv();
+    else
+      closeCsv();
+  }
+
+  rollingFrames.clear();
+  rollingIndex = 0;
+}
+
+void MapPaintProfiler::setCollect(bool value)
+{
+  collect = value;
+
+  if(!collect && csvStream != nullptr)
+    csvStream->flush();
+}
+
+QString MapPaintProfiler::painterName(PainterId id)
+{
+  switch(id)
+  {
+    case MapPaintProfiler::SHIP:
+      return "Ship";
+
+    case MapPaintProfiler::AIRSPACE:
+      return "Airspace";
+
+    case MapPaintProfiler::ILS:
+      return "ILS";
+
+    case MapPaintProfiler::AIRPORT:
+      return "Airport";
+
+    case MapPaintProfiler::NAV:
+      return "Nav";
+
+    case MapPaintProfiler::USER:
+      return "Userpoint";
+
+    case MapPaintProfiler::ROUTE:
+      return "Route";
+
+    case MapPaintProfiler::MARK:
+      return "Mark";
+
+    case MapPaintProfiler::AIRCRAFT:
+      return "Aircraft";
+
+    case MapPaintProfiler::NUM_PAINTERS:
+      break;
+  }
+  return QString();
+}
+
+void MapPaintProfiler::cacheStatistics(quint64& hits, quint64& misses) const
+{
+  hits = misses = 0L;
+  quint64 h, m;
+
+  if(NavApp::getMapQuery() != nullptr)
+  {
+    NavApp::getMapQuery()->getCacheStatistics(h, m);
+    hits += h;
+    misses += m;
+  }
+
+  if(NavApp::getAirspaceQuery() != nullptr)
+  {
+    NavApp::getAirspaceQuery()->getCacheStatistics(h, m);
+    hits += h;
+    misses += m;
+  }
+
+  if(NavApp::getAirspaceQueryOnline() != nullptr)
+  {
+    NavApp::getAirspaceQueryOnline()->getCacheStatistics(h, m);
+    hits += h;
+    misses += m;
+  }
+}
+
+void MapPaintProfiler::beginFrame()
+{
+  if(!isEnabled())
+    return;
+
+  currentFrame = FrameStats();
+  frameWToS = CoordinateConverter::getWToSCallCount();
+  cacheStatistics(frameCacheHits, frameCacheMisses);
+  frameTimer.start();
+}
+
+void MapPaintProfiler::endFrame(int objectCount)
+{
+  if(!isEnabled())
+    return;
+
+  currentFrame.nsecs = frameTimer.nsecsElapsed();
+  currentFrame.objects = objectCount;
+  currentFrame.wToS = CoordinateConverter::getWToSCallCount() - frameWToS;
+
+  quint64 hits, misses;
+  cacheStatistics(hits, misses);
+  currentFrame.cacheHits = hits - frameCacheHits;
+  currentFrame.cacheMisses = misses - frameCacheMisses;
+
+  lastFrame = currentFrame;
+  frameNumber++;
+
+  // Fill ring buffer for overlay averages
+  if(rollingFrames.size() < ROLLING_FRAMES)
+    rollingFrames.append(currentFrame);
+  else
+    rollingFrames[rollingIndex] = currentFrame;
+  rollingIndex = (rollingIndex + 1) % ROLLING_FRAMES;
+
+  if(writeCsv)
+    writeCsvRow(currentFrame);
+}
+
+void MapPaintProfiler::beginPainter(PainterId id, int objectCount)
+{
+  Q_UNUSED(id);
+
+  if(!isEnabled())
+    return;
+
+  painterObjects = objectCount;
+  painterWToS = CoordinateConverter::getWToSCallCount();
+  cacheStatistics(painterCacheHits, painterCacheMisses);
+  painterTimer.start();
+}
+
+void MapPaintProfiler::endPainter(PainterId id, int objectCount)
+{
+  if(!isEnabled())
+    return;
+
+  PainterStats& stats = currentFrame.painters[id];
+  stats.nsecs += painterTimer.nsecsElapsed();
+  stats.objects += objectCount - painterObjects;
+  stats.wToS += CoordinateConverter::getWToSCallCount() - painterWToS;
+
+  quint64 hits, misses;
+  cacheStatistics(hits, misses);
+  stats.cacheHits += hits - painterCacheHits;
+  stats.cacheMisses += misses - painterCacheMisses;
+}
+
+void MapPaintProfiler::paintOverlay(QPainter *painter)
+{
+  if(!showOverlay || rollingFrames.isEmpty())
+    return;
+
+  atools::util::PainterContextSaver saver(painter);
+  Q_UNUSED(saver);
+
+  // Calculate averages over the last frames
+  double frameMs = 0., objects = 0., wToS = 0., hits = 0., misses = 0.;
+  double painterMs[NUM_PAINTERS] = {}, painterObjects[NUM_PAINTERS] = {}, painterWToS[NUM_PAINTERS] = {};
+  double painterHits[NUM_PAINTERS] = {}, painterMisses[NUM_PAINTERS] = {};
+
+  for(const FrameStats& frame : rollingFrames)
+  {
+    frameMs += frame.nsecs / 1000000.;
+    objects += frame.objects;
+    wToS += frame.wToS;
+    hits += frame.cacheHits;
+    misses += frame.cacheMisses;
+
+    for(int i = 0; i < NUM_PAINTERS; i++)
+    {
+      painterMs[i] += frame.painters[i].nsecs / 1000000.;
+      painterObjects[i] += frame.painters[i].objects;
+      painterWToS[i] += frame.painters[i].wToS;
+      painterHits[i] += frame.painters[i].cacheHits;
+      painterMisses[i] += frame.painters[i].cacheMisses;
+    }
+  }
+
+  double num = rollingFrames.size();
+  QStringList texts;
+  texts.append(tr("Frames %1, average of last %2").arg(frameNumber).arg(rollingFrames.size()));
+  texts.append(tr("Total %1 ms, objects %2, wToS %3, cache %4/%5").
+               arg(frameMs / num, 0, 'f', 1).arg(objects / num, 0, 'f', 0).arg(wToS / num, 0, 'f', 0).
+               arg(hits / num, 0, 'f', 1).arg(misses / num, 0, 'f', 1));
+
+  for(int i = 0; i < NUM_PAINTERS; i++)
+  {
+    texts.append(tr("%1: %2 ms, objects %3, wToS %4, cache %5/%6").
+                 arg(painterName(static_cast<PainterId>(i))).
+                 arg(painterMs[i] / num, 0, 'f', 2).arg(painterObjects[i] / num, 0, 'f', 0).
+                 arg(painterWToS[i] / num, 0, 'f', 0).
+                 arg(painterHits[i] / num, 0, 'f', 1).arg(painterMisses[i] / num, 0, 'f', 1));
+  }
+
+  // Draw semi transparent box with a line for each painter
+  QFont font = painter->font();
+  font.setBold(false);
+  painter->setFont(font);
+  QFontMetrics metrics = painter->fontMetrics();
+
+  int width = 0;
+  for(const QString& text : texts)
+    width = std::max(width, metrics.width(text));
+
+  QRect box(5, 5, width + 10, metrics.height() * texts.size() + 10);
+  painter->setPen(QPen(Qt::black, 1.));
+  painter->setBrush(QColor(255, 255, 255, 200));
+  painter->drawRect(box);
+
+  int y = box.top() + 5 + metrics.ascent();
+  for(const QString& text : texts)
+  {
+    painter->drawText(box.left() + 5, y, text);
+    y += metrics.height();
+  }
+}
+
+void MapPaintProfiler::openCsv()
+{
+  closeCsv();
+
+  QString filename = atools::settings::Settings::getConfigFilename("_paint_profile.csv");
+
+  // Rotate file if too large
+  if(QFile::exists(filename) && QFile(filename).size() > MAX_CSV_FILE_SIZE)
+  {
+    QFile::remove(filename + ".1");
+    QFile::rename(filename, filename + ".1");
+  }
+
+  csvFile = new QFile(filename);
+  if(csvFile->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+  {
+    qInfo() << Q_FUNC_INFO << "Writing map paint profile to" << filename;
+
+    csvStream = new QTextStream(csvFile);
+    if(csvFile->size() == 0)
+      writeCsvHeader();
+  }
+  else
+  {
+    qWarning() << "Cannot open map paint profile" << filename << ":" << csvFile->errorString();
+    delete csvFile;
+    csvFile = nullptr;
+  }
+}
+
+void MapPaintProfiler::closeCsv()
+{
+  if(csvStream != nullptr)
+    csvStream->flush();
+  delete csvStream;
+  csvStream = nullptr;
+
+  if(csvFile != nullptr)
+    csvFile->close();
+  delete csvFile;
+  csvFile = nullptr;
+}
+
+void MapPaintProfiler::writeCsvHeader()
+{
+  QStringList header({"timestamp", "frame", "total_ms", "total_objects", "total_wtos",
+                      "total_cache_hits", "total_cache_misses"});
+
+  for(int i = 0; i < NUM_PAINTERS; i++)
+  {
+    QString name = painterName(static_cast<PainterId>(i)).toLower();
+    header << name + "_ms" << name + "_objects" << name + "_wtos" << name + "_cache_hits" << name + "_cache_misses";
+  }
+  (*csvStream) << header.join(';') << '\n';
+}
+
+void MapPaintProfiler::writeCsvRow(const FrameStats& frame)
+{
+  if(csvStream == nullptr)
+    return;
+
+  QStringList row;
+  row << QDateTime::currentDateTime().toString(Qt::ISODateWithMs) << QString::number(frameNumber)
+      << QString::number(frame.nsecs / 1000000., 'f', 3) << QString::number(frame.objects)
+      << QString::number(frame.wToS) << QString::number(frame.cacheHits) << QString::number(frame.cacheMisses);
+
+  for(int i = 0; i < NUM_PAINTERS; i++)
+  {
+    const PainterStats& stats = frame.painters[i];
+    row << QString::number(stats.nsecs / 1000000., 'f', 3) << QString::number(stats.objects)
+        << QString::number(stats.wToS) << QString::number(stats.cacheHits) << QString::number(stats.cacheMisses);
+  }
+  // No endl to avoid flushing on each frame - stream is flushed when collection ends or file is closed
+  (*csvStream) << row.join(';') << '\n';
+
+  // Rotate file if size is exceeded - ignores the small amount of buffered text
+  if(csvFile->size() > MAX_CSV_FILE_SIZE)
+    openCsv();
+}
@@ -0,0 +1,141 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_MAPPAINTPROFILER_H
+#define LITTLENAVMAP_MAPPAINTPROFILER_H
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QVector>
+
+class QPainter;
+class QFile;
+class QTextStream;
+
+/*
+ * Collects per frame and per painter statistics for the map painters: wall time, number of drawn objects,
+ * number of world to screen conversions and cache hits/misses in the map and airspace queries.
+ *
+ * Statistics can be shown as an overlay in the upper left corner of the map and/or can be written
+ * into a CSV file having one row per frame. Both are only available through the configuration file options
+ * "Options/MapProfileOverlay" and "Options/MapProfileCsv".
+ */
+class MapPaintProfiler
+{
+  Q_DECLARE_TR_FUNCTIONS(MapPaintProfiler)
+
+public:
+  /* Painters in order of calls in MapPaintLayer::render */
+  enum PainterId
+  {
+    SHIP,
+    AIRSPACE,
+    ILS,
+    AIRPORT,
+    NAV,
+    USER,
+    ROUTE,
+    MARK,
+    AIRCRAFT,
+    NUM_PAINTERS
+  };
+
+  /* Values collected for one painter */
+  struct PainterStats
+  {
+    qint64 nsecs = 0L;
+    int objects = 0;
+    quint64 wToS = 0L, cacheHits = 0L, cacheMisses = 0L;
+  };
+
+  /* Values collected for one map frame. Frame includes setup and all painters. */
+  struct FrameStats
+  {
+    qint64 nsecs = 0L;
+    int objects = 0;
+    quint64 wToS = 0L, cacheHits = 0L, cacheMisses = 0L;
+    PainterStats painters[NUM_PAINTERS];
+  };
+
+  MapPaintProfiler();
+  ~MapPaintProfiler();
+
+  /* Enable or disable collection for overlay and CSV file. Overrides configuration file values. */
+  void setEnabled(bool overlay, bool csv);
+
+  /* true if any statistics are collected */
+  bool isEnabled() const
+  {
+    return showOverlay || writeCsv || collect;
+  }
+
+  /* Collect statistics without showing them. Used for benchmarks. Flushes the CSV file at the end of a run. */
+  void setCollect(bool value);
+
+  /* Call at the start and end of each map frame */
+  void beginFrame();
+  void endFrame(int objectCount);
+
+  /* Call around each painter. objectCount is the current count of the paint context. */
+  void beginPainter(PainterId id, int objectCount);
+  void endPainter(PainterId id, int objectCount);
+
+  /* Draw average values of the last frames into the upper left corner of the map if overlay is enabled */
+  void paintOverlay(QPainter *painter);
+
+  /* Statistics of the last finished frame */
+  const FrameStats& getLastFrame() const
+  {
+    return lastFrame;
+  }
+
+  /* Untranslated painter name for CSV and log output */
+  static QString painterName(PainterId id);
+
+private:
+  void cacheStatistics(quint64& hits, quint64& misses) const;
+  void openCsv();
+  void closeCsv();
+  void writeCsvHeader();
+  void writeCsvRow(const FrameStats& frame);
+
+  /* Number of frames used to calculate average values for the overlay */
+  static Q_DECL_CONSTEXPR int ROLLING_FRAMES = 50;
+
+  /* Rotate CSV file once it exceeds this size */
+  static Q_DECL_CONSTEXPR qint64 MAX_CSV_FILE_SIZE = 20 * 1024 * 1024;
+
+  bool showOverlay = false, writeCsv = false, collect = false;
+
+  QElapsedTimer frameTimer, painterTimer;
+  FrameStats currentFrame, lastFrame;
+
+  /* Start values for frame and current painter */
+  quint64 frameWToS = 0L, frameCacheHits = 0L, frameCacheMisses = 0L;
+  quint64 painterWToS = 0L, painterCacheHits = 0L, painterCacheMisses = 0L;
+  int painterObjects = 0;
+
+  /* Ring buffer of last frames used for the overlay */
+  QVector<FrameStats> rollingFrames;
+  int rollingIndex = 0;
+  qint64 frameNumber = 0L;
+
+  QFile *csvFile = nullptr;
+  QTextStream *csvStream = nullptr;
+};
+
+#endif // LITTLENAVMAP_MAPPAINTPROFILER_H
@@ -29,6 +29,7 @@
 #include "common/maptools.h"
 #include "common/mapcolors.h"
 #include "connect/connectclient.h"
+#include "connect/simdatadispatcher.h"
 #include "fs/sc/simconnectuseraircraft.h"
 #include "route/route.h"
 #include "userdata/userdataicons.h"
@@ -66,8 +67,8 @@ const int DEFAULT_MAP_DISTANCE = 7000;
 // Get elevation when mouse is still
 const int ALTITUDE_UPDATE_TIMEOUT = 200;
 
-// Delay recognition to avoid detection of bumps
-const int TAKEOFF_LANDING_TIMEOUT = 5000;
+// Append new aircraft track positions to the file
+const int TRACK_JOURNAL_FLUSH_MS = 30000;
 
 /* If width and height of a bounding rect are smaller than this use show point */
 const float POS_IS_POINT_EPSILON = 0.0001f;
@@ -155,8 +156,12 @@ MapWidget::MapWidget(MainWindow *parent)
   jumpBackToAircraftTimer.setSingleShot(true);
   connect(&jumpBackToAircraftTimer, &QTimer::timeout, this, &MapWidget::jumpBackToAircraftTimeout);
 
-  takeoffLandingTimer.setSingleShot(true);
-  connect(&takeoffLandingTimer, &QTimer::timeout, this, &MapWidget::takeoffLandingTimeout);
+  trackJournalTimer.setInterval(TRACK_JOURNAL_FLUSH_MS);
+  connect(&trackJournalTimer, &QTimer::timeout, this, [this]
+  {
+    aircraftTrack.flushJournal();
+  });
+  trackJournalTimer.start();
 
   mapVisible = new MapVisible(paintLayer);
 }
@@ -165,7 +170,7 @@ MapWidget::~MapWidget()
 {
   elevationDisplayTimer.stop();
   jumpBackToAircraftTimer.stop();
-  takeoffLandingTimer.stop();
+  trackJournalTimer.stop();
 
   qDebug() << Q_FUNC_INFO << "removeEventFilter";
   removeEventFilter(this);
@@ -334,6 +339,7 @@ void MapWidget::updateMapObjectsShown()
   setShowMapFeatures(map::NDB, ui->actionMapShowNdb->isChecked());
   setShowMapFeatures(map::ILS, ui->actionMapShowIls->isChecked());
   setShowMapFeatures(map::WAYPOINT, ui->actionMapShowWp->isChecked());
+  setShowMapFeatures(map::AIRPORT_WEATHER, ui->actionMapShowAirportWeather->isChecked());
 
   mapVisible->updateVisibleObjectsStatusBar();
 
@@ -512,6 +518,9 @@ void MapWidget::resetSettingActionsToDefault()
   ui->actionMapShowAddonAirports->blockSignals(true);
   ui->actionMapShowAddonAirports->setChecked(true);
   ui->actionMapShowAddonAirports->blockSignals(false);
+  ui->actionMapShowAirportWeather->blockSignals(true);
+  ui->actionMapShowAirportWeather->setChecked(false);
+  ui->actionMapShowAirportWeather->blockSignals(false);
   ui->actionMapShowVor->blockSignals(true);
   ui->actionMapShowVor->setChecked(true);
   ui->actionMapShowVor->blockSignals(false);
@@ -606,6 +615,8 @@ void MapWidget::restoreState()
   if(OptionData::instance().getFlags() & opts::STARTUP_LOAD_TRAIL)
     aircraftTrack.restoreState();
   aircraftTrack.setMaxTrackEntries(OptionData::instance().getAircraftTrackMaxPoints());
+  aircraftTrack.setTolerance(s.getAndStoreValue(lnm::OPTIONS_TRACK_TOLERANCE_METER, 50.f).toFloat(),
+                             s.getAndStoreValue(lnm::OPTIONS_TRACK_TOLERANCE_ALT_FT, 100.f).toFloat());
 
   atools::gui::WidgetState state(lnm::MAP_OVERLAY_VISIBLE, false /*save visibility*/, true /*block signals*/);
   for(QAction *action : mapOverlays.values())
@@ -983,52 +994,7 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   screenIndex->updateSimData(simulatorData);
   const atools::fs::sc::SimConnectUserAircraft& last = screenIndex->getLastUserAircraft();
 
-  // Calculate travel distance since last takeoff event ===================================
-  if(!takeoffLandingLastAircraft.isValid())
-    // Set for the first time
-    takeoffLandingLastAircraft = aircraft;
-  else if(aircraft.isValid() && !aircraft.isSimReplay() && !takeoffLandingLastAircraft.isSimReplay())
-  {
-    // Use less accuracy for longer routes
-    float epsilon = takeoffLandingDistanceNm > 20. ? Pos::POS_EPSILON_500M : Pos::POS_EPSILON_10M;
-
-    // Check manhattan distance in degree to minimize samples
-    if(takeoffLandingLastAircraft.getPosition().distanceSimpleTo(aircraft.getPosition()) > epsilon)
-    {
-      if(takeoffTimeMs > 0)
-      {
-        // Calculate averaget TAS
-        qint64 currentSampleTime = aircraft.getZuluTime().toMSecsSinceEpoch();
-
-        // Only every ten seconds since the simulator timestamps are not precise enough
-        if(currentSampleTime > takeoffLastSampleTimeMs + 10000)
-        {
-          qint64 lastPeriod = currentSampleTime - takeoffLastSampleTimeMs;
-          qint64 flightimeToCurrentPeriod = currentSampleTime - takeoffTimeMs;
-
-          if(flightimeToCurrentPeriod > 0)
-            takeoffLandingAverageTasKts = ((takeoffLandingAverageTasKts * (takeoffLastSampleTimeMs - takeoffTimeMs)) +
-                                           (aircraft.getTrueAirspeedKts() * lastPeriod)) / flightimeToCurrentPeriod;
-          takeoffLastSampleTimeMs = currentSampleTime;
-        }
-      }
-
-      takeoffLandingDistanceNm +=
-        atools::geo::meterToNm(takeoffLandingLastAircraft.getPosition().distanceMeterTo(aircraft.getPosition()));
-
-      takeoffLandingLastAircraft = aircraft;
-    }
-  }
-
-  // Check for takeoff or landing events ===================================
-  if(last.isValid() && aircraft.isValid() &&
-     !aircraft.isSimPaused() && !aircraft.isSimReplay() &&
-     !last.isSimPaused() && !last.isSimReplay())
-  {
-    // start timer to emit takeoff/landing signal
-    if(last.isFlying() != aircraft.isFlying())
-      takeoffLandingTimer.start(TAKEOFF_LANDING_TIMEOUT);
-  }
+  // Takeoff and landing detection is done in the SimDataProcessor thread
 
   // Create screen coordinates =============================
   CoordinateConverter conv(viewport());
@@ -2606,7 +2572,7 @@ void MapWidget::debugMovingPlane(QMouseEvent *event)
       atools::fs::sc::SimConnectData data = atools::fs::sc::SimConnectData::buildDebugForPosition(pos, lastPos);
       data.setPacketId(packetId++);
 
-      emit NavApp::getConnectClient()->dataPacketReceived(data);
+      NavApp::getConnectClient()->getSimDataDispatcher()->dispatch(data);
       lastPos = pos;
       lastPoint = event->pos();
     }
@@ -3003,6 +2969,12 @@ void MapWidget::updateTooltip()
   showTooltip(true);
 }
 
+void MapWidget::airportWeatherUpdated()
+{
+  if(paintLayer->getShownMapObjects() & map::AIRPORT_WEATHER)
+    update();
+}
+
 void MapWidget::showTooltip(bool update)
 {
   // qDebug() << Q_FUNC_INFO << "update" << update << "QToolTip::isVisible()" << QToolTip::isVisible();
@@ -3244,6 +3216,12 @@ void MapWidget::onlineClientAndAtcUpdated()
   update();
 }
 
+void MapWidget::onlineClientPositionsUpdated()
+{
+  if(getShownMapFeatures() & map::AIRCRAFT_ONLINE)
+    update();
+}
+
 void MapWidget::onlineNetworkChanged()
 {
   screenIndex->resetAirspaceOnlineScreenGeometry();
@@ -3251,31 +3229,6 @@ void MapWidget::onlineNetworkChanged()
   update();
 }
 
-void MapWidget::takeoffLandingTimeout()
-{
-  const atools::fs::sc::SimConnectUserAircraft aircraft = screenIndex->getLastUserAircraft();
-
-  if(aircraft.isFlying())
-  {
-    // In air after  status has changed
-    qDebug() << Q_FUNC_INFO << "Takeoff detected" << aircraft.getZuluTime();
-
-    takeoffLandingDistanceNm = 0.;
-    takeoffLandingAverageTasKts = aircraft.getTrueAirspeedKts();
-    takeoffLastSampleTimeMs = takeoffTimeMs = aircraft.getZuluTime().toMSecsSinceEpoch();
-
-    emit aircraftTakeoff(aircraft);
-  }
-  else
-  {
-    // On ground after status has changed
-    qDebug() << Q_FUNC_INFO << "Landing detected takeoffLandingDistanceNm" << takeoffLandingDistanceNm;
-    emit aircraftLanding(aircraft,
-                         static_cast<float>(takeoffLandingDistanceNm),
-                         static_cast<float>(takeoffLandingAverageTasKts));
-  }
-}
-
 void MapWidget::jumpBackToAircraftTimeout()
 {
   if(mouseState != mw::NONE || viewContext() == Marble::Animation || contextMenuActive)
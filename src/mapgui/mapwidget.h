@@ -178,6 +178,12 @@ public:
     return aircraftTrack;
   }
 
+  /* Paint layer containing all painters and the paint profiler */
+  MapPaintLayer *getMapPaintLayer() const
+  {
+    return paintLayer;
+  }
+
   /* If currently dragging flight plan: start, mouse and end position of the moving line. Start of end might be omitted
    * if dragging departure or destination */
   void getRouteDragPoints(atools::geo::Pos& from, atools::geo::Pos& to, QPoint& cur);
@@ -251,6 +257,9 @@ public:
   void showTooltip(bool update);
   void updateTooltip();
 
+  /* Redraw if airport weather is shown and the overlay has new data */
+  void airportWeatherUpdated();
+
   const atools::fs::sc::SimConnectUserAircraft& getUserAircraft() const;
 
   const QVector<atools::fs::sc::SimConnectAircraft>& getAiAircraft() const;
@@ -312,6 +321,9 @@ public:
   void onlineClientAndAtcUpdated();
   void onlineNetworkChanged();
 
+  /* Repaint if online aircraft are shown since their positions are extrapolated */
+  void onlineClientPositionsUpdated();
+
 signals:
   /* Emitted whenever the result exceeds the limit clause in the queries */
   void resultTruncated(int truncatedTo);
@@ -358,11 +370,6 @@ signals:
 
   void shownMapFeaturesChanged(map::MapObjectTypes types);
 
-  /* State isFlying  between last and current aircraft has changed */
-  void aircraftTakeoff(const atools::fs::sc::SimConnectUserAircraft& aircraft);
-  void aircraftLanding(const atools::fs::sc::SimConnectUserAircraft& aircraft, float flownDistanceNm,
-                       float averageTasKts);
-
 private:
   bool eventFilter(QObject *obj, QEvent *e) override;
   void setDetailLevel(int factor);
@@ -401,9 +408,6 @@ private:
   void jumpBackToAircraftStart();
   bool isCenterLegAndAircraftActive();
 
-  /* Timer for takeoff and landing recognition fired */
-  void takeoffLandingTimeout();
-
   /* Defines amount of objects and other attributes on the map. min 5, max 15, default 10. */
   int mapDetailLevel;
 
@@ -479,23 +483,8 @@ private:
   /* Delay display of elevation display to avoid lagging mouse movements */
   QTimer elevationDisplayTimer;
 
-  /* Delay takeoff and landing messages to avoid false recognition of bumpy landings */
-  QTimer takeoffLandingTimer;
-
-  /* Simulator zulu time timestamp of takeoff event */
-  qint64 takeoffTimeMs = 0L;
-
-  /* Flown distance from takeoff event */
-  double takeoffLandingDistanceNm = 0.;
-
-  /* Average true airspeed from takeoff event */
-  double takeoffLandingAverageTasKts = 0.;
-
-  /* Last sample from average value calculation */
-  qint64 takeoffLastSampleTimeMs = 0L;
-
-  /* Used for distance calculation */
-  atools::fs::sc::SimConnectUserAircraft takeoffLandingLastAircraft;
+  /* Writes new track positions periodically to avoid losing the track on crash */
+  QTimer trackJournalTimer;
 
   QTimer jumpBackToAircraftTimer;
   double jumpBackToAircraftDistance = 0.;
@@ -18,27 +18,25 @@
 #include "online/onlinedatacontroller.h"
 
 #include "fs/online/onlinedatamanager.h"
-#include "util/httpdownloader.h"
+#include "online/onlinedownloader.h"
 #include "gui/mainwindow.h"
 #include "common/constants.h"
 #include "settings/settings.h"
 #include "options/optiondata.h"
-#include "zip/gzip.h"
 #include "sql/sqlquery.h"
 #include "mapgui/maplayer.h"
 #include "fs/sc/simconnectaircraft.h"
+#include "geo/calculations.h"
 
 #include <QDebug>
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QApplication>
-
-// #define DEBUG_ONLINE_DOWNLOAD 1
+#include <QtConcurrent/QtConcurrentRun>
 
 static const int MIN_SERVER_DOWNLOAD_INTERVAL_MIN = 15;
 
 using atools::fs::online::OnlinedataManager;
-using atools::util::HttpDownloader;
 
 atools::fs::online::Format convertFormat(opts::OnlineFormat format)
 {
@@ -61,21 +59,29 @@ OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager
   if(codec == nullptr)
     codec = QTextCodec::codecForLocale();
 
-  downloader = new atools::util::HttpDownloader(mainWindow, false /* verbose */);
+  downloader = new OnlineDownloader(mainWindow);
 
-  connect(downloader, &HttpDownloader::downloadFinished, this, &OnlinedataController::downloadFinished);
-  connect(downloader, &HttpDownloader::downloadFailed, this, &OnlinedataController::downloadFailed);
+  connect(downloader, &OnlineDownloader::downloadFinished, this, &OnlinedataController::downloadFinished);
+  connect(downloader, &OnlineDownloader::downloadNotModified, this, &OnlinedataController::downloadNotModified);
+  connect(downloader, &OnlineDownloader::downloadFailed, this, &OnlinedataController::downloadFailed);
 
   // Recurring downloads
   connect(&downloadTimer, &QTimer::timeout, this, &OnlinedataController::startDownloadInternal);
 
-#ifdef DEBUG_ONLINE_DOWNLOAD
-  downloader->enableCache(60);
-#endif
+  // Map updates for extrapolated aircraft positions - disabled if interval is 0
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  extrapolateTimer.setInterval(settings.getAndStoreValue(lnm::OPTIONS_ONLINE_EXTRAPOLATE_MS, 2000).toInt());
+  maxExtrapolateSeconds = settings.getAndStoreValue(lnm::OPTIONS_ONLINE_EXTRAPOLATE_MAX_SECONDS, 600.f).toFloat();
+  connect(&extrapolateTimer, &QTimer::timeout, this, &OnlinedataController::extrapolateTimeout);
+
+  // Notification from thread that whazzup.txt is decoded
+  connect(&whazzupWatcher, &QFutureWatcher<whazzup::Result>::finished, this,
+          &OnlinedataController::whazzupProcessed);
 }
 
 OnlinedataController::~OnlinedataController()
 {
+  whazzupFuture.waitForFinished();
   deInitQueries();
 
   delete downloader;
@@ -108,8 +114,8 @@ void OnlinedataController::startDownloadInternal()
   if(currentState == NONE)
   {
     // Create a default user agent if not disabled for debugging
-    if(!atools::settings::Settings::instance().valueBool(lnm::OPTIONS_NO_USER_AGENT))
-      downloader->setDefaultUserAgentShort(QString(" Config/%1").arg(getNetwork()));
+    downloader->setUserAgentSuffix(QString(" Config/%1").arg(getNetwork()),
+                                   !atools::settings::Settings::instance().valueBool(lnm::OPTIONS_NO_USER_AGENT));
 
     QString url;
     if(whazzupUrlFromStatus.isEmpty() && // Status not downloaded yet
@@ -133,7 +139,7 @@ void OnlinedataController::startDownloadInternal()
       downloader->setUrl(url);
 
       // Call later in the event loop to avoid recursion
-      QTimer::singleShot(0, downloader, &HttpDownloader::startDownload);
+      QTimer::singleShot(0, downloader, &OnlineDownloader::startDownload);
     }
   }
   // opts::OnlineFormat onlineFormat = od.getOnlineFormat();
@@ -156,95 +162,149 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     // Parse status file
     manager->readFromStatus(codec->toUnicode(data));
 
-    // Get URL from status file
-    QString whazzupUrlFromStatus = manager->getWhazzupUrlFromStatus(whazzupGzipped);
-
     if(!manager->getMessageFromStatus().isEmpty())
       // Call later in the event loop
       QTimer::singleShot(0, this, &OnlinedataController::showMessageDialog);
 
-    if(!whazzupUrlFromStatus.isEmpty())
-    {
-      // Next in chain is whazzup.txt
-      currentState = DOWNLOADING_WHAZZUP;
-      downloader->setUrl(whazzupUrlFromStatus);
+    statusDownloaded();
+  }
+  else if(currentState == DOWNLOADING_WHAZZUP)
+  {
+    // Unzip and decode in background - continue in whazzupProcessed()
+    currentState = PROCESSING_WHAZZUP;
+    whazzupProcessingUrl = url;
+    whazzupFuture = QtConcurrent::run(whazzup::processWhazzup, data, whazzupGzipped, codec);
+    whazzupWatcher.setFuture(whazzupFuture);
+  }
+  else if(currentState == DOWNLOADING_WHAZZUP_SERVERS)
+  {
+    manager->readServersFromWhazzup(codec->toUnicode(data),
+                                    convertFormat(OptionData::instance().getOnlineFormat()),
+                                    manager->getLastUpdateTimeFromWhazzup());
+    serversDownloaded(true /* updated */);
+  }
+}
 
-      // Call later in the event loop to avoid recursion
-      QTimer::singleShot(0, downloader, &HttpDownloader::startDownload);
-    }
-    else
+void OnlinedataController::downloadNotModified(QString url)
+{
+  qDebug() << Q_FUNC_INFO << "url" << url;
+
+  if(currentState == DOWNLOADING_STATUS)
+  {
+    if(manager->getWhazzupUrlFromStatus(whazzupGzipped).isEmpty())
     {
-      // Done after downloading status.txt - start timer for next session
+      // Status was not read yet or reset - get it completely with next download
+      downloader->clearConditions();
       startDownloadTimer();
       currentState = NONE;
-      lastUpdateTime = QDateTime::currentDateTime();
     }
+    else
+      // Use URLs from last status.txt
+      statusDownloaded();
   }
   else if(currentState == DOWNLOADING_WHAZZUP)
   {
-    QByteArray whazzupData;
+    // Nothing changed - skip decoding and database update
+    qInfo() << Q_FUNC_INFO << "whazzup.txt not modified";
+    startDownloadTimer();
+    currentState = NONE;
+    lastUpdateTime = QDateTime::currentDateTime();
+  }
+  else if(currentState == DOWNLOADING_WHAZZUP_SERVERS)
+    serversDownloaded(false /* updated */);
+}
 
-    if(whazzupGzipped)
-    {
-      if(!atools::zip::gzipDecompress(data, whazzupData))
-        qWarning() << Q_FUNC_INFO << "Error unzipping data";
-    }
-    else
-      whazzupData = data;
+void OnlinedataController::statusDownloaded()
+{
+  // Get URL from status file
+  QString whazzupUrlFromStatus = manager->getWhazzupUrlFromStatus(whazzupGzipped);
 
-    if(manager->readFromWhazzup(codec->toUnicode(whazzupData),
-                                convertFormat(OptionData::instance().getOnlineFormat()),
-                                manager->getLastUpdateTimeFromWhazzup()))
-    {
-      QString whazzupVoiceUrlFromStatus = manager->getWhazzupVoiceUrlFromStatus();
-      if(!whazzupVoiceUrlFromStatus.isEmpty() &&
-         lastServerDownload < QDateTime::currentDateTime().addSecs(-MIN_SERVER_DOWNLOAD_INTERVAL_MIN * 60))
-      {
-        // Next in chain is server file
-        currentState = DOWNLOADING_WHAZZUP_SERVERS;
-        downloader->setUrl(whazzupVoiceUrlFromStatus);
+  if(!whazzupUrlFromStatus.isEmpty())
+  {
+    // Next in chain is whazzup.txt
+    currentState = DOWNLOADING_WHAZZUP;
+    downloader->setUrl(whazzupUrlFromStatus);
 
-        // Call later in the event loop to avoid recursion
-        QTimer::singleShot(0, downloader, &HttpDownloader::startDownload);
-      }
-      else
-      {
-        // Done after downloading whazzup.txt - start timer for next session
-        startDownloadTimer();
-        currentState = NONE;
-        lastUpdateTime = QDateTime::currentDateTime();
-
-        aircraftCache.clear();
-        // Message for search tabs, map widget and info
-        emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
-      }
-    }
-    else
-    {
-      qInfo() << Q_FUNC_INFO << "whazzup.txt is not recent";
+    // Call later in the event loop to avoid recursion
+    QTimer::singleShot(0, downloader, &OnlineDownloader::startDownload);
+  }
+  else
+  {
+    // Done after downloading status.txt - start timer for next session
+    startDownloadTimer();
+    currentState = NONE;
+    lastUpdateTime = QDateTime::currentDateTime();
+  }
+}
 
-      // Done after old update - try again later
-      startDownloadTimer();
-      currentState = NONE;
-      lastUpdateTime = QDateTime::currentDateTime();
-    }
+void OnlinedataController::serversDownloaded(bool updated)
+{
+  lastServerDownload = QDateTime::currentDateTime();
+
+  // Done after downloading server.txt - start timer for next session
+  startDownloadTimer();
+  currentState = NONE;
+  lastUpdateTime = QDateTime::currentDateTime();
+
+  // Message for search tabs, map widget and info - clients were updated before servers download
+  aircraftCache.clear();
+  emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
+
+  if(updated)
+    emit onlineServersUpdated(true /* load all */, true /* keep selection */);
+}
+
+void OnlinedataController::whazzupProcessed()
+{
+  if(currentState != PROCESSING_WHAZZUP)
+    // Stopped while processing - discard
+    return;
+
+  whazzup::Result result = whazzupFuture.result();
+  if(!result.errorText.isEmpty())
+  {
+    // Broken file on the server - keep the previous data and try again with the next download
+    qWarning() << Q_FUNC_INFO << "Cannot decode" << whazzupProcessingUrl << result.errorText;
+    downloader->clearCondition(whazzupProcessingUrl);
+    startDownloadTimer();
+    currentState = NONE;
+    return;
   }
-  else if(currentState == DOWNLOADING_WHAZZUP_SERVERS)
+
+  bool updated = false;
+  if(manager->readFromWhazzup(result.text, convertFormat(OptionData::instance().getOnlineFormat()),
+                              manager->getLastUpdateTimeFromWhazzup()))
   {
-    manager->readServersFromWhazzup(codec->toUnicode(data),
-                                    convertFormat(OptionData::instance().getOnlineFormat()),
-                                    manager->getLastUpdateTimeFromWhazzup());
-    lastServerDownload = QDateTime::currentDateTime();
+    updateClientIndex();
+    updated = true;
+  }
+  else
+    qInfo() << Q_FUNC_INFO << "whazzup.txt is not recent";
+
+  QString whazzupVoiceUrlFromStatus = manager->getWhazzupVoiceUrlFromStatus();
+  if(updated && !whazzupVoiceUrlFromStatus.isEmpty() &&
+     lastServerDownload < QDateTime::currentDateTime().addSecs(-MIN_SERVER_DOWNLOAD_INTERVAL_MIN * 60))
+  {
+    // Next in chain is server file
+    currentState = DOWNLOADING_WHAZZUP_SERVERS;
+    downloader->setUrl(whazzupVoiceUrlFromStatus);
 
-    // Done after downloading server.txt - start timer for next session
+    // Call later in the event loop to avoid recursion
+    QTimer::singleShot(0, downloader, &OnlineDownloader::startDownload);
+  }
+  else
+  {
+    // Done after downloading whazzup.txt - start timer for next session
     startDownloadTimer();
     currentState = NONE;
     lastUpdateTime = QDateTime::currentDateTime();
 
-    aircraftCache.clear();
-    // Message for search tabs, map widget and info
-    emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
-    emit onlineServersUpdated(true /* load all */, true /* keep selection */);
+    if(updated)
+    {
+      aircraftCache.clear();
+      // Message for search tabs, map widget and info
+      emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
+    }
   }
 }
 
@@ -260,6 +320,10 @@ void OnlinedataController::downloadFailed(const QString& error, QString url)
 
 void OnlinedataController::stopAllProcesses()
 {
+  if(currentState == PROCESSING_WHAZZUP)
+    // Result will be discarded - download again completely next time
+    downloader->clearCondition(whazzupProcessingUrl);
+
   downloader->cancelDownload();
   downloadTimer.stop();
   currentState = NONE;
@@ -278,11 +342,13 @@ void OnlinedataController::optionsChanged()
   // Clear all URL from status.txt too
   manager->resetForNewOptions();
   stopAllProcesses();
+  downloader->clearConditions();
   whazzupGzipped = false;
 
   // Remove all from the database
   manager->clearData();
   aircraftCache.clear();
+  clearClientIndex();
 
   if(OptionData::instance().getOnlineNetwork() == opts::ONLINE_NONE)
   {
@@ -345,6 +411,11 @@ const QList<atools::fs::sc::SimConnectAircraft> *OnlinedataController::getAircra
   static const double queryRectInflationIncrement = 0.1;
   static const int queryMaxRows = 5000;
 
+  bool extrapolate = isExtrapolating();
+  if(extrapolate && !lazy)
+    // Positions change constantly - fill the list from the index on each call
+    aircraftCache.clear();
+
   aircraftCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
                             [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
   {
@@ -353,16 +424,55 @@ const QList<atools::fs::sc::SimConnectAircraft> *OnlinedataController::getAircra
 
   if(aircraftCache.list.isEmpty() && !lazy)
   {
+    float elapsed = clientIndexTimer.isValid() ? clientIndexTimer.elapsed() / 1000.f : 0.f;
+
     for(const Marble::GeoDataLatLonBox& r :
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
-      query::bindCoordinatePointInRect(r, aircraftByRectQuery);
-      aircraftByRectQuery->exec();
-      while(aircraftByRectQuery->next())
+      float west = static_cast<float>(r.west(Marble::GeoDataCoordinates::Degree));
+      float east = static_cast<float>(r.east(Marble::GeoDataCoordinates::Degree));
+      float south = static_cast<float>(r.south(Marble::GeoDataCoordinates::Degree));
+      float north = static_cast<float>(r.north(Marble::GeoDataCoordinates::Degree));
+
+      // Extrapolated aircraft might have left their cell - look into all cells they can reach
+      int marginX = 0, marginY = 0;
+      if(extrapolate)
       {
-        atools::fs::sc::SimConnectAircraft ac;
-        fillAircraftFromClient(ac, aircraftByRectQuery->record());
-        aircraftCache.list.append(ac);
+        float marginLatDeg = maxExtrapolateDistanceNm / 60.f;
+        float maxAbsLat = std::min(std::max(std::abs(south), std::abs(north)) + marginLatDeg, 89.f);
+        float marginLonDeg = marginLatDeg / std::cos(atools::geo::toRadians(maxAbsLat));
+        marginX = static_cast<int>(std::ceil(marginLonDeg / CLIENT_GRID_CELL_DEG));
+        marginY = static_cast<int>(std::ceil(marginLatDeg / CLIENT_GRID_CELL_DEG));
+      }
+
+      int minX = clientGridX(west) - marginX, maxX = clientGridX(east) + marginX;
+      if(maxX - minX >= CLIENT_GRID_COLUMNS)
+      {
+        // Margin covers all columns
+        minX = 0;
+        maxX = CLIENT_GRID_COLUMNS - 1;
+      }
+      int minY = std::max(clientGridY(south) - marginY, 0);
+      int maxY = std::min(clientGridY(north) + marginY, CLIENT_GRID_ROWS - 1);
+
+      // Scan all grid cells touching the rectangle and check the positions
+      for(int y = minY; y <= maxY; y++)
+      {
+        for(int x = minX; x <= maxX; x++)
+        {
+          // Wrap columns around the anti-meridian
+          int column = (x + CLIENT_GRID_COLUMNS) % CLIENT_GRID_COLUMNS;
+          for(int index : clientGrid.value(y * CLIENT_GRID_COLUMNS + column))
+          {
+            atools::geo::Pos pos = extrapolate ? clientPosition(index, elapsed) : clients.at(index).getPosition();
+            if(pos.getLonX() >= west && pos.getLonX() <= east && pos.getLatY() >= south && pos.getLatY() <= north)
+            {
+              aircraftCache.list.append(clients.at(index));
+              if(extrapolate)
+                aircraftCache.list.last().setPosition(pos);
+            }
+          }
+        }
       }
     }
   }
@@ -392,20 +502,155 @@ void OnlinedataController::initQueries()
 
   manager->initQueries();
 
-  aircraftByRectQuery = new atools::sql::SqlQuery(getDatabase());
-  aircraftByRectQuery->prepare("select * from client "
-                               "where lonx between :leftx and :rightx and "
-                               "laty between :bottomy and :topy");
+  // Database might contain data from a previous session
+  updateClientIndex();
 }
 
 void OnlinedataController::deInitQueries()
 {
   aircraftCache.clear();
+  clearClientIndex();
 
   manager->deInitQueries();
+}
+
+void OnlinedataController::updateClientIndex()
+{
+  // Remember currently shown positions to blend them into the new ones
+  QHash<QString, atools::geo::Pos> lastPositions;
+  if(isExtrapolating())
+  {
+    float elapsed = clientIndexTimer.elapsed() / 1000.f;
+    for(int i = 0; i < clients.size(); i++)
+    {
+      if(clientMotions.at(i).groundSpeedKts > 0.f)
+        lastPositions.insert(clients.at(i).getAirplaneRegistration(), clientPosition(i, elapsed));
+    }
+  }
+
+  clearClientIndex();
+
+  atools::sql::SqlQuery query(getDatabase());
+  query.exec("select * from client");
+  while(query.next())
+  {
+    atools::fs::sc::SimConnectAircraft ac;
+    fillAircraftFromClient(ac, query.record());
+
+    const atools::geo::Pos& pos = ac.getPosition();
+    if(pos.isValid())
+    {
+      ClientMotion motion;
+      if(!ac.isOnGround() && ac.getGroundSpeedKts() >= MIN_EXTRAPOLATE_SPEED_KTS)
+      {
+        motion.groundSpeedKts = ac.getGroundSpeedKts();
+        motion.headingDegTrue = ac.getHeadingDegTrue();
+        maxGroundSpeedKts = std::max(maxGroundSpeedKts, motion.groundSpeedKts);
+        numMovingClients++;
+
+        QHash<QString, atools::geo::Pos>::const_iterator it = lastPositions.constFind(ac.getAirplaneRegistration());
+        if(it != lastPositions.constEnd() &&
+           it.value().distanceMeterTo(pos) < atools::geo::nmToMeter(SMOOTH_MAX_DISTANCE_NM))
+        {
+          motion.offsetLonX = it.value().getLonX() - pos.getLonX();
+          motion.offsetLatY = it.value().getLatY() - pos.getLatY();
+
+          // Crossing the anti-meridian
+          if(motion.offsetLonX > 180.f)
+            motion.offsetLonX -= 360.f;
+          else if(motion.offsetLonX < -180.f)
+            motion.offsetLonX += 360.f;
+        }
+      }
+
+      clientGrid[clientGridY(pos.getLatY()) * CLIENT_GRID_COLUMNS + clientGridX(pos.getLonX())].append(clients.size());
+      clients.append(ac);
+      clientMotions.append(motion);
+    }
+  }
+
+  // Extrapolate from the time the data was reported and not from the time it was loaded
+  QDateTime dataTime = manager->getLastUpdateTimeFromWhazzup();
+  clientDataAgeSeconds = 0.f;
+  if(dataTime.isValid())
+  {
+    float age = dataTime.toUTC().msecsTo(QDateTime::currentDateTime().toUTC()) / 1000.f;
+
+    // Ignore outdated data like loaded from the database at startup or a wrong time zone
+    if(age > 0.f && age < maxExtrapolateSeconds)
+      clientDataAgeSeconds = age;
+  }
+
+  // Farthest distance an aircraft can move away from its cell including the blended out offset
+  maxExtrapolateDistanceNm = maxGroundSpeedKts * maxExtrapolateSeconds / 3600.f + SMOOTH_MAX_DISTANCE_NM;
+
+  clientIndexTimer.start();
+  if(isExtrapolating())
+    extrapolateTimer.start();
+
+  qDebug() << Q_FUNC_INFO << "clients" << clients.size() << "moving" << numMovingClients
+           << "cells" << clientGrid.size() << "smoothed" << lastPositions.size()
+           << "data age" << clientDataAgeSeconds << "max distance" << maxExtrapolateDistanceNm;
+}
+
+void OnlinedataController::clearClientIndex()
+{
+  clients.clear();
+  clientGrid.clear();
+  clientMotions.clear();
+  numMovingClients = 0;
+  maxGroundSpeedKts = maxExtrapolateDistanceNm = clientDataAgeSeconds = 0.f;
+  clientIndexTimer.invalidate();
+  extrapolateTimer.stop();
+}
+
+atools::geo::Pos OnlinedataController::clientPosition(int index, float elapsedSeconds) const
+{
+  const ClientMotion& motion = clientMotions.at(index);
+  atools::geo::Pos pos = clients.at(index).getPosition();
 
-  delete aircraftByRectQuery;
-  aircraftByRectQuery = nullptr;
+  if(motion.groundSpeedKts > 0.f)
+  {
+    float altitude = pos.getAltitude();
+    float seconds = std::min(clientDataAgeSeconds + elapsedSeconds, maxExtrapolateSeconds);
+    pos = pos.endpoint(atools::geo::nmToMeter(motion.groundSpeedKts * seconds / 3600.f),
+                       motion.headingDegTrue).normalize();
+
+    if(elapsedSeconds < SMOOTH_SECONDS)
+    {
+      // Blend out the error of the previous extrapolation
+      float fraction = 1.f - elapsedSeconds / SMOOTH_SECONDS;
+      pos = atools::geo::Pos(pos.getLonX() + motion.offsetLonX * fraction,
+                             pos.getLatY() + motion.offsetLatY * fraction).normalize();
+    }
+    pos.setAltitude(altitude);
+  }
+  return pos;
+}
+
+bool OnlinedataController::isExtrapolating() const
+{
+  return extrapolateTimer.interval() > 0 && numMovingClients > 0 && clientIndexTimer.isValid();
+}
+
+void OnlinedataController::extrapolateTimeout()
+{
+  if(isExtrapolating() &&
+     clientDataAgeSeconds + clientIndexTimer.elapsed() / 1000.f < maxExtrapolateSeconds + SMOOTH_SECONDS)
+    emit onlineClientPositionsUpdated();
+  else
+    // Positions do not change anymore
+    extrapolateTimer.stop();
+}
+
+int OnlinedataController::clientGridX(float lonX)
+{
+  return std::min(std::max(static_cast<int>((lonX + 180.f) / CLIENT_GRID_CELL_DEG), 0), CLIENT_GRID_COLUMNS - 1);
+}
+
+int OnlinedataController::clientGridY(float latY)
+{
+  return std::min(std::max(static_cast<int>((latY + 90.f) / CLIENT_GRID_CELL_DEG), 0), CLIENT_GRID_ROWS - 1);
 }
 
 int OnlinedataController::getNumClients() const
@@ -19,10 +19,15 @@
 #define LNM_ONLINECONTROLLER_H
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QVector>
 
 #include "query/querytypes.h"
+#include "online/whazzupprocessor.h"
 
 class MapLayer;
 
@@ -31,8 +36,8 @@ class GeoDataLatLonBox;
 }
 
 namespace atools {
-namespace util {
-class HttpDownloader;
+namespace geo {
+class Pos;
 }
 namespace sql {
 class SqlDatabase;
@@ -50,6 +55,7 @@ class OnlinedataManager;
 }
 
 class MainWindow;
+class OnlineDownloader;
 class QTextCodec;
 
 /*
@@ -84,7 +90,9 @@ public:
   QString getNetwork() const;
   bool isNetworkActive() const;
 
-  /* Get aircraft within bounding rectangle. Objects are cached. */
+  /* Get aircraft within bounding rectangle. Objects are cached.
+   * Aircraft are taken from the in-memory grid index which is rebuilt on each whazzup.txt update.
+   * Positions of flying aircraft are extrapolated from ground speed and heading if enabled. */
   const QList<atools::fs::sc::SimConnectAircraft> *getAircraft(const Marble::GeoDataLatLonBox& rect,
                                                                const MapLayer *mapLayer, bool lazy);
 
@@ -115,11 +123,26 @@ signals:
   /* Sent when network changes via options dialog */
   void onlineNetworkChanged();
 
+  /* Sent periodically while positions of online aircraft are extrapolated between downloads */
+  void onlineClientPositionsUpdated();
+
 private:
   /* HTTP download signal slots */
   void downloadFinished(const QByteArray& data, QString url);
   void downloadFailed(const QString& error, QString url);
 
+  /* Server replied not modified or content is the same as last time */
+  void downloadNotModified(QString url);
+
+  /* Continue chain after status.txt was downloaded or not modified */
+  void statusDownloaded();
+
+  /* End chain after servers were downloaded and send updates */
+  void serversDownloaded(bool updated);
+
+  /* Called by watcher when whazzup.txt was decoded and compared in the background */
+  void whazzupProcessed();
+
   void startDownloadInternal();
   void startDownloadTimer();
   void stopAllProcesses();
@@ -127,8 +150,48 @@ private:
   /* Show message from status.txt */
   void showMessageDialog();
 
+  /* Load all clients from the database into the grid index */
+  void updateClientIndex();
+  void clearClientIndex();
+
+  /* Position of client at index extrapolated for the given number of seconds after the index update.
+   * Age of the data at the time of the update is added. */
+  atools::geo::Pos clientPosition(int index, float elapsedSeconds) const;
+
+  /* True if extrapolation is enabled and there are moving aircraft */
+  bool isExtrapolating() const;
+
+  /* Called by extrapolateTimer */
+  void extrapolateTimeout();
+
+  /* Grid cell column and row for coordinates - clamped to valid range */
+  static int clientGridX(float lonX);
+  static int clientGridY(float latY);
+
+  static Q_DECL_CONSTEXPR int CLIENT_GRID_CELL_DEG = 5;
+  static Q_DECL_CONSTEXPR int CLIENT_GRID_COLUMNS = 360 / CLIENT_GRID_CELL_DEG;
+  static Q_DECL_CONSTEXPR int CLIENT_GRID_ROWS = 180 / CLIENT_GRID_CELL_DEG;
+
+  /* Difference between old extrapolated and new reported position is blended out in this time */
+  static Q_DECL_CONSTEXPR float SMOOTH_SECONDS = 20.f;
+
+  /* Do not smooth but jump if the extrapolation was off by more than this */
+  static Q_DECL_CONSTEXPR float SMOOTH_MAX_DISTANCE_NM = 10.f;
+
+  /* Minimum ground speed for extrapolation. Avoids jitter for parked aircraft. */
+  static Q_DECL_CONSTEXPR float MIN_EXTRAPOLATE_SPEED_KTS = 30.f;
+
+  /* Motion of a client used to extrapolate the position */
+  struct ClientMotion
+  {
+    float groundSpeedKts = 0.f, headingDegTrue = 0.f;
+
+    /* Offset to reported position which is blended out in SMOOTH_SECONDS after an update */
+    float offsetLonX = 0.f, offsetLatY = 0.f;
+  };
+
   atools::fs::online::OnlinedataManager *manager;
-  atools::util::HttpDownloader *downloader;
+  OnlineDownloader *downloader;
   MainWindow *mainWindow;
 
   enum State
@@ -136,6 +199,7 @@ private:
     NONE, /* Not downloading anything */
     DOWNLOADING_STATUS, /* Downloading status.txt */
     DOWNLOADING_WHAZZUP, /* Downloading whazzup.txt */
+    PROCESSING_WHAZZUP, /* Decoding whazzup.txt in background */
     DOWNLOADING_WHAZZUP_SERVERS /* Downloading servers */
   };
 
@@ -154,8 +218,35 @@ private:
 
   QTextCodec *codec = nullptr;
 
+  /* Unzips and decodes whazzup.txt */
+  QFuture<whazzup::Result> whazzupFuture;
+  QFutureWatcher<whazzup::Result> whazzupWatcher;
+  QString whazzupProcessingUrl; /* URL of the data being processed */
+
   SimpleRectCache<atools::fs::sc::SimConnectAircraft> aircraftCache;
-  atools::sql::SqlQuery *aircraftByRectQuery = nullptr;
+
+  /* All clients having a valid position and a grid of CLIENT_GRID_CELL_DEG degree cells.
+   * Key is row * CLIENT_GRID_COLUMNS + column and value is a list of indexes into clients. */
+  QVector<atools::fs::sc::SimConnectAircraft> clients;
+  QHash<int, QVector<int> > clientGrid;
+
+  /* Same size and order as clients */
+  QVector<ClientMotion> clientMotions;
+  int numMovingClients = 0;
+  float maxGroundSpeedKts = 0.f;
+
+  /* Farthest distance an aircraft can be extrapolated - used as margin for grid queries */
+  float maxExtrapolateDistanceNm = 0.f;
+
+  /* Age of the whazzup data when the index was updated. 0 if data is older than maxExtrapolateSeconds. */
+  float clientDataAgeSeconds = 0.f;
+
+  /* Time since last index update for extrapolation */
+  QElapsedTimer clientIndexTimer;
+
+  /* Triggers map updates while extrapolating - disabled if interval is 0 */
+  QTimer extrapolateTimer;
+  float maxExtrapolateSeconds = 600.f;
 };
 
 #endif // LNM_ONLINECONTROLLER_H
@@ -0,0 +1,140 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "online/onlinedownloader.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSysInfo>
+
+/* HTTP status code if content is not modified since last request */
+static const int HTTP_NOT_MODIFIED = 304;
+
+OnlineDownloader::OnlineDownloader(QObject *parent)
+  : QObject(parent), network(this)
+{
+  setUserAgentSuffix(QString());
+}
+
+OnlineDownloader::~OnlineDownloader()
+{
+  cancelDownload();
+}
+
+void OnlineDownloader::startDownload()
+{
+  cancelDownload();
+
+  QNetworkRequest request(QUrl(url));
+  request.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+
+  // Avoid getting stale copies from proxies
+  request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+
+  if(!userAgent.isEmpty())
+    request.setRawHeader("User-Agent", userAgent);
+
+  const Condition condition = conditions.value(request.url().toString());
+  if(!condition.etag.isEmpty())
+    request.setRawHeader("If-None-Match", condition.etag);
+  if(!condition.lastModified.isEmpty())
+    request.setRawHeader("If-Modified-Since", condition.lastModified);
+
+  qDebug() << Q_FUNC_INFO << url << "etag" << condition.etag << "last modified" << condition.lastModified;
+
+  reply = network.get(request);
+  connect(reply, &QNetworkReply::finished, this, &OnlineDownloader::replyFinished);
+}
+
+void OnlineDownloader::cancelDownload()
+{
+  if(reply != nullptr)
+  {
+    // Detach first to avoid the finished signal on abort
+    QNetworkReply *canceledReply = reply;
+    reply = nullptr;
+    canceledReply->disconnect(this);
+    canceledReply->abort();
+    canceledReply->deleteLater();
+  }
+}
+
+void OnlineDownloader::setUserAgentSuffix(const QString& suffix, bool enabled)
+{
+  if(enabled)
+    userAgent = QString("%1/%2 (%3)%4").arg(QCoreApplication::applicationName()).
+                arg(QCoreApplication::applicationVersion()).arg(QSysInfo::prettyProductName()).
+                arg(suffix).toUtf8();
+  else
+    userAgent.clear();
+}
+
+void OnlineDownloader::clearConditions()
+{
+  conditions.clear();
+}
+
+void OnlineDownloader::clearCondition(const QString& conditionUrl)
+{
+  conditions.remove(conditionUrl);
+}
+
+void OnlineDownloader::replyFinished()
+{
+  QNetworkReply *finishedReply = reply;
+  reply = nullptr;
+  if(finishedReply == nullptr)
+    return;
+
+  finishedReply->deleteLater();
+  QString replyUrl = finishedReply->request().url().toString();
+
+  if(finishedReply->error() != QNetworkReply::NoError)
+  {
+    emit downloadFailed(finishedReply->errorString(), replyUrl);
+    return;
+  }
+
+  int status = finishedReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  if(status == HTTP_NOT_MODIFIED)
+  {
+    qDebug() << Q_FUNC_INFO << replyUrl << "not modified";
+    emit downloadNotModified(replyUrl);
+    return;
+  }
+
+  QByteArray data = finishedReply->readAll();
+  Condition& condition = conditions[replyUrl];
+  condition.etag = finishedReply->rawHeader("ETag");
+  condition.lastModified = finishedReply->rawHeader("Last-Modified");
+
+  // Server might not support conditional requests - compare content
+  QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+  if(hash == condition.hash)
+  {
+    qDebug() << Q_FUNC_INFO << replyUrl << "content not changed";
+    emit downloadNotModified(replyUrl);
+  }
+  else
+  {
+    condition.hash = hash;
+    emit downloadFinished(data, replyUrl);
+  }
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ONLINEDOWNLOADER_H
+#define LNM_ONLINEDOWNLOADER_H
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QObject>
+
+class QNetworkReply;
+
+/*
+ * Downloads the online network status.txt, whazzup.txt and servers files with conditional requests.
+ *
+ * Remembers ETag, Last-Modified and a hash of the content per URL and sends If-None-Match and
+ * If-Modified-Since headers on the next request. Emits downloadNotModified instead of downloadFinished
+ * if the server replies with 304 or the content is the same as the last time.
+ * Supports file:// URLs which allows to test with local files.
+ */
+class OnlineDownloader :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit OnlineDownloader(QObject *parent);
+  virtual ~OnlineDownloader();
+
+  /* Starts download of the URL set by setUrl. Cancels any running download. */
+  void startDownload();
+  void cancelDownload();
+
+  const QString& getUrl() const
+  {
+    return url;
+  }
+
+  void setUrl(const QString& value)
+  {
+    url = value;
+  }
+
+  /* Application name and version is always sent. Suffix is appended. Empty user agent if disabled. */
+  void setUserAgentSuffix(const QString& suffix, bool enabled = true);
+
+  /* Forget ETag, modification time and content hash of all URLs. Next downloads will report all files. */
+  void clearConditions();
+
+  /* Forget conditions of one URL. Call if the data delivered by downloadFinished was discarded or could not be
+   * read. Otherwise the next download will report not modified until the content changes. */
+  void clearCondition(const QString& conditionUrl);
+
+signals:
+  void downloadFinished(const QByteArray& data, QString url);
+  void downloadNotModified(QString url);
+  void downloadFailed(const QString& error, QString url);
+
+private:
+  /* Conditions remembered for each URL */
+  struct Condition
+  {
+    QByteArray etag, lastModified, hash;
+  };
+
+  void replyFinished();
+
+  QNetworkAccessManager network;
+  QNetworkReply *reply = nullptr;
+  QString url;
+  QByteArray userAgent;
+  QHash<QString, Condition> conditions;
+};
+
+#endif // LNM_ONLINEDOWNLOADER_H
@@ -0,0 +1,47 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "online/whazzupprocessor.h"
+
+#include "zip/gzip.h"
+
+#include <QTextCodec>
+#include <QCoreApplication>
+
+namespace whazzup {
+
+Result processWhazzup(QByteArray data, bool gzipped, QTextCodec *codec)
+{
+  Result result;
+
+  QByteArray whazzupData;
+  if(gzipped)
+  {
+    if(!atools::zip::gzipDecompress(data, whazzupData))
+    {
+      result.errorText = QCoreApplication::translate("whazzup", "Error unzipping data");
+      return result;
+    }
+  }
+  else
+    whazzupData.swap(data);
+
+  result.text = codec->toUnicode(whazzupData);
+  return result;
+}
+
+}
@@ -0,0 +1,45 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WHAZZUPPROCESSOR_H
+#define LNM_WHAZZUPPROCESSOR_H
+
+#include <QString>
+
+class QTextCodec;
+
+namespace whazzup {
+
+/* Result of processWhazzup() */
+struct Result
+{
+  /* Decoded file content to be passed to the online data manager */
+  QString text;
+
+  /* Not empty if data could not be decoded. Text is empty then. */
+  QString errorText;
+};
+
+/*
+ * Unzips and decodes the whazzup.txt data.
+ * Intended to run in a background thread. Uses no database or other shared objects.
+ */
+Result processWhazzup(QByteArray data, bool gzipped, QTextCodec *codec);
+
+}
+
+#endif // LNM_WHAZZUPPROCESSOR_H
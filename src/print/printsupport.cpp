@@ -97,11 +97,7 @@ void PrintSupport::fillWeatherCache()
   const Route& route = NavApp::getRouteConst();
 
   if(!route.isEmpty())
-  {
-    map::WeatherContext currentWeatherContext;
-    mainWindow->buildWeatherContext(currentWeatherContext, route.first().getAirport());
-    mainWindow->buildWeatherContext(currentWeatherContext, route.last().getAirport());
-  }
+    NavApp::getWeatherReporter()->preloadRouteWeather(route);
 }
 
 /* Open print preview dialog for flight plan. Called from PrintDialog */
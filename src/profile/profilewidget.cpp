@@ -94,6 +94,12 @@ void ProfileWidget::aircraftTrackPruned()
   if(!widgetVisible)
     return;
 
+  // First index is only 0 after the track was cleared
+  quint64 firstIndex = NavApp::getMapWidget()->getAircraftTrack().getFirstIndex();
+  if(firstIndex > 0 && (aircraftTrackPoints.isEmpty() || firstIndex <= aircraftTrackFirstIndex))
+    // Only positions before the first shown one were pruned - nothing to rebuild
+    return;
+
   updateScreenCoords();
   update();
 }
@@ -135,6 +141,13 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
             // Add track point and update widget if delta value between last and current update is large enough
             if(simData.getUserAircraft().getPosition().isValid())
             {
+              if(aircraftTrackPoints.isEmpty())
+              {
+                // Current position is the last one in the track
+                const AircraftTrack& aircraftTrack = NavApp::getMapWidget()->getAircraftTrack();
+                aircraftTrackFirstIndex = aircraftTrack.getFirstIndex() +
+                                          static_cast<quint64>(std::max(aircraftTrack.size() - 1, 0));
+              }
               aircraftTrackPoints.append(currentPoint);
 
               if(aircraftTrackPoints.boundingRect().width() > MIN_AIRCRAFT_TRACK_WIDTH)
@@ -304,7 +317,7 @@ void ProfileWidget::updateScreenCoords()
 
     for(int i = 0; i < aircraftTrack.size(); i++)
     {
-      const Pos& aircraftPos = aircraftTrack.at(i).pos;
+      Pos aircraftPos = aircraftTrack.at(i).pos;
       float distFromStart = route.getDistanceFromStart(aircraftPos);
 
       if(distFromStart < map::INVALID_DISTANCE_VALUE)
@@ -312,6 +325,9 @@ void ProfileWidget::updateScreenCoords()
         QPoint pt(X0 + static_cast<int>(distFromStart *horizontalScale),
                   Y0 + static_cast<int>(rect().height() - Y0 - aircraftPos.getAltitude() * verticalScale));
 
+        if(aircraftTrackPoints.isEmpty())
+          aircraftTrackFirstIndex = aircraftTrack.getFirstIndex() + static_cast<quint64>(i);
+
         if(aircraftTrackPoints.isEmpty() || (aircraftTrackPoints.last() - pt).manhattanLength() > 3)
           aircraftTrackPoints.append(pt);
       }
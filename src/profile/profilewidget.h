@@ -46,6 +46,9 @@ class ProfileWidget :
   Q_OBJECT
 
 public:
+  /* Do not update aircraft position more than every 0.1 seconds */
+  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 100;
+
   ProfileWidget(QMainWindow *parent);
   virtual ~ProfileWidget();
 
@@ -56,7 +59,7 @@ public:
   /* Update user aircraft on profile display */
   void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
 
-  /* Track was shortened and needs a full update */
+  /* Track was cleared or shortened. Needs a full update only if positions shown in the profile were removed. */
   void aircraftTrackPruned();
 
   void simulatorStatusChanged();
@@ -162,6 +165,9 @@ private:
   QPolygon aircraftTrackPoints;
   float maxTrackAltitudeFt = 0.f;
 
+  /* Stable track index of the position for the first point in aircraftTrackPoints */
+  quint64 aircraftTrackFirstIndex = 0;
+
   float aircraftDistanceFromStart, aircraftDistanceToDest;
   ElevationLegList legList;
 
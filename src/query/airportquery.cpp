@@ -144,6 +144,14 @@ Pos AirportQuery::getAirportCoordinatesByIdent(const QString& ident)
   return pos;
 }
 
+void AirportQuery::getAllAirportCoordinates(QHash<QString, atools::geo::Pos>& coordinates)
+{
+  SqlQuery query(db);
+  query.exec("select ident, lonx, laty from airport");
+  while(query.next())
+    coordinates.insert(query.valueStr("ident"), Pos(query.valueFloat("lonx"), query.valueFloat("laty")));
+}
+
 bool AirportQuery::hasProcedures(const QString& ident) const
 {
   return hasQueryByAirportIdent(*airportProcByIdentQuery, ident);
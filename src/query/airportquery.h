@@ -69,6 +69,9 @@ public:
   void getAirportByIdent(map::MapAirport& airport, const QString& ident);
   atools::geo::Pos getAirportCoordinatesByIdent(const QString& ident);
 
+  /* Get coordinates of all airports by ident */
+  void getAllAirportCoordinates(QHash<QString, atools::geo::Pos>& coordinates);
+
   bool hasProcedures(const QString& ident) const;
 
   /* True if there are STAR or approaches */
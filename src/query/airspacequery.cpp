@@ -106,6 +106,7 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
   {
     // Need a few more parameters to clear the cache which is different to other map features
     airspaceCache.list.clear();
+    airspaceFilterMisses++;
     lastAirspaceFilter = filter;
     lastFlightplanAltitude = flightPlanAltitude;
   }
@@ -219,9 +220,13 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
 const LineString *AirspaceQuery::getAirspaceGeometry(int boundaryId)
 {
   if(airspaceLineCache.contains(boundaryId))
+  {
+    airspaceLineCacheHits++;
     return airspaceLineCache.object(boundaryId);
+  }
   else
   {
+    airspaceLineCacheMisses++;
     LineString *lines = new LineString;
 
     airspaceLinesByIdQuery->bindValue(":id", boundaryId);
@@ -240,6 +245,12 @@ const LineString *AirspaceQuery::getAirspaceGeometry(int boundaryId)
   }
 }
 
+void AirspaceQuery::getCacheStatistics(quint64& hits, quint64& misses) const
+{
+  hits = airspaceCache.hits + airspaceLineCacheHits;
+  misses = airspaceCache.misses + airspaceLineCacheMisses + airspaceFilterMisses;
+}
+
 void AirspaceQuery::initQueries()
 {
   QString airspaceQueryBase, table, id;
@@ -69,6 +69,10 @@ public:
                                               map::MapAirspaceFilter filter, float flightPlanAltitude, bool lazy);
   const atools::geo::LineString *getAirspaceGeometry(int boundaryId);
 
+  /* Get accumulated number of cache hits and misses for the bounding rectangle and geometry caches.
+   * Used for profiling. */
+  void getCacheStatistics(quint64& hits, quint64& misses) const;
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -87,6 +91,7 @@ private:
 
   /* ID/object caches */
   QCache<int, atools::geo::LineString> airspaceLineCache;
+  quint64 airspaceLineCacheHits = 0, airspaceLineCacheMisses = 0, airspaceFilterMisses = 0;
 
   static int queryMaxRows;
 
@@ -967,10 +967,14 @@ const QList<map::MapAirport> *MapQuery::fetchAirports(const Marble::GeoDataLatLo
 const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
 {
   if(runwayOverwiewCache.contains(airportId))
+  {
+    runwayOverviewCacheHits++;
     return runwayOverwiewCache.object(airportId);
+  }
   else
   {
     using atools::geo::Pos;
+    runwayOverviewCacheMisses++;
 
     runwayOverviewQuery->bindValue(":airportId", airportId);
     runwayOverviewQuery->exec();
@@ -987,6 +991,14 @@ const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
   }
 }
 
+void MapQuery::getCacheStatistics(quint64& hits, quint64& misses) const
+{
+  hits = airportCache.hits + waypointCache.hits + vorCache.hits + ndbCache.hits + markerCache.hits +
+         ilsCache.hits + airwayCache.hits + runwayOverviewCacheHits;
+  misses = airportCache.misses + waypointCache.misses + vorCache.misses + ndbCache.misses + markerCache.misses +
+           ilsCache.misses + airwayCache.misses + runwayOverviewCacheMisses;
+}
+
 void MapQuery::initQueries()
 {
   // Common where clauses
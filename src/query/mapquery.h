@@ -173,6 +173,9 @@ public:
                                                    const QStringList& typesAll,
                                                    bool unknownType, float distance);
 
+  /* Get accumulated number of cache hits and misses for all bounding rectangle and id caches. Used for profiling. */
+  void getCacheStatistics(quint64& hits, quint64& misses) const;
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -206,6 +209,7 @@ private:
 
   /* ID/object caches */
   QCache<int, QList<map::MapRunway> > runwayOverwiewCache;
+  quint64 runwayOverviewCacheHits = 0, runwayOverviewCacheMisses = 0;
 
   static int queryMaxRows;
 
@@ -67,6 +67,9 @@ struct SimpleRectCache
   const MapLayer *curMapLayer = nullptr;
   QList<TYPE> list;
 
+  /* Number of requests served from the cache and number of requests needing a reload. Used for profiling. */
+  quint64 hits = 0, misses = 0;
+
 };
 
 // ---------------------------------------------------------------------------------
@@ -76,8 +79,11 @@ bool SimpleRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, co
                                         double increment, bool lazy, LayerCompareFunc funcSameLayer)
 {
   if(lazy)
-    // Nothing changed11
+  {
+    // Nothing changed
+    hits++;
     return false;
+  }
 
   // Store bounding rectangle and inflate it
   Marble::GeoDataLatLonBox cur(curRect);
@@ -89,8 +95,10 @@ bool SimpleRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, co
     list.clear();
     curRect = rect;
     curMapLayer = mapLayer;
+    misses++;
     return true;
   }
+  hits++;
   return false;
 }
 
@@ -81,6 +81,7 @@ void Route::copy(const Route& other)
   append(other);
 
   totalDistance = other.totalDistance;
+  legIndex = other.legIndex;
   flightplan = other.flightplan;
   shownTypes = other.shownTypes;
   boundingRect = other.boundingRect;
@@ -418,12 +419,17 @@ bool Route::getRouteDistances(float *distFromStart, float *distToDest,
     // Sum up all distances along the legs
     // Ignore missed approach legs until the active is a missedd approach leg
     float fromstart = 0.f;
-    for(int i = 0; i <= routeIndex; i++)
+    if(legIndex.isValid(size()))
+      fromstart = legIndex.getDistanceSumNm(routeIndex, activeIsMissed);
+    else
     {
-      if(!at(i).getProcedureLeg().isMissed() || activeIsMissed)
-        fromstart += at(i).getDistanceTo();
-      else
-        break;
+      for(int i = 0; i <= routeIndex; i++)
+      {
+        if(!at(i).getProcedureLeg().isMissed() || activeIsMissed)
+          fromstart += at(i).getDistanceTo();
+        else
+          break;
+      }
     }
     fromstart -= distToCurrent;
     fromstart = std::abs(fromstart);
@@ -468,12 +474,18 @@ float Route::getDistanceFromStart(const atools::geo::Pos& pos) const
   if(leg < map::INVALID_INDEX_VALUE && result.status == atools::geo::ALONG_TRACK)
   {
     float fromstart = 0.f;
-    for(int i = 1; i < leg; i++)
+    if(legIndex.isValid(size()))
+      // Sum from second leg
+      fromstart = nmToMeter(legIndex.getDistanceSumNm(leg - 1, false) - legIndex.getDistanceSumNm(0, false));
+    else
     {
-      if(!at(i).getProcedureLeg().isMissed())
-        fromstart += nmToMeter(at(i).getDistanceTo());
-      else
-        break;
+      for(int i = 1; i < leg; i++)
+      {
+        if(!at(i).getProcedureLeg().isMissed())
+          fromstart += nmToMeter(at(i).getDistanceTo());
+        else
+          break;
+      }
     }
     fromstart += result.distanceFrom1;
     fromstart = std::abs(fromstart);
@@ -747,12 +759,20 @@ void Route::removeProcedureLegs()
 
 void Route::removeProcedureLegs(proc::MapProcedureTypes type)
 {
-  clearProcedures(type);
-  clearProcedureLegs(type);
+  bool hasProcedure = (type & proc::PROCEDURE_DEPARTURE && hasAnyDepartureProcedure()) ||
+                      (type & proc::PROCEDURE_STAR_ALL && hasAnyStarProcedure()) ||
+                      (type & proc::PROCEDURE_ARRIVAL && hasAnyArrivalProcedure());
 
   // Remove properties from flight plan
   clearFlightplanProcedureProperties(type);
 
+  // Legs are unchanged if there is no procedure of the given type - leave changed flags for updateChanged()
+  if(!hasProcedure)
+    return;
+
+  clearProcedures(type);
+  clearProcedureLegs(type);
+
   updateAll();
 }
 
@@ -873,6 +893,22 @@ void Route::updateAll()
   updateMagvar();
   updateDistancesAndCourse();
   updateBoundingRect();
+  legIndex.build(*this);
+}
+
+void Route::updateChanged()
+{
+  updateIndicesAndOffsets();
+  updateMagvar(true /* onlyChanged */);
+  updateDistancesAndCourse(true /* onlyChanged */);
+  updateBoundingRect();
+  legIndex.build(*this);
+}
+
+void Route::setLegChanged(int index)
+{
+  if(index >= 0 && index < size())
+    (*this)[index].setChanged();
 }
 
 void Route::updateAirportRegions()
@@ -1000,28 +1036,41 @@ bool Route::isAirportAfterArrival(int index)
          index == size() - 1 && at(index).getMapObjectType() == map::AIRPORT;
 }
 
-void Route::updateDistancesAndCourse()
+void Route::updateDistancesAndCourse(bool onlyChanged)
 {
   totalDistance = 0.f;
   RouteLeg *last = nullptr;
+  bool lastChanged = false;
   for(int i = 0; i < size(); i++)
   {
     if(isAirportAfterArrival(i))
       break;
 
     RouteLeg& leg = (*this)[i];
-    leg.updateDistanceAndCourse(i, last);
+    bool changed = leg.isChanged();
+
+    // Distance and course depend on the previous leg
+    if(!onlyChanged || changed || lastChanged)
+      leg.updateDistanceAndCourse(i, last);
+
     if(!leg.getProcedureLeg().isMissed())
       totalDistance += leg.getDistanceTo();
     last = &leg;
+    lastChanged = changed;
   }
+
+  for(int i = 0; i < size(); i++)
+    (*this)[i].setChanged(false);
 }
 
-void Route::updateMagvar()
+void Route::updateMagvar(bool onlyChanged)
 {
   // get magvar from internal database objects (waypoints, VOR and others)
   for(int i = 0; i < size(); i++)
-    (*this)[i].updateMagvar();
+  {
+    if(!onlyChanged || at(i).isChanged())
+      (*this)[i].updateMagvar();
+  }
 }
 
 /* Update the bounding rect using marble functions to catch anti meridian overlap */
@@ -1049,26 +1098,13 @@ void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDista
   if(!pos.isValid())
     return;
 
-  float minDistance = map::INVALID_DISTANCE_VALUE;
-
-  // Check only until the approach starts if required
   atools::geo::LineDistance result;
+  index = getNearestRouteLegResult(pos.pos, result, false /* ignoreNotEditable */);
 
-  for(int i = 1; i < size(); i++)
+  if(index != map::INVALID_INDEX_VALUE)
   {
-    pos.pos.distanceMeterToLine(getPositionAt(i - 1), getPositionAt(i), result);
-    float distance = std::abs(result.distance);
+    crossTrackDistanceMeter = result.distance;
 
-    if(result.status != atools::geo::INVALID && distance < minDistance)
-    {
-      minDistance = distance;
-      crossTrackDistanceMeter = result.distance;
-      index = i;
-    }
-  }
-
-  if(crossTrackDistanceMeter < map::INVALID_DISTANCE_VALUE)
-  {
     if(std::abs(crossTrackDistanceMeter) > atools::geo::nmToMeter(100.f))
     {
       // Too far away from any segment or point
@@ -1089,30 +1125,55 @@ int Route::getNearestRouteLegResult(const atools::geo::Pos& pos,
     return index;
 
   // Check only until the approach starts if required
-  atools::geo::LineDistance result, minResult;
+  atools::geo::LineDistance minResult;
   minResult.status = atools::geo::INVALID;
   minResult.distance = map::INVALID_DISTANCE_VALUE;
 
-  for(int i = 1; i < size(); i++)
+  QVector<int> legs;
+  float guardMeter;
+  if(legIndex.isValid(size()) && legIndex.getCandidateLegs(pos, legs, guardMeter))
   {
-    if(ignoreNotEditable && !canEditLeg(i))
-      continue;
+    // Check only legs nearby - legs are sorted by index
+    for(int i : legs)
+      nearestLeg(pos, i, ignoreNotEditable, minResult, index);
 
-    pos.distanceMeterToLine(getPositionAt(i - 1), getPositionAt(i), result);
-
-    if(result.status != atools::geo::INVALID && std::abs(result.distance) < std::abs(minResult.distance))
+    if(index == map::INVALID_INDEX_VALUE || std::abs(minResult.distance) >= guardMeter)
     {
-      minResult = result;
-      index = i;
+      // Nearest leg might be outside of the indexed area - check all
+      index = map::INVALID_INDEX_VALUE;
+      minResult.status = atools::geo::INVALID;
+      minResult.distance = map::INVALID_DISTANCE_VALUE;
     }
   }
 
+  if(index == map::INVALID_INDEX_VALUE)
+  {
+    for(int i = 1; i < size(); i++)
+      nearestLeg(pos, i, ignoreNotEditable, minResult, index);
+  }
+
   if(index != map::INVALID_INDEX_VALUE)
     lineDistanceResult = minResult;
 
   return index;
 }
 
+void Route::nearestLeg(const atools::geo::Pos& pos, int leg, bool ignoreNotEditable,
+                       atools::geo::LineDistance& minResult, int& index) const
+{
+  if(ignoreNotEditable && !canEditLeg(leg))
+    return;
+
+  atools::geo::LineDistance result;
+  pos.distanceMeterToLine(getPositionAt(leg - 1), getPositionAt(leg), result);
+
+  if(result.status != atools::geo::INVALID && std::abs(result.distance) < std::abs(minResult.distance))
+  {
+    minResult = result;
+    index = leg;
+  }
+}
+
 const RouteLeg& Route::getStartAfterProcedure() const
 {
   return at(getStartIndexAfterProcedure());
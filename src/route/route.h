@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_ROUTE_H
 
 #include "route/routeleg.h"
+#include "route/routelegindex.h"
 
 #include "fs/pln/flightplan.h"
 
@@ -253,7 +254,7 @@ public:
   /* Removes legs that match the given procedures */
   void clearProcedureLegs(proc::MapProcedureTypes type);
 
-  /* Deletes flight plan properties too */
+  /* Deletes flight plan properties too. Calls updateAll() only if any procedure of the given type was removed. */
   void removeProcedureLegs();
   void removeProcedureLegs(proc::MapProcedureTypes type);
 
@@ -280,6 +281,13 @@ public:
    *  Also calculates maximum number of user points. */
   void updateAll();
 
+  /* Same as updateAll() but updates magnetic variation, distance and course only for legs which are
+   * marked as changed and their successors. Use after inserting, replacing, moving or deleting single legs. */
+  void updateChanged();
+
+  /* Mark leg as changed. Call for the leg following a deleted one. Ignores invalid indexes. */
+  void setLegChanged(int index);
+
   /* Use a expensive heuristic to update the missing regions in all airports
    * before export for formats which need it. */
   void updateAirportRegions();
@@ -366,12 +374,13 @@ public:
 private:
   void clearFlightplanProcedureProperties(proc::MapProcedureTypes type);
 
-  /* Calculate all distances and courses for route map objects */
-  void updateDistancesAndCourse();
+  /* Calculate all distances and courses for route map objects. Only changed legs and
+   * their successors if onlyChanged is true. */
+  void updateDistancesAndCourse(bool onlyChanged = false);
   void updateBoundingRect();
 
-  /* Update and calculate magnetic variation for all route map objects */
-  void updateMagvar();
+  /* Update and calculate magnetic variation for all or changed route map objects */
+  void updateMagvar(bool onlyChanged = false);
 
   /* Assign index and pointer to flight plan for all objects */
   void updateIndicesAndOffsets();
@@ -382,10 +391,18 @@ private:
   /* Get indexes to nearest approach or route leg and cross track distance to the nearest ofthem in nm */
   void copy(const Route& other);
   void nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter, int& index) const;
+
+  /* Check leg and update minimum result and index if leg is nearer */
+  void nearestLeg(const atools::geo::Pos& pos, int leg, bool ignoreNotEditable,
+                  atools::geo::LineDistance& minResult, int& index) const;
   bool isSmaller(const atools::geo::LineDistance& dist1, const atools::geo::LineDistance& dist2, float epsilon);
   int adjustedActiveLeg() const;
 
   atools::geo::Rect boundingRect;
+
+  /* Distance sums and spatial index of legs. Updated in updateAll(). */
+  RouteLegIndex legIndex;
+
   /* Nautical miles not including missed approach */
   float totalDistance = 0.f;
   atools::fs::pln::Flightplan flightplan;
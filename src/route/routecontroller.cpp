@@ -59,6 +59,7 @@
 #include <QClipboard>
 #include <QFile>
 #include <QStandardItemModel>
+#include <QSet>
 #include <QInputDialog>
 #include <QFileInfo>
 
@@ -1790,6 +1791,12 @@ void RouteController::moveSelectedLegsInternal(MoveDirection direction)
       route.getFlightplan().getEntries().move(row, row + direction);
       route.move(row, row + direction);
 
+      // Moved leg and the legs following the old and new position need new distance and course
+      route.setLegChanged(row);
+      route.setLegChanged(row + 1);
+      route.setLegChanged(row + direction);
+      route.setLegChanged(row + direction + 1);
+
       // Move row
       model->insertRow(row + direction, model->takeRow(row));
     }
@@ -1825,7 +1832,7 @@ void RouteController::moveSelectedLegsInternal(MoveDirection direction)
       eraseAirway(lastRow + 1);
     }
 
-    route.updateAll();
+    route.updateChanged();
     route.updateAirwaysAndAltitude();
 
     // Force update of start if departure airport was moved
@@ -1836,7 +1843,11 @@ void RouteController::moveSelectedLegsInternal(MoveDirection direction)
     updateFlightplanFromWidgets();
 
     route.updateActiveLegAndPos(true /* force update */);
-    updateTableModel();
+
+    QList<int> changedRows;
+    for(int row : rows)
+      changedRows << row << row + direction;
+    updateTableModelRows(changedRows);
 
     // Restore current position at new moved position
     view->setCurrentIndex(model->index(curIdx.row() + direction, curIdx.column()));
@@ -1886,11 +1897,14 @@ void RouteController::deleteSelectedLegs()
 
       route.removeAt(row);
       model->removeRow(row);
+
+      // Successor needs new distance and course
+      route.setLegChanged(row);
     }
 
     route.removeProcedureLegs(procs);
 
-    route.updateAll();
+    route.updateChanged();
     route.updateAirwaysAndAltitude();
 
     // Force update of start if departure airport was removed
@@ -1901,7 +1915,12 @@ void RouteController::deleteSelectedLegs()
     updateFlightplanFromWidgets();
 
     route.updateActiveLegAndPos(true /* force update */);
-    updateTableModel();
+
+    // Deleted rows are shifted - pass row indexes after removal
+    QList<int> changedRows;
+    for(int i = 0; i < rows.size(); i++)
+      changedRows.append(rows.at(i) - (rows.size() - 1 - i));
+    updateTableModelRows(changedRows);
 
     // Update current position at the beginning of the former selection
     view->setCurrentIndex(model->index(firstRow, 0));
@@ -2246,11 +2265,12 @@ void RouteController::routeAddInternal(const FlightplanEntry& entry, int insertI
   routeLeg.createFromDatabaseByEntry(insertIndex, lastLeg);
 
   route.insert(insertIndex, routeLeg);
+  model->insertRow(insertIndex);
 
   proc::MapProcedureTypes procs = affectedProcedures({insertIndex});
   route.removeProcedureLegs(procs);
 
-  route.updateAll();
+  route.updateChanged();
   route.updateAirwaysAndAltitude();
   // Force update of start if departure airport was added
   updateStartPositionBestRunway(false /* force */, false /* undo */);
@@ -2259,7 +2279,7 @@ void RouteController::routeAddInternal(const FlightplanEntry& entry, int insertI
   updateFlightplanFromWidgets();
 
   route.updateActiveLegAndPos(true /* force update */);
-  updateTableModel();
+  updateTableModelRows({insertIndex});
 
   postChange(undoCommand);
   NavApp::updateWindowTitle();
@@ -2363,7 +2383,7 @@ void RouteController::routeReplace(int id, atools::geo::Pos userPos, map::MapObj
   if(legIndex == 0)
     route.removeProcedureLegs(proc::PROCEDURE_DEPARTURE);
 
-  route.updateAll();
+  route.updateChanged();
   route.updateAirwaysAndAltitude();
 
   // Force update of start if departure airport was changed
@@ -2374,7 +2394,7 @@ void RouteController::routeReplace(int id, atools::geo::Pos userPos, map::MapObj
   updateFlightplanFromWidgets();
 
   route.updateActiveLegAndPos(true /* force update */);
-  updateTableModel();
+  updateTableModelRows({legIndex});
 
   postChange(undoCommand);
   NavApp::updateWindowTitle();
@@ -2391,15 +2411,19 @@ void RouteController::routeDelete(int index)
   route.getFlightplan().getEntries().removeAt(index);
 
   route.removeAt(index);
+  model->removeRow(index);
   eraseAirway(index);
 
+  // Successor needs new distance and course
+  route.setLegChanged(index);
+
   if(index == route.size())
     route.removeProcedureLegs(proc::PROCEDURE_ARRIVAL_ALL);
 
   if(index == 0)
     route.removeProcedureLegs(proc::PROCEDURE_DEPARTURE);
 
-  route.updateAll();
+  route.updateChanged();
   route.updateAirwaysAndAltitude();
 
   // Force update of start if departure airport was removed
@@ -2408,7 +2432,7 @@ void RouteController::routeDelete(int index)
   // Get type and cruise altitude from widgets
   updateFlightplanFromWidgets();
 
-  updateTableModel();
+  updateTableModelRows({index});
 
   postChange(undoCommand);
   NavApp::updateWindowTitle();
@@ -2531,168 +2555,180 @@ QIcon RouteController::iconForLeg(const RouteLeg& leg, int size) const
 /* Update table view model completely */
 void RouteController::updateTableModel()
 {
-  Ui::MainWindow *ui = NavApp::getMainUi();
-
   model->removeRows(0, model->rowCount());
-  float totalDistance = route.getTotalDistance();
-
-  int row = 0;
-  float cumulatedDistance = 0.f;
 
   QList<QStandardItem *> itemRow;
-  for(int i = rc::FIRST_COLUMN; i <= rc::LAST_COLUMN; i++)
-    itemRow.append(nullptr);
-
   for(int i = 0; i < route.size(); i++)
   {
-    const RouteLeg& leg = route.at(i);
-    bool afterArrivalAirport = route.isAirportAfterArrival(i);
-
-    QStandardItem *ident = new QStandardItem(iconForLeg(leg, iconSize), leg.getIdent());
-    QFont f = ident->font();
-    f.setBold(true);
-    ident->setFont(f);
-    ident->setTextAlignment(Qt::AlignRight);
+    createTableRow(i, itemRow);
+    model->appendRow(itemRow);
+  }
 
-    if(leg.getMapObjectType() == map::INVALID)
-      ident->setForeground(Qt::red);
+  updateModelRouteDistances(0);
+  updateModelRouteTime();
+  updateTableModelWidgets();
+}
 
-    itemRow[rc::IDENT] = ident;
-    itemRow[rc::REGION] = new QStandardItem(leg.getRegion());
-    itemRow[rc::NAME] = new QStandardItem(leg.getName());
-    itemRow[rc::PROCEDURE] = new QStandardItem(proc::procedureTypeText(leg.getProcedureLeg()));
+void RouteController::updateTableModelRows(const QList<int>& changedRows)
+{
+  if(model->rowCount() != route.size())
+  {
+    // Legs were added or removed by procedure changes
+    updateTableModel();
+    return;
+  }
 
-    if(leg.isRoute())
+  // Neighbors of changed legs are affected by removed airways
+  QSet<int> rows;
+  for(int row : changedRows)
+  {
+    for(int i = row - 1; i <= row + 1; i++)
     {
-      itemRow[rc::AIRWAY_OR_LEGTYPE] = new QStandardItem(leg.getAirwayName());
-      if(leg.getAirway().isValid() && leg.getAirway().minAltitude > 0)
-        itemRow[rc::RESTRICTION] = new QStandardItem(Unit::altFeet(leg.getAirway().minAltitude, false));
+      if(i >= 0 && i < route.size())
+        rows.insert(i);
     }
-    else
-    {
-      itemRow[rc::AIRWAY_OR_LEGTYPE] = new QStandardItem(proc::procedureLegTypeStr(leg.getProcedureLegType()));
+  }
 
-      QString restrictions;
-      if(leg.getProcedureLeg().altRestriction.isValid())
-        restrictions.append(proc::altRestrictionTextShort(leg.getProcedureLeg().altRestriction));
-      if(leg.getProcedureLeg().speedRestriction.isValid())
-        restrictions.append("/" + proc::speedRestrictionTextShort(leg.getProcedureLeg().speedRestriction));
+  QList<QStandardItem *> itemRow;
+  int firstRow = route.size();
+  for(int row : rows)
+  {
+    createTableRow(row, itemRow);
+    for(int col = rc::FIRST_COLUMN; col <= rc::LAST_COLUMN; col++)
+      model->setItem(row, col, itemRow.at(col));
 
-      itemRow[rc::RESTRICTION] = new QStandardItem(restrictions);
-    }
+    if(row < firstRow)
+      firstRow = row;
+  }
 
-    // Get ILS for approach runway if it marks the end of an ILS procedure
-    QVector<map::MapIls> ilsByAirportAndRunway;
-    if((route.getArrivalLegs().approachType == "ILS" || route.getArrivalLegs().approachType == "LOC") &&
-       leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) && leg.getRunwayEnd().isValid())
-      ilsByAirportAndRunway = mapQuery->getIlsByAirportAndRunway(route.last().getAirport().ident,
-                                                                 leg.getRunwayEnd().name);
-
-    // VOR/NDB type ===========================
-    if(leg.getVor().isValid())
-      itemRow[rc::TYPE] = new QStandardItem(map::vorFullShortText(leg.getVor()));
-    else if(leg.getNdb().isValid())
-      itemRow[rc::TYPE] = new QStandardItem(map::ndbFullShortText(leg.getNdb()));
-    else if(leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) &&
-            leg.getRunwayEnd().isValid())
-    {
-      // Build string for ILS type
-      QStringList texts;
-      for(const map::MapIls& ils : ilsByAirportAndRunway)
-      {
-        QStringList txt(tr("ILS"));
-        if(ils.slope > 0.f)
-          txt.append("GS");
-        if(ils.hasDme)
-          txt.append("DME");
-        texts.append(txt.join("/"));
-      }
+  // Course and distance of the first changed row and all following might have changed
+  updateModelRouteDistances(firstRow);
+  updateModelRouteTime();
+  updateTableModelWidgets();
+}
 
-      itemRow[rc::TYPE] = new QStandardItem(texts.join(","));
-    }
+void RouteController::createTableRow(int index, QList<QStandardItem *>& itemRow)
+{
+  itemRow.clear();
+  for(int i = rc::FIRST_COLUMN; i <= rc::LAST_COLUMN; i++)
+    itemRow.append(nullptr);
 
-    // VOR/NDB frequency =====================
-    if(leg.getVor().isValid())
-    {
-      if(leg.getVor().tacan)
-        itemRow[rc::FREQ] = new QStandardItem(leg.getVor().channel);
-      else
-        itemRow[rc::FREQ] = new QStandardItem(QLocale().toString(leg.getFrequency() / 1000.f, 'f', 2));
-    }
-    else if(leg.getNdb().isValid())
-      itemRow[rc::FREQ] = new QStandardItem(QLocale().toString(leg.getFrequency() / 100.f, 'f', 1));
-    else if(leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) &&
-            leg.getRunwayEnd().isValid())
-    {
-      // Add ILS frequencies
-      QStringList texts;
-      for(const map::MapIls& ils : ilsByAirportAndRunway)
-        texts.append(QLocale().toString(ils.frequency / 1000.f, 'f', 2));
+  const RouteLeg& leg = route.at(index);
 
-      itemRow[rc::FREQ] = new QStandardItem(texts.join(","));
-    }
+  QStandardItem *ident = new QStandardItem(iconForLeg(leg, iconSize), leg.getIdent());
+  QFont f = ident->font();
+  f.setBold(true);
+  ident->setFont(f);
+  ident->setTextAlignment(Qt::AlignRight);
 
-    // VOR/NDB range =====================
-    if(leg.getRange() > 0 && (leg.getVor().isValid() || leg.getNdb().isValid()))
-      itemRow[rc::RANGE] = new QStandardItem(Unit::distNm(leg.getRange(), false));
+  if(leg.getMapObjectType() == map::INVALID)
+    ident->setForeground(Qt::red);
 
-    // Course =====================
-    if(row > 0 && !afterArrivalAirport)
-    {
-      if(leg.getCourseToMag() < map::INVALID_COURSE_VALUE)
-        itemRow[rc::COURSE] = new QStandardItem(QLocale().toString(leg.getCourseToMag(), 'f', 0));
-      if(leg.getCourseToRhumbMag() < map::INVALID_COURSE_VALUE)
-        itemRow[rc::DIRECT] = new QStandardItem(QLocale().toString(leg.getCourseToRhumbMag(), 'f', 0));
-    }
+  itemRow[rc::IDENT] = ident;
+  itemRow[rc::REGION] = new QStandardItem(leg.getRegion());
+  itemRow[rc::NAME] = new QStandardItem(leg.getName());
+  itemRow[rc::PROCEDURE] = new QStandardItem(proc::procedureTypeText(leg.getProcedureLeg()));
 
-    if(!afterArrivalAirport)
-    {
-      if(leg.getDistanceTo() < map::INVALID_DISTANCE_VALUE) // Distance =====================
-      {
-        cumulatedDistance += leg.getDistanceTo();
-        itemRow[rc::DIST] = new QStandardItem(Unit::distNm(leg.getDistanceTo(), false));
+  if(leg.isRoute())
+  {
+    itemRow[rc::AIRWAY_OR_LEGTYPE] = new QStandardItem(leg.getAirwayName());
+    if(leg.getAirway().isValid() && leg.getAirway().minAltitude > 0)
+      itemRow[rc::RESTRICTION] = new QStandardItem(Unit::altFeet(leg.getAirway().minAltitude, false));
+  }
+  else
+  {
+    itemRow[rc::AIRWAY_OR_LEGTYPE] = new QStandardItem(proc::procedureLegTypeStr(leg.getProcedureLegType()));
 
-        if(!leg.getProcedureLeg().isMissed())
-        {
-          float remaining = totalDistance - cumulatedDistance;
-          if(remaining < 0.f)
-            remaining = 0.f; // Catch the -0 case due to rounding errors
-          itemRow[rc::REMAINING_DISTANCE] = new QStandardItem(Unit::distNm(remaining, false));
-        }
-      }
-    }
+    QString restrictions;
+    if(leg.getProcedureLeg().altRestriction.isValid())
+      restrictions.append(proc::altRestrictionTextShort(leg.getProcedureLeg().altRestriction));
+    if(leg.getProcedureLeg().speedRestriction.isValid())
+      restrictions.append("/" + proc::speedRestrictionTextShort(leg.getProcedureLeg().speedRestriction));
 
-    if(leg.isAnyProcedure())
-      itemRow[rc::REMARKS] = new QStandardItem(proc::procedureLegRemark(leg.getProcedureLeg()));
+    itemRow[rc::RESTRICTION] = new QStandardItem(restrictions);
+  }
 
-    // Travel time and ETA are updated in updateModelRouteTime
+  // Get ILS for approach runway if it marks the end of an ILS procedure
+  QVector<map::MapIls> ilsByAirportAndRunway;
+  if((route.getArrivalLegs().approachType == "ILS" || route.getArrivalLegs().approachType == "LOC") &&
+     leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) && leg.getRunwayEnd().isValid())
+    ilsByAirportAndRunway = mapQuery->getIlsByAirportAndRunway(route.last().getAirport().ident,
+                                                               leg.getRunwayEnd().name);
 
-    // Create empty items for missing fields
-    for(int col = rc::FIRST_COLUMN; col <= rc::LAST_COLUMN; col++)
+  // VOR/NDB type ===========================
+  if(leg.getVor().isValid())
+    itemRow[rc::TYPE] = new QStandardItem(map::vorFullShortText(leg.getVor()));
+  else if(leg.getNdb().isValid())
+    itemRow[rc::TYPE] = new QStandardItem(map::ndbFullShortText(leg.getNdb()));
+  else if(leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) &&
+          leg.getRunwayEnd().isValid())
+  {
+    // Build string for ILS type
+    QStringList texts;
+    for(const map::MapIls& ils : ilsByAirportAndRunway)
     {
-      if(itemRow[col] == nullptr)
-        itemRow[col] = new QStandardItem();
-      itemRow[col]->setFlags(itemRow[col]->flags() &
-                             ~(Qt::ItemIsEditable | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled));
+      QStringList txt(tr("ILS"));
+      if(ils.slope > 0.f)
+        txt.append("GS");
+      if(ils.hasDme)
+        txt.append("DME");
+      texts.append(txt.join("/"));
     }
 
-    itemRow[rc::REMAINING_DISTANCE]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::DIST]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::COURSE]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::DIRECT]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::RANGE]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::FREQ]->setTextAlignment(Qt::AlignRight);
-    itemRow[rc::RESTRICTION]->setTextAlignment(Qt::AlignRight);
+    itemRow[rc::TYPE] = new QStandardItem(texts.join(","));
+  }
 
-    model->appendRow(itemRow);
+  // VOR/NDB frequency =====================
+  if(leg.getVor().isValid())
+  {
+    if(leg.getVor().tacan)
+      itemRow[rc::FREQ] = new QStandardItem(leg.getVor().channel);
+    else
+      itemRow[rc::FREQ] = new QStandardItem(QLocale().toString(leg.getFrequency() / 1000.f, 'f', 2));
+  }
+  else if(leg.getNdb().isValid())
+    itemRow[rc::FREQ] = new QStandardItem(QLocale().toString(leg.getFrequency() / 100.f, 'f', 1));
+  else if(leg.isAnyProcedure() && !(leg.getProcedureType() & proc::PROCEDURE_MISSED) &&
+          leg.getRunwayEnd().isValid())
+  {
+    // Add ILS frequencies
+    QStringList texts;
+    for(const map::MapIls& ils : ilsByAirportAndRunway)
+      texts.append(QLocale().toString(ils.frequency / 1000.f, 'f', 2));
 
-    for(int col = rc::FIRST_COLUMN; col <= rc::LAST_COLUMN; col++)
-      itemRow[col] = nullptr;
-    row++;
+    itemRow[rc::FREQ] = new QStandardItem(texts.join(","));
   }
 
-  updateModelRouteTime();
+  // VOR/NDB range =====================
+  if(leg.getRange() > 0 && (leg.getVor().isValid() || leg.getNdb().isValid()))
+    itemRow[rc::RANGE] = new QStandardItem(Unit::distNm(leg.getRange(), false));
+
+  if(leg.isAnyProcedure())
+    itemRow[rc::REMARKS] = new QStandardItem(proc::procedureLegRemark(leg.getProcedureLeg()));
 
+  // Course, distance, travel time and ETA are updated in updateModelRouteDistances and updateModelRouteTime
+
+  // Create empty items for missing fields
+  for(int col = rc::FIRST_COLUMN; col <= rc::LAST_COLUMN; col++)
+  {
+    if(itemRow[col] == nullptr)
+      itemRow[col] = new QStandardItem();
+    itemRow[col]->setFlags(itemRow[col]->flags() &
+                           ~(Qt::ItemIsEditable | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled));
+  }
+
+  itemRow[rc::REMAINING_DISTANCE]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::DIST]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::COURSE]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::DIRECT]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::RANGE]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::FREQ]->setTextAlignment(Qt::AlignRight);
+  itemRow[rc::RESTRICTION]->setTextAlignment(Qt::AlignRight);
+}
+
+void RouteController::updateTableModelWidgets()
+{
+  Ui::MainWindow *ui = NavApp::getMainUi();
   Flightplan& flightplan = route.getFlightplan();
 
   if(!flightplan.isEmpty())
@@ -2730,6 +2766,56 @@ void RouteController::updateTableModel()
   updateWindowLabel();
 }
 
+/* Update course and distance columns in table view model. Only remaining distance is updated for rows before
+ * fromRow since it depends on the total distance. */
+void RouteController::updateModelRouteDistances(int fromRow)
+{
+  float totalDistance = route.getTotalDistance();
+  float cumulatedDistance = 0.f;
+
+  for(int row = 0; row < route.size(); row++)
+  {
+    const RouteLeg& leg = route.at(row);
+    bool afterArrivalAirport = route.isAirportAfterArrival(row);
+    QString course, direct, dist, remaining;
+
+    // Course =====================
+    if(row > 0 && !afterArrivalAirport)
+    {
+      if(leg.getCourseToMag() < map::INVALID_COURSE_VALUE)
+        course = QLocale().toString(leg.getCourseToMag(), 'f', 0);
+      if(leg.getCourseToRhumbMag() < map::INVALID_COURSE_VALUE)
+        direct = QLocale().toString(leg.getCourseToRhumbMag(), 'f', 0);
+    }
+
+    if(!afterArrivalAirport)
+    {
+      if(leg.getDistanceTo() < map::INVALID_DISTANCE_VALUE) // Distance =====================
+      {
+        cumulatedDistance += leg.getDistanceTo();
+        dist = Unit::distNm(leg.getDistanceTo(), false);
+
+        if(!leg.getProcedureLeg().isMissed())
+        {
+          float remainingDist = totalDistance - cumulatedDistance;
+          if(remainingDist < 0.f)
+            remainingDist = 0.f; // Catch the -0 case due to rounding errors
+          remaining = Unit::distNm(remainingDist, false);
+        }
+      }
+    }
+
+    // Items are created by createTableRow
+    model->item(row, rc::REMAINING_DISTANCE)->setText(remaining);
+    if(row >= fromRow)
+    {
+      model->item(row, rc::COURSE)->setText(course);
+      model->item(row, rc::DIRECT)->setText(direct);
+      model->item(row, rc::DIST)->setText(dist);
+    }
+  }
+}
+
 /* Update travel times in table view model after speed change */
 void RouteController::updateModelRouteTime()
 {
@@ -2769,34 +2855,30 @@ void RouteController::disconnectedFromSimulator()
 
 void RouteController::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
-  if(atools::almostNotEqual(QDateTime::currentDateTime().toMSecsSinceEpoch(),
-                            lastSimUpdate, static_cast<qint64>(MIN_SIM_UPDATE_TIME_MS)))
+  // Update rate is limited by the SimDataDispatcher
+  if(simulatorData.isUserAircraftValid())
   {
-    if(simulatorData.isUserAircraftValid())
+    const atools::fs::sc::SimConnectUserAircraft& aircraft = simulatorData.getUserAircraft();
+
+    // Sequence only for airborne airplanes
+    // Use more than one parameter since first X-Plane data packets are unreliable
+    if(aircraft.isFlying())
     {
-      const atools::fs::sc::SimConnectUserAircraft& aircraft = simulatorData.getUserAircraft();
+      map::PosCourse position(aircraft.getPosition(), aircraft.getTrackDegTrue());
+      int previousRouteLeg = route.getActiveLegIndexCorrected();
+      route.updateActiveLegAndPos(position);
+      int routeLeg = route.getActiveLegIndexCorrected();
 
-      // Sequence only for airborne airplanes
-      // Use more than one parameter since first X-Plane data packets are unreliable
-      if(aircraft.isFlying())
+      if(routeLeg != previousRouteLeg)
       {
-        map::PosCourse position(aircraft.getPosition(), aircraft.getTrackDegTrue());
-        int previousRouteLeg = route.getActiveLegIndexCorrected();
-        route.updateActiveLegAndPos(position);
-        int routeLeg = route.getActiveLegIndexCorrected();
-
-        if(routeLeg != previousRouteLeg)
-        {
-          // Use corrected indexes to highlight initial fix
-          qDebug() << "new route leg" << previousRouteLeg << routeLeg;
-          highlightNextWaypoint(routeLeg);
+        // Use corrected indexes to highlight initial fix
+        qDebug() << "new route leg" << previousRouteLeg << routeLeg;
+        highlightNextWaypoint(routeLeg);
 
-          if(OptionData::instance().getFlags2() & opts::ROUTE_CENTER_ACTIVE_LEG)
-            view->scrollTo(model->index(std::max(routeLeg - 1, 0), 0), QAbstractItemView::PositionAtTop);
-        }
+        if(OptionData::instance().getFlags2() & opts::ROUTE_CENTER_ACTIVE_LEG)
+          view->scrollTo(model->index(std::max(routeLeg - 1, 0), 0), QAbstractItemView::PositionAtTop);
       }
     }
-    lastSimUpdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
   }
 }
 
@@ -67,6 +67,9 @@ class RouteController :
   Q_OBJECT
 
 public:
+  /* Do not update aircraft information more than every 0.1 seconds */
+  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 100;
+
   RouteController(QMainWindow *parent, QTableView *tableView);
   virtual ~RouteController();
 
@@ -297,8 +300,16 @@ private:
   void routeSetDepartureInternal(const map::MapAirport& airport);
   void routeSetDestinationInternal(const map::MapAirport& airport);
 
+  /* Rebuild the whole table model */
   void updateTableModel();
 
+  /* Update only the given rows and their neighbors, course and distance from the first changed row on
+   * as well as remaining distance and time columns for all rows.
+   * Rows for inserted or deleted legs have to be inserted or removed in the model before. */
+  void updateTableModelRows(const QList<int>& changedRows);
+  void createTableRow(int index, QList<QStandardItem *>& itemRow);
+  void updateTableModelWidgets();
+
   void routeAltChanged();
   void routeAltChangedDelayed();
   void routeSpeedChanged();
@@ -312,6 +323,7 @@ private:
                               bool fetchAirways, bool useSetAltitude, int fromIndex, int toIndex);
 
   void updateModelRouteTime();
+  void updateModelRouteDistances(int fromRow);
 
   void updateFlightplanFromWidgets(atools::fs::pln::Flightplan& flightplan);
   void updateFlightplanFromWidgets();
@@ -385,10 +397,7 @@ private:
   FlightplanEntryBuilder *entryBuilder = nullptr;
   atools::fs::pln::FlightplanIO *flightplanIO = nullptr;
 
-  /* Do not update aircraft information more than every 0.1 seconds */
-  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_TIME_MS = 100;
   static Q_DECL_CONSTEXPR int ROUTE_ALT_CHANGE_DELAY_MS = 1000;
-  qint64 lastSimUpdate = 0;
 
   QIcon ndbIcon, waypointIcon, userpointIcon, invalidIcon, procedureIcon;
   SymbolPainter *symbolPainter = nullptr;
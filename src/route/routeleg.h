@@ -246,6 +246,18 @@ public:
     index = value;
   }
 
+  /* Leg was created, changed or its predecessor changed. Magnetic variation, distance and course
+   * have to be updated. Cleared by Route::updateAll() and Route::updateChanged(). */
+  bool isChanged() const
+  {
+    return changed;
+  }
+
+  void setChanged(bool value = true)
+  {
+    changed = value;
+  }
+
   const proc::MapProcedureLeg& getProcedureLeg() const
   {
     return procedureLeg;
@@ -307,7 +319,7 @@ private:
   proc::MapProcedureLeg procedureLeg;
   map::MapAirway airway;
 
-  bool valid = false;
+  bool valid = false, changed = true;
 
   float distanceTo = 0.f,
         distanceToRhumb = 0.f,
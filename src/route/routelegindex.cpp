@@ -0,0 +1,139 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "route/routelegindex.h"
+
+#include "route/route.h"
+#include "geo/calculations.h"
+
+#include <algorithm>
+#include <cmath>
+
+using atools::geo::Pos;
+
+void RouteLegIndex::clear()
+{
+  numLegs = 0;
+  firstMissedLeg = 0;
+  distanceSumNm.clear();
+  cells.clear();
+}
+
+void RouteLegIndex::build(const Route& route)
+{
+  clear();
+  numLegs = route.size();
+  firstMissedLeg = numLegs;
+
+  float sum = 0.f;
+  distanceSumNm.reserve(numLegs);
+  for(int i = 0; i < numLegs; i++)
+  {
+    const RouteLeg& leg = route.at(i);
+    sum += leg.getDistanceTo();
+    distanceSumNm.append(sum);
+
+    if(firstMissedLeg == numLegs && leg.getProcedureLeg().isMissed())
+      firstMissedLeg = i;
+
+    if(i > 0)
+    {
+      // Add leg to all cells touched by the great circle line
+      const Pos& pos1 = route.getPositionAt(i - 1);
+      const Pos& pos2 = route.getPositionAt(i);
+      if(pos1.isValid() && pos2.isValid())
+      {
+        float distMeter = pos1.distanceMeterTo(pos2);
+        int steps = static_cast<int>(std::ceil(distMeter / SAMPLE_DISTANCE_METER));
+        for(int step = 0; step <= steps; step++)
+        {
+          Pos pos = steps > 0 ? pos1.interpolate(pos2, distMeter, static_cast<float>(step) / steps) : pos1;
+          insert(cellX(pos.getLonX()), cellY(pos.getLatY()), i);
+        }
+      }
+    }
+  }
+}
+
+float RouteLegIndex::getDistanceSumNm(int index, bool includeMissed) const
+{
+  if(!includeMissed && index >= firstMissedLeg)
+    index = firstMissedLeg - 1;
+
+  return index >= 0 && index < distanceSumNm.size() ? distanceSumNm.at(index) : 0.f;
+}
+
+bool RouteLegIndex::getCandidateLegs(const atools::geo::Pos& pos, QVector<int>& legs, float& guardMeter) const
+{
+  legs.clear();
+  guardMeter = 0.f;
+
+  if(!pos.isValid() || std::abs(pos.getLatY()) > MAX_LATITUDE)
+    return false;
+
+  int x = cellX(pos.getLonX()), y = cellY(pos.getLatY());
+
+  // Collect legs from cell and all neighbors
+  for(int dy = -1; dy <= 1; dy++)
+  {
+    for(int dx = -1; dx <= 1; dx++)
+    {
+      // Wrap around at the anti-meridian
+      int key = (y + dy) * NUM_CELLS_X + (x + dx + NUM_CELLS_X) % NUM_CELLS_X;
+      auto it = cells.constFind(key);
+      if(it != cells.constEnd())
+        legs.append(it.value());
+    }
+  }
+
+  if(legs.isEmpty())
+    return false;
+
+  std::sort(legs.begin(), legs.end());
+  legs.erase(std::unique(legs.begin(), legs.end()), legs.end());
+
+  // Minimum distance to the border of the cell block in north/south and east/west direction
+  float west = (x - 1) * CELL_SIZE_DEG - 180.f, south = (y - 1) * CELL_SIZE_DEG - 90.f;
+  float latDeg = std::min(pos.getLatY() - south, south + 3.f * CELL_SIZE_DEG - pos.getLatY());
+  float lonDeg = std::min(pos.getLonX() - west, west + 3.f * CELL_SIZE_DEG - pos.getLonX());
+  float lonDistDeg = atools::geo::toDegree(std::asin(std::cos(atools::geo::toRadians(pos.getLatY())) *
+                                                     std::sin(atools::geo::toRadians(lonDeg))));
+
+  // Lines between sampled positions can pass a neighbor cell
+  guardMeter = atools::geo::nmToMeter(std::min(latDeg, lonDistDeg) * 60.f) - SAMPLE_DISTANCE_METER / 2.f;
+  return guardMeter > 0.f;
+}
+
+int RouteLegIndex::cellX(float lonX)
+{
+  int x = static_cast<int>(std::floor((lonX + 180.f) / CELL_SIZE_DEG)) % NUM_CELLS_X;
+  return x < 0 ? x + NUM_CELLS_X : x;
+}
+
+int RouteLegIndex::cellY(float latY)
+{
+  return std::min(std::max(static_cast<int>(std::floor((latY + 90.f) / CELL_SIZE_DEG)), 0), NUM_CELLS_Y - 1);
+}
+
+void RouteLegIndex::insert(int x, int y, int leg)
+{
+  QVector<int>& legs = cells[y * NUM_CELLS_X + x];
+
+  // Positions are sampled in order - avoid duplicates for consecutive positions in the same cell
+  if(legs.isEmpty() || legs.last() != leg)
+    legs.append(leg);
+}
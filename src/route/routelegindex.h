@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_ROUTELEGINDEX_H
+#define LITTLENAVMAP_ROUTELEGINDEX_H
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+}
+
+class Route;
+
+/*
+ * Index for a route rebuilt on each update of the route legs. Contains the summed up leg distances
+ * and a grid of cells referencing all legs passing through a cell.
+ *
+ * Used to avoid iterating over all legs on each simulator update when looking for the nearest leg
+ * or calculating distances along the route.
+ */
+class RouteLegIndex
+{
+public:
+  /* Build from route. Distances of the route legs have to be updated before. */
+  void build(const Route& route);
+  void clear();
+
+  /* true if index was built for a route of the given size */
+  bool isValid(int routeSize) const
+  {
+    return routeSize > 0 && numLegs == routeSize;
+  }
+
+  /* Sum of leg distances in nm from start up to leg index inclusive.
+   * Sum stops before the first missed approach leg if includeMissed is false. */
+  float getDistanceSumNm(int index, bool includeMissed) const;
+
+  /* Get indexes of all legs passing the cells around pos. Index refers to the leg end.
+   * guardMeter is the minimum distance of all legs not returned to pos.
+   * @return false if the index cannot limit the legs for this position and all legs have to be checked. */
+  bool getCandidateLegs(const atools::geo::Pos& pos, QVector<int>& legs, float& guardMeter) const;
+
+private:
+  static int cellX(float lonX);
+  static int cellY(float latY);
+
+  void insert(int x, int y, int leg);
+
+  int numLegs = 0, firstMissedLeg = 0;
+
+  /* Summed up distance in nm for all legs up to index */
+  QVector<float> distanceSumNm;
+
+  /* Maps cell key to leg indexes */
+  QHash<int, QVector<int> > cells;
+
+  /* Cell size in degree */
+  static Q_DECL_CONSTEXPR float CELL_SIZE_DEG = 2.f;
+  static Q_DECL_CONSTEXPR int NUM_CELLS_X = 180;
+  static Q_DECL_CONSTEXPR int NUM_CELLS_Y = 90;
+
+  /* Maximum distance between positions along a leg inserted into the grid */
+  static Q_DECL_CONSTEXPR float SAMPLE_DISTANCE_METER = 50000.f;
+
+  /* Cells are too small near the poles - use full scan there */
+  static Q_DECL_CONSTEXPR float MAX_LATITUDE = 80.f;
+};
+
+#endif // LITTLENAVMAP_ROUTELEGINDEX_H
@@ -104,6 +104,18 @@ public:
     return idColumn;
   }
 
+  /* Column identifying a row across data reloads if ids change on each reload. Model keeps all rows in memory
+   * and updates only changed, added or removed ones on refresh if set. */
+  const QString& getKeyColumnName() const
+  {
+    return keyColumn;
+  }
+
+  void setKeyColumnName(const QString& value)
+  {
+    keyColumn = value;
+  }
+
   void updateUnits();
 
 private:
@@ -111,7 +123,7 @@ private:
   QString minDistanceWidgetSuffix, maxDistanceWidgetSuffix;
   QCheckBox *distanceCheckBox = nullptr;
   QComboBox *distanceDirectionWidget = nullptr;
-  QString table, idColumn;
+  QString table, idColumn, keyColumn;
   QVector<Column *> columns;
   QHash<QString, Column *> nameColumnMap;
 };
@@ -73,6 +73,9 @@ OnlineClientSearch::OnlineClientSearch(QMainWindow *parent, QTableView *tableVie
   append(Column("laty").hidden())
   ;
 
+  // Update table incrementally on each download - ids change but callsign is stable
+  columns->setKeyColumnName("callsign");
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseOnline());
 
   // Add model data handler and model format handler as callbacks
@@ -48,6 +48,9 @@ OnlineServerSearch::OnlineServerSearch(QMainWindow *parent, QTableView *tableVie
   append(Column("voice_type", tr("Voice\nType")))
   ;
 
+  // Update table incrementally on each download - ids change but ident is stable
+  columns->setKeyColumnName("ident");
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseOnline());
 
   // Add model data handler and model format handler as callbacks
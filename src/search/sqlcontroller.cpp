@@ -71,6 +71,13 @@ void SqlController::postDatabaseLoad()
 
 void SqlController::refreshData(bool loadAll, bool keepSelection)
 {
+  if(model->isIncremental())
+  {
+    // All rows are loaded and view keeps selection since model is not reset
+    model->refreshData();
+    return;
+  }
+
   QItemSelectionModel *sm = view->selectionModel();
 
   // Get all selected rows and highest selected row number
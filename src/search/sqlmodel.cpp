@@ -29,6 +29,7 @@
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QSqlError>
+#include <QSqlQuery>
 #include <QRegularExpression>
 #include <QComboBox>
 
@@ -78,7 +79,7 @@ void SqlModel::filterByRecord(const atools::sql::SqlRecord& record)
 void SqlModel::filterBy(QModelIndex index, bool exclude)
 {
   QString whereCol = getSqlRecord().fieldName(index.column());
-  filterBy(exclude, whereCol, QSqlQueryModel::data(index));
+  filterBy(exclude, whereCol, getRawData(index.row(), index.column()));
 }
 
 /* Simple include/exclude filter. Updates the attached search widgets */
@@ -608,18 +609,231 @@ QString SqlModel::buildWhereValue(const WhereCondition& cond)
 
 void SqlModel::refreshData()
 {
-  resetSqlQuery();
+  if(isIncremental())
+    updateRows();
+  else
+    resetSqlQuery();
   updateTotalCount();
 }
 
 void SqlModel::resetSqlQuery()
 {
+  if(isIncremental())
+  {
+    resetRows();
+    return;
+  }
+
   QSqlQueryModel::setQuery(currentSqlQuery, db->getQSqlDatabase());
 
   if(lastError().isValid())
     atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
 }
 
+bool SqlModel::isIncremental() const
+{
+  return !columns->getKeyColumnName().isEmpty();
+}
+
+bool SqlModel::loadRows(QVector<QVector<QVariant> >& newRows, QStringList& newKeys, QSqlRecord& newRecord)
+{
+  QSqlQuery query(db->getQSqlDatabase());
+  query.setForwardOnly(true);
+  if(!query.exec(currentSqlQuery))
+  {
+    atools::gui::ErrorHandler(parentWidget).handleSqlError(query.lastError());
+    return false;
+  }
+
+  newRecord = query.record();
+  int numCols = newRecord.count();
+  int keyIndex = newRecord.indexOf(columns->getKeyColumnName());
+
+  // Key might not be unique - count occurences to get a unique key
+  QHash<QString, int> keyCount;
+  while(query.next())
+  {
+    QVector<QVariant> row(numCols);
+    for(int i = 0; i < numCols; i++)
+      row[i] = query.value(i);
+    newRows.append(row);
+
+    QString key = keyIndex != -1 ? query.value(keyIndex).toString() : QString();
+    newKeys.append(key + "\t" + QString::number(keyCount[key]++));
+  }
+  return true;
+}
+
+void SqlModel::resetRows()
+{
+  QVector<QVector<QVariant> > newRows;
+  QStringList newKeys;
+  QSqlRecord newRecord;
+  loadRows(newRows, newKeys, newRecord);
+
+  beginResetModel();
+  rows.swap(newRows);
+  rowKeys.swap(newKeys);
+  rowRecord = newRecord;
+  endResetModel();
+}
+
+void SqlModel::updateRows()
+{
+  QVector<QVector<QVariant> > newRows;
+  QStringList newKeys;
+  QSqlRecord newRecord;
+  if(!loadRows(newRows, newKeys, newRecord))
+    return;
+
+  if(newRecord.count() != rowRecord.count())
+  {
+    // Columns changed - cannot update
+    beginResetModel();
+    rows.swap(newRows);
+    rowKeys.swap(newKeys);
+    rowRecord = newRecord;
+    endResetModel();
+    return;
+  }
+
+  QSet<QString> newKeySet, oldKeySet;
+  for(const QString& key : newKeys)
+    newKeySet.insert(key);
+
+  // Remove rows not found in the new result - ranges of rows at once from the end
+  for(int row = rows.size() - 1; row >= 0; row--)
+  {
+    if(!newKeySet.contains(rowKeys.at(row)))
+    {
+      int first = row;
+      while(first > 0 && !newKeySet.contains(rowKeys.at(first - 1)))
+        first--;
+
+      beginRemoveRows(QModelIndex(), first, row);
+      rows.remove(first, row - first + 1);
+      rowKeys.erase(rowKeys.begin() + first, rowKeys.begin() + row + 1);
+      endRemoveRows();
+      row = first;
+    }
+  }
+
+  // Remaining rows have to be in the same order as in the new result - can change if sorted by a changed column
+  for(const QString& key : rowKeys)
+    oldKeySet.insert(key);
+
+  QStringList commonKeys;
+  for(const QString& key : newKeys)
+  {
+    if(oldKeySet.contains(key))
+      commonKeys.append(key);
+  }
+
+  if(commonKeys != rowKeys)
+  {
+    emit layoutAboutToBeChanged();
+
+    QHash<QString, int> commonIndex;
+    for(int i = 0; i < commonKeys.size(); i++)
+      commonIndex.insert(commonKeys.at(i), i);
+
+    QVector<QVector<QVariant> > sortedRows(rows.size());
+    for(int i = 0; i < rows.size(); i++)
+      sortedRows[commonIndex.value(rowKeys.at(i))] = rows.at(i);
+
+    // Move selection and current index along with the rows
+    QModelIndexList from = persistentIndexList(), to;
+    for(const QModelIndex& idx : from)
+      to.append(createIndex(commonIndex.value(rowKeys.at(idx.row())), idx.column()));
+
+    rows.swap(sortedRows);
+    rowKeys = commonKeys;
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged();
+  }
+
+  // Insert new rows and update changed rows
+  int idIndex = newRecord.indexOf(columns->getIdColumnName());
+  for(int row = 0; row < newRows.size(); row++)
+  {
+    if(row >= rowKeys.size() || rowKeys.at(row) != newKeys.at(row))
+    {
+      // New row - insert range of new rows at once
+      int last = row;
+      while(last + 1 < newKeys.size() && !oldKeySet.contains(newKeys.at(last + 1)))
+        last++;
+
+      beginInsertRows(QModelIndex(), row, last);
+      for(int i = row; i <= last; i++)
+      {
+        rows.insert(i, newRows.at(i));
+        rowKeys.insert(i, newKeys.at(i));
+      }
+      endInsertRows();
+      row = last;
+    }
+    else
+    {
+      // Id changes with every reload - always copy row but notify only if other columns changed
+      bool changed = false;
+      for(int col = 0; col < newRecord.count() && !changed; col++)
+        changed = col != idIndex && rows.at(row).at(col) != newRows.at(row).at(col);
+
+      rows[row] = newRows.at(row);
+      if(changed)
+        emit dataChanged(index(row, 0), index(row, newRecord.count() - 1));
+    }
+  }
+  rowRecord = newRecord;
+}
+
+QVariant SqlModel::rowValue(int row, int col) const
+{
+  if(row >= 0 && row < rows.size() && col >= 0 && col < rows.at(row).size())
+    return rows.at(row).at(col);
+  else
+    return QVariant();
+}
+
+int SqlModel::rowCount(const QModelIndex& parent) const
+{
+  if(isIncremental())
+    return parent.isValid() ? 0 : rows.size();
+  else
+    return QSqlQueryModel::rowCount(parent);
+}
+
+int SqlModel::columnCount(const QModelIndex& parent) const
+{
+  if(isIncremental())
+    return parent.isValid() ? 0 : rowRecord.count();
+  else
+    return QSqlQueryModel::columnCount(parent);
+}
+
+bool SqlModel::canFetchMore(const QModelIndex& parent) const
+{
+  if(isIncremental())
+    // All rows are loaded
+    return false;
+  else
+    return QSqlQueryModel::canFetchMore(parent);
+}
+
+void SqlModel::clear()
+{
+  if(isIncremental())
+  {
+    beginResetModel();
+    rows.clear();
+    rowKeys.clear();
+    rowRecord.clear();
+    endResetModel();
+  }
+  QSqlQueryModel::clear();
+}
+
 Qt::SortOrder SqlModel::getSortOrder() const
 {
   return orderByOrder == "desc" ? Qt::DescendingOrder : Qt::AscendingOrder;
@@ -647,14 +861,19 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
   Qt::ItemDataRole dataRole = static_cast<Qt::ItemDataRole>(role);
 
   // Get the default value for this role. Can be a font, color, etc.
-  QVariant roleValue = QSqlQueryModel::data(index, role);
+  QVariant roleValue;
+  if(!isIncremental())
+    roleValue = QSqlQueryModel::data(index, role);
+  else if(role == Qt::DisplayRole || role == Qt::EditRole)
+    roleValue = rowValue(index.row(), index.column());
 
   if(handlerRoles.contains(dataRole))
   {
     // Callback wants to be called for this role
 
     // Get data to display
-    QVariant dataValue = QSqlQueryModel::data(index, Qt::DisplayRole);
+    QVariant dataValue = isIncremental() ? rowValue(index.row(), index.column()) :
+                         QSqlQueryModel::data(index, Qt::DisplayRole);
     QString col = getSqlRecord().fieldName(index.column());
     const Column *column = columns->getColumn(col);
 
@@ -672,6 +891,9 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 
 void SqlModel::fetchMore(const QModelIndex& parent)
 {
+  if(isIncremental())
+    return;
+
   QSqlQueryModel::fetchMore(parent);
   emit fetchedMore();
 }
@@ -688,6 +910,9 @@ void SqlModel::updateSqlQuery()
 
 QVariant SqlModel::getRawData(int row, int col) const
 {
+  if(isIncremental())
+    return rowValue(row, col);
+
   return QSqlQueryModel::data(createIndex(row, col));
 }
 
@@ -703,10 +928,21 @@ QVariant SqlModel::getFormattedFieldData(const QModelIndex& index) const
 
 atools::sql::SqlRecord SqlModel::getSqlRecord() const
 {
+  if(isIncremental())
+    return atools::sql::SqlRecord(rowRecord, currentSqlQuery);
+
   return atools::sql::SqlRecord(record(), currentSqlQuery);
 }
 
 atools::sql::SqlRecord SqlModel::getSqlRecord(int row) const
 {
+  if(isIncremental())
+  {
+    QSqlRecord rec(rowRecord);
+    for(int col = 0; col < rec.count(); col++)
+      rec.setValue(col, rowValue(row, col));
+    return atools::sql::SqlRecord(rec, currentSqlQuery);
+  }
+
   return atools::sql::SqlRecord(record(row), currentSqlQuery);
 }
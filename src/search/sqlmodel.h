@@ -23,6 +23,7 @@
 #include <functional>
 
 #include <QSqlQueryModel>
+#include <QSqlRecord>
 
 namespace atools {
 namespace sql {
@@ -37,6 +38,7 @@ class ColumnList;
 
 /*
  * Extends the QSqlQueryModel and adds query building based on filters and ordering.
+ * Keeps all rows in memory and updates them incrementally if the column list defines a key column.
  */
 class SqlModel :
   public QSqlQueryModel
@@ -160,9 +162,20 @@ public:
     return overrideModeActive;
   }
 
-  /* Update model after data change */
+  /* Update model after data change. Updates only changed, inserted and removed rows in incremental mode. */
   void refreshData();
 
+  /* True if the column list has a key column. All rows are kept in memory then and refreshData()
+   * emits dataChanged, rowsInserted and rowsRemoved instead of resetting the model.
+   * Filtering and sorting is still done by the SQL query. */
+  bool isIncremental() const;
+
+  /* Overloaded to serve data from memory in incremental mode */
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual bool canFetchMore(const QModelIndex& parent = QModelIndex()) const override;
+  virtual void clear() override;
+
 signals:
   /* Emitted when more data was fetched */
   void fetchedMore();
@@ -196,6 +209,18 @@ private:
                               const QVariant& displayRoleValue, Qt::ItemDataRole role) const;
   void updateTotalCount();
 
+  /* Incremental mode: run query and load all rows with their keys */
+  bool loadRows(QVector<QVector<QVariant> >& newRows, QStringList& newKeys, QSqlRecord& newRecord);
+
+  /* Incremental mode: reload all rows and reset model */
+  void resetRows();
+
+  /* Incremental mode: reload all rows and update changed ones only */
+  void updateRows();
+
+  /* Incremental mode: get raw value from memory */
+  QVariant rowValue(int row, int col) const;
+
   /* Default - all conditions are combined using "and" */
   const QString WHERE_OPERATOR = "and";
 
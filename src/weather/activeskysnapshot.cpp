@@ -0,0 +1,206 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "weather/activeskysnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+/* Separator between ident, METAR, TAF and other fields */
+static const char FIELD_SEPARATOR[] = "::";
+
+/* Avoid flooding the log for broken files */
+static const int MAX_INVALID_LINE_WARNINGS = 10;
+
+bool ActiveSkySnapshot::read(const QString& path)
+{
+  // ASN
+  // C:\Users\USER\AppData\Roaming\HiFi\ASNFSX\Weather\current_wx_snapshot.txt or wx_station_list.txt
+  // AS16
+  // C:\Users\USER\AppData\Roaming\HiFi\AS16_FSX\Weather\current_wx_snapshot.txt or wx_station_list.txt
+
+  // AGGH::AGGH 261800Z 20002KT 9999 FEW014 SCT027 25/24 Q1009::AGGH 261655Z 2618/2718 VRB03KT 9999 FEW017 SCT028 ...
+  // T 25 27 31 32 Q 1009 1011 1011 1009::278,11,24.0/267,12,19.0/263,13,16.1/233,12,7.2/290,7,-3.0/338,8,-13.0
+
+  QFileInfo fileInfo(path);
+  if(isSameFile(stamp, fileInfo))
+    return false;
+
+  QFile file(path);
+  if(!file.open(QIODevice::ReadOnly))
+  {
+    qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
+    return false;
+  }
+
+  qint64 fileSize = file.size();
+  bool changed = false;
+  if(fileSize == 0)
+  {
+    changed = updateStamp(stamp, fileInfo, nullptr, 0);
+    data.clear();
+  }
+  else
+  {
+    const uchar *mapped = file.map(0, fileSize);
+    if(mapped == nullptr)
+    {
+      qWarning() << "cannot map" << file.fileName() << "reason" << file.errorString();
+      return false;
+    }
+
+    const char *content = reinterpret_cast<const char *>(mapped);
+    changed = updateStamp(stamp, fileInfo, content, fileSize);
+
+    // Copy the content to release the mapping since it blocks Active Sky from replacing the file on Windows
+    if(changed)
+      data = QByteArray(content, static_cast<int>(fileSize));
+    file.unmap(const_cast<uchar *>(mapped));
+  }
+  file.close();
+
+  if(changed)
+    buildIndex(file.fileName());
+  else
+    qDebug() << Q_FUNC_INFO << path << "content not changed";
+
+  return changed;
+}
+
+void ActiveSkySnapshot::buildIndex(const QString& filename)
+{
+  entries.clear();
+
+  const char *begin = data.constData(), *end = begin + data.size();
+  const char *sepBegin = FIELD_SEPARATOR, *sepEnd = FIELD_SEPARATOR + std::strlen(FIELD_SEPARATOR);
+  int lineNum = 1, invalidLines = 0;
+
+  const char *line = begin;
+  while(line < end)
+  {
+    const char *lineEnd = static_cast<const char *>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+    if(lineEnd == nullptr)
+      lineEnd = end;
+
+    const char *contentEnd = lineEnd;
+    if(contentEnd > line && *(contentEnd - 1) == '\r')
+      contentEnd--;
+
+    if(contentEnd > line)
+    {
+      const char *identEnd = std::search(line, contentEnd, sepBegin, sepEnd);
+      if(identEnd != contentEnd)
+      {
+        const char *metarBegin = identEnd + (sepEnd - sepBegin);
+        const char *metarEnd = std::search(metarBegin, contentEnd, sepBegin, sepEnd);
+
+        Entry entry;
+        entry.identOffset = static_cast<int>(line - begin);
+        entry.identLength = static_cast<quint16>(std::min<qint64>(identEnd - line, 0xffff));
+        entry.metarOffset = static_cast<int>(metarBegin - begin);
+        entry.metarLength = static_cast<int>(metarEnd - metarBegin);
+        entries.append(entry);
+      }
+      else if(invalidLines++ < MAX_INVALID_LINE_WARNINGS)
+      {
+        qWarning() << "AS file" << filename << "has invalid entries";
+        qWarning() << "line #" << lineNum << QString::fromLatin1(line, static_cast<int>(contentEnd - line));
+      }
+    }
+
+    line = lineEnd + 1;
+    lineNum++;
+  }
+
+  // Keep file order for duplicates so that lookups can return the last one like the previous hash
+  std::stable_sort(entries.begin(), entries.end(), [this](const Entry& e1, const Entry& e2) -> bool
+  {
+    return compareIdent(e1, data.constData() + e2.identOffset, e2.identLength) < 0;
+  });
+
+  entries.squeeze();
+  qDebug() << Q_FUNC_INFO << filename << "entries" << entries.size() << "invalid lines" << invalidLines;
+}
+
+QString ActiveSkySnapshot::getMetar(const QString& ident) const
+{
+  QByteArray key = ident.toLatin1();
+
+  // Find first entry after ident and step back to get the last duplicate
+  auto it = std::upper_bound(entries.constBegin(), entries.constEnd(), key,
+                             [this](const QByteArray& k, const Entry& entry) -> bool
+  {
+    return compareIdent(entry, k.constData(), k.size()) > 0;
+  });
+
+  if(it != entries.constBegin())
+  {
+    const Entry& entry = *(it - 1);
+    if(compareIdent(entry, key.constData(), key.size()) == 0)
+      return QString::fromLatin1(data.constData() + entry.metarOffset, entry.metarLength);
+  }
+  return QString();
+}
+
+QStringList ActiveSkySnapshot::getAllMetars() const
+{
+  QStringList metars;
+  metars.reserve(entries.size());
+  for(const Entry& entry : entries)
+    metars.append(QString::fromLatin1(data.constData() + entry.metarOffset, entry.metarLength));
+  return metars;
+}
+
+void ActiveSkySnapshot::clear()
+{
+  data.clear();
+  entries.clear();
+  stamp = FileStamp();
+}
+
+int ActiveSkySnapshot::compareIdent(const Entry& entry, const char *ident, int identLength) const
+{
+  int cmp = std::memcmp(data.constData() + entry.identOffset, ident,
+                        static_cast<size_t>(std::min(static_cast<int>(entry.identLength), identLength)));
+  if(cmp != 0)
+    return cmp;
+  else
+    return static_cast<int>(entry.identLength) - identLength;
+}
+
+bool ActiveSkySnapshot::isSameFile(const FileStamp& fileStamp, const QFileInfo& fileInfo)
+{
+  return fileInfo.exists() && fileStamp.size == fileInfo.size() && fileStamp.lastModified == fileInfo.lastModified();
+}
+
+bool ActiveSkySnapshot::updateStamp(FileStamp& fileStamp, const QFileInfo& fileInfo, const char *content,
+                                    qint64 contentSize)
+{
+  QByteArray hash = QCryptographicHash::hash(QByteArray::fromRawData(content, static_cast<int>(contentSize)),
+                                             QCryptographicHash::Md5);
+  bool changed = hash != fileStamp.hash;
+
+  fileStamp.size = fileInfo.size();
+  fileStamp.lastModified = fileInfo.lastModified();
+  fileStamp.hash = hash;
+  return changed;
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef LITTLENAVMAP_ACTIVESKYSNAPSHOT_H
+#define LITTLENAVMAP_ACTIVESKYSNAPSHOT_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QStringList>
+#include <QVector>
+
+class QFileInfo;
+
+/*
+ * Keeps the METARs of an Active Sky weather snapshot file like "current_wx_snapshot.txt".
+ *
+ * The file is memory mapped and scanned once to build a sorted index of ident and METAR offsets into the
+ * raw data. METAR strings are only decoded on lookup. Reading is skipped if size, modification time and
+ * content hash of the file did not change.
+ */
+class ActiveSkySnapshot
+{
+public:
+  /* Size, modification time and hash of a file used to detect changes */
+  struct FileStamp
+  {
+    qint64 size = -1;
+    QDateTime lastModified;
+    QByteArray hash;
+  };
+
+  /*
+   * Read and index the snapshot file. Old data is kept if the file cannot be read.
+   * @return true if the file was read and the data has changed
+   */
+  bool read(const QString& path);
+
+  /* Get METAR for ident or empty string if not found */
+  QString getMetar(const QString& ident) const;
+
+  /* Get reports of all stations */
+  QStringList getAllMetars() const;
+
+  void clear();
+
+  bool isEmpty() const
+  {
+    return entries.isEmpty();
+  }
+
+  int size() const
+  {
+    return entries.size();
+  }
+
+  /* true if size and modification time of the file are the same as in the stamp */
+  static bool isSameFile(const FileStamp& fileStamp, const QFileInfo& fileInfo);
+
+  /* Update the stamp for the given file content. Returns true if the content hash has changed. */
+  static bool updateStamp(FileStamp& fileStamp, const QFileInfo& fileInfo, const char *content,
+                          qint64 contentSize);
+
+private:
+  /* Offsets into data for one line "IDENT::METAR::TAF::..." */
+  struct Entry
+  {
+    int identOffset, metarOffset, metarLength;
+    quint16 identLength;
+  };
+
+  void buildIndex(const QString& filename);
+
+  /* Compare ident of entry with the given Latin-1 ident */
+  int compareIdent(const Entry& entry, const char *ident, int identLength) const;
+
+  /* Copy of the file content - METARs are decoded from here on lookup */
+  QByteArray data;
+
+  /* Sorted by ident - duplicates are kept in file order */
+  QVector<Entry> entries;
+
+  FileStamp stamp;
+};
+
+#endif // LITTLENAVMAP_ACTIVESKYSNAPSHOT_H
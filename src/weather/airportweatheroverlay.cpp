@@ -0,0 +1,184 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "weather/airportweatheroverlay.h"
+
+#include "common/maptypes.h"
+#include "fs/weather/metarparser.h"
+#include "weather/metarcache.h"
+
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+using atools::fs::weather::INVALID_METAR_VALUE;
+
+AirportWeatherOverlay::AirportWeatherOverlay(WeatherReporter *parent)
+  : QObject(parent), reporter(parent)
+{
+  connect(&watcher, &QFutureWatcher<WeatherTable>::finished, this, &AirportWeatherOverlay::calculationFinished);
+}
+
+AirportWeatherOverlay::~AirportWeatherOverlay()
+{
+  future.waitForFinished();
+}
+
+void AirportWeatherOverlay::updateAirports(const QVector<const map::MapAirport *>& airports)
+{
+  QVector<int> ids;
+  QHash<int, QString> idents;
+  for(const map::MapAirport *airport : airports)
+  {
+    if(!airport->ident.isEmpty() && !idents.contains(airport->id))
+    {
+      ids.append(airport->id);
+      idents.insert(airport->id, airport->ident);
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+
+  if(ids == requestedIds && !weatherDirty)
+    // Nothing changed
+    return;
+
+  // Calculate only new airports if weather did not change and no full update is running or waiting
+  bool merge = !weatherDirty &&
+               !(calculating && !runningMerge) &&
+               !(requestPending && !pendingRequest.merge);
+
+  Request request;
+  request.merge = merge;
+  for(int id : ids)
+  {
+    if(!merge || !table.contains(id))
+    {
+      request.ids.append(id);
+      request.idents.append(idents.value(id));
+    }
+  }
+
+  requestedIds = ids;
+  weatherDirty = false;
+
+  if(merge && request.ids.isEmpty())
+    // Only airports removed from view
+    return;
+
+  pendingRequest = request;
+  requestPending = true;
+
+  if(!calculating)
+    startCalculation();
+}
+
+const AirportWeatherOverlay::AirportWeather *AirportWeatherOverlay::getWeather(int airportId) const
+{
+  auto it = table.constFind(airportId);
+  if(it != table.constEnd() &&
+     (it->category != metar::UNKNOWN || it->windSpeedKts < INVALID_METAR_VALUE))
+    return &it.value();
+
+  return nullptr;
+}
+
+void AirportWeatherOverlay::weatherChanged()
+{
+  weatherDirty = true;
+
+  // Let the map call updateAirports again
+  emit overlayUpdated();
+}
+
+void AirportWeatherOverlay::startCalculation()
+{
+  calculating = true;
+  runningMerge = pendingRequest.merge;
+  requestPending = false;
+
+  Request request = pendingRequest;
+  QVector<WeatherReporter::MetarLookup> lookups = reporter->getMetarLookups();
+  MetarCache *cache = reporter->getMetarCache();
+
+  future = QtConcurrent::run([request, lookups, cache]() -> WeatherTable
+  {
+    return calculate(request, lookups, cache);
+  });
+  watcher.setFuture(future);
+}
+
+void AirportWeatherOverlay::calculationFinished()
+{
+  WeatherTable result = future.result();
+  calculating = false;
+
+  if(runningMerge)
+  {
+    for(auto it = result.constBegin(); it != result.constEnd(); ++it)
+      table.insert(it.key(), it.value());
+  }
+  else
+    table = result;
+
+  // Remove airports which are not visible anymore
+  for(auto it = table.begin(); it != table.end();)
+  {
+    if(std::binary_search(requestedIds.constBegin(), requestedIds.constEnd(), it.key()))
+      ++it;
+    else
+      it = table.erase(it);
+  }
+
+  emit overlayUpdated();
+
+  if(requestPending)
+    startCalculation();
+}
+
+AirportWeatherOverlay::WeatherTable AirportWeatherOverlay::calculate(const Request& request,
+                                                                     const QVector<WeatherReporter::MetarLookup>&
+                                                                     lookups, MetarCache *cache)
+{
+  WeatherTable result;
+  result.reserve(request.ids.size());
+
+  for(int i = 0; i < request.ids.size(); i++)
+  {
+    // Airports without weather are added too to avoid looking them up again when merging
+    AirportWeather weather = {metar::UNKNOWN, INVALID_METAR_VALUE, INVALID_METAR_VALUE};
+
+    // Use first source in order of priority having a valid report
+    for(const WeatherReporter::MetarLookup& lookup : lookups)
+    {
+      QString metarString = lookup.second(request.idents.at(i));
+      if(metarString.isEmpty())
+        continue;
+
+      metar::MetarSummary summary = cache->getSummary(lookup.first, metarString, metar::simFormat(lookup.first));
+      if(summary.valid)
+      {
+        weather.category = summary.flightCategory;
+        weather.windDirDeg = summary.windDirDeg;
+        weather.windSpeedKts = summary.windSpeedKts;
+        break;
+      }
+    }
+    result.insert(request.ids.at(i), weather);
+  }
+  return result;
+}
@@ -0,0 +1,117 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_AIRPORTWEATHEROVERLAY_H
+#define LITTLENAVMAP_AIRPORTWEATHEROVERLAY_H
+
+#include "weather/weatherreporter.h"
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+namespace map {
+struct MapAirport;
+}
+
+class WeatherReporter;
+
+/*
+ * Keeps a compact table of flight category and wind for all airports visible on the map.
+ *
+ * The map painter passes the visible airports on each frame. The table is recalculated in a background thread
+ * only if the visible set or the weather has changed. Reports are taken from the in-memory sources of the
+ * weather reporter and decoded through the METAR cache. Sources needing requests for single stations are not
+ * used to avoid flooding the network while panning.
+ *
+ * The painter uses the last finished table. overlayUpdated is emitted when a new table is available.
+ */
+class AirportWeatherOverlay :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  /* Weather for one airport. Wind values are INVALID_METAR_VALUE if not available. */
+  struct AirportWeather
+  {
+    metar::FlightCategory category;
+    float windDirDeg, windSpeedKts;
+  };
+
+  explicit AirportWeatherOverlay(WeatherReporter *parent);
+  virtual ~AirportWeatherOverlay();
+
+  /* Pass all airports visible on the map. Starts a background update if the set has changed. */
+  void updateAirports(const QVector<const map::MapAirport *>& airports);
+
+  /* Get weather for airport or null if not available or not yet calculated */
+  const AirportWeather *getWeather(int airportId) const;
+
+  /* Weather has changed - recalculate all airports on next call of updateAirports */
+  void weatherChanged();
+
+signals:
+  /* A new table is available or weather changed. Map has to be redrawn. */
+  void overlayUpdated();
+
+private:
+  typedef QHash<int, AirportWeather> WeatherTable;
+
+  /* Airport ident is copied since the map query cache can change while the job is running */
+  struct Request
+  {
+    QVector<int> ids;
+    QStringList idents;
+    bool merge;
+  };
+
+  void startCalculation();
+  void calculationFinished();
+
+  /* Runs in background thread */
+  static WeatherTable calculate(const Request& request, const QVector<WeatherReporter::MetarLookup>& lookups,
+                                MetarCache *cache);
+
+  WeatherReporter *reporter;
+
+  /* Last finished result */
+  WeatherTable table;
+
+  /* Sorted ids of the last requested set of airports */
+  QVector<int> requestedIds;
+
+  /* Latest request not yet started */
+  Request pendingRequest;
+  bool requestPending = false;
+
+  /* Set by weatherChanged. Forces a full recalculation instead of calculating only new airports. */
+  bool weatherDirty = true;
+
+  /* Set from start of the job until its result is taken. future.isRunning() cannot be used since the job might be
+   * finished while the finished signal is still pending. */
+  bool calculating = false;
+
+  /* Merge flag of the running job */
+  bool runningMerge = false;
+
+  QFuture<WeatherTable> future;
+  QFutureWatcher<WeatherTable> watcher;
+};
+
+#endif // LITTLENAVMAP_AIRPORTWEATHEROVERLAY_H
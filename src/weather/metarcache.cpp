@@ -0,0 +1,216 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include "weather/metarcache.h"
+
+#include "fs/weather/metar.h"
+#include "fs/weather/metarparser.h"
+#include "geo/calculations.h"
+
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+using atools::fs::weather::Metar;
+using atools::fs::weather::INVALID_METAR_VALUE;
+
+/* Statute mile in meter for flight category visibility limits */
+static const float STATUTE_MILE_METER = 1609.344f;
+
+namespace metar {
+
+FlightCategory flightCategory(float ceilingFt, float visibilityMeter)
+{
+  bool hasCeiling = ceilingFt < INVALID_METAR_VALUE;
+  bool hasVisibility = visibilityMeter < INVALID_METAR_VALUE;
+
+  if(!hasCeiling && !hasVisibility)
+    return UNKNOWN;
+
+  // No ceiling means unlimited - use the worse of both
+  float visSm = hasVisibility ? visibilityMeter / STATUTE_MILE_METER : INVALID_METAR_VALUE;
+  if((hasCeiling && ceilingFt < 500.f) || visSm < 1.f)
+    return LIFR;
+  else if((hasCeiling && ceilingFt < 1000.f) || visSm < 3.f)
+    return IFR;
+  else if((hasCeiling && ceilingFt <= 3000.f) || visSm <= 5.f)
+    return MVFR;
+  else
+    return VFR;
+}
+
+}
+
+MetarCache::MetarCache()
+{
+  summaries.setMaxCost(ADDITIONAL_SUMMARIES);
+  metars.setMaxCost(MAX_METARS);
+}
+
+MetarCache::~MetarCache()
+{
+  for(QFuture<void>& future : futures)
+    future.waitForFinished();
+}
+
+QSharedPointer<const Metar> MetarCache::getMetar(metar::Source source, const QString& metarString,
+                                                 const QString& station, const QDateTime& timestamp,
+                                                 bool simFormat)
+{
+  Key key({source, simFormat, metarString, station, timestamp});
+  {
+    QMutexLocker locker(&mutex);
+    QSharedPointer<const Metar> *cached = metars.object(key);
+    if(cached != nullptr)
+      return *cached;
+  }
+
+  // Decode outside of the lock to keep lookups from other threads fast
+  QSharedPointer<const Metar> metar(new Metar(metarString, station, timestamp, simFormat));
+  metar::MetarSummary *newSummary = new metar::MetarSummary(summary(*metar));
+
+  QMutexLocker locker(&mutex);
+  metars.insert(key, new QSharedPointer<const Metar>(metar));
+
+  // Summary does not depend on station and timestamp
+  Key summaryKey({source, simFormat, metarString, QString(), QDateTime()});
+  if(!summaries.contains(summaryKey))
+    summaries.insert(summaryKey, newSummary);
+  else
+    delete newSummary;
+  return metar;
+}
+
+metar::MetarSummary MetarCache::getSummary(metar::Source source, const QString& metarString, bool simFormat)
+{
+  Key key({source, simFormat, metarString, QString(), QDateTime()});
+  {
+    QMutexLocker locker(&mutex);
+    metar::MetarSummary *cached = summaries.object(key);
+    if(cached != nullptr)
+      return *cached;
+  }
+
+  metar::MetarSummary retval = summary(Metar(metarString, QString(), QDateTime(), simFormat));
+
+  QMutexLocker locker(&mutex);
+  summaries.insert(key, new metar::MetarSummary(retval));
+  return retval;
+}
+
+void MetarCache::decodeMetars(metar::Source source, const QStringList& metarStrings, bool simFormat)
+{
+  {
+    // Grow cache before inserting to avoid evicting the reports of this or other sources
+    QMutexLocker locker(&mutex);
+    sourceSizes.insert(source, metarStrings.size());
+    updateMaxSummaries();
+  }
+
+  int decoded = 0;
+  for(const QString& metarString : metarStrings)
+  {
+    Key key({source, simFormat, metarString, QString(), QDateTime()});
+
+    {
+      QMutexLocker locker(&mutex);
+      if(summaries.contains(key))
+        continue;
+    }
+
+    // Decode outside of the lock to keep lookups from the GUI thread fast
+    metar::MetarSummary *newSummary =
+      new metar::MetarSummary(summary(Metar(metarString, QString(), QDateTime(), simFormat)));
+
+    QMutexLocker locker(&mutex);
+    summaries.insert(key, newSummary);
+    decoded++;
+  }
+  qDebug() << Q_FUNC_INFO << "source" << source << "reports" << metarStrings.size() << "decoded" << decoded;
+}
+
+void MetarCache::decodeMetarsBackground(metar::Source source, const QStringList& metarStrings, bool simFormat)
+{
+  // Remove finished
+  for(int i = futures.size() - 1; i >= 0; i--)
+  {
+    if(futures.at(i).isFinished())
+      futures.removeAt(i);
+  }
+
+  futures.append(QtConcurrent::run(this, &MetarCache::decodeMetars, source, metarStrings, simFormat));
+}
+
+void MetarCache::clear()
+{
+  QMutexLocker locker(&mutex);
+  summaries.clear();
+  metars.clear();
+}
+
+void MetarCache::updateMaxSummaries()
+{
+  int size = ADDITIONAL_SUMMARIES;
+  for(int sourceSize : sourceSizes)
+    size += sourceSize;
+  summaries.setMaxCost(size);
+}
+
+metar::MetarSummary MetarCache::summary(const Metar& metar)
+{
+  const atools::fs::weather::MetarParser& parsed = metar.getParsedMetar();
+  metar::MetarSummary summary;
+  summary.valid = parsed.isValid();
+  summary.windDirDeg = summary.windSpeedKts = summary.gustSpeedKts = summary.visibilityMeter =
+    summary.ceilingFt = INVALID_METAR_VALUE;
+
+  if(summary.valid)
+  {
+    // Wind ==============================
+    if(parsed.getWindDir() >= 0)
+      summary.windDirDeg = parsed.getWindDir();
+    if(parsed.getWindSpeedMeterPerSec() < INVALID_METAR_VALUE)
+      summary.windSpeedKts = atools::geo::meterToNm(parsed.getWindSpeedMeterPerSec() * 3600.f);
+    if(parsed.getGustSpeedMeterPerSec() < INVALID_METAR_VALUE)
+      summary.gustSpeedKts = atools::geo::meterToNm(parsed.getGustSpeedMeterPerSec() * 3600.f);
+
+    // Visibility ==============================
+    if(parsed.getCavok())
+      // Ten kilometers or more
+      summary.visibilityMeter = 10000.f;
+    else if(parsed.getMinVisibility().getVisibilityMeter() < INVALID_METAR_VALUE)
+      summary.visibilityMeter = parsed.getMinVisibility().getVisibilityMeter();
+
+    // Ceiling is the lowest broken or overcast layer or vertical visibility ======================
+    for(const atools::fs::weather::MetarCloud& cloud : parsed.getClouds())
+    {
+      if((cloud.getCoverage() == atools::fs::weather::MetarCloud::COVERAGE_BROKEN ||
+          cloud.getCoverage() == atools::fs::weather::MetarCloud::COVERAGE_OVERCAST) &&
+         cloud.getAltitudeMeter() < INVALID_METAR_VALUE)
+        summary.ceilingFt = std::min(summary.ceilingFt, atools::geo::meterToFeet(cloud.getAltitudeMeter()));
+    }
+
+    float vertVisMeter = parsed.getVertVisibility().getVisibilityMeter();
+    if(vertVisMeter < INVALID_METAR_VALUE)
+      summary.ceilingFt = std::min(summary.ceilingFt, atools::geo::meterToFeet(vertVisMeter));
+
+    summary.flightCategory = metar::flightCategory(summary.ceilingFt, summary.visibilityMeter);
+  }
+  return summary;
+}
@@ -0,0 +1,151 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef LITTLENAVMAP_METARCACHE_H
+#define LITTLENAVMAP_METARCACHE_H
+
+#include "weather/metartypes.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+
+namespace atools {
+namespace fs {
+namespace weather {
+class Metar;
+}
+}
+}
+
+namespace metar {
+
+/* Compact summary of a decoded report. All values are INVALID_METAR_VALUE if not available. */
+struct MetarSummary
+{
+  bool valid = false;
+  float windDirDeg, windSpeedKts, gustSpeedKts, visibilityMeter, ceilingFt;
+  FlightCategory flightCategory = UNKNOWN;
+};
+
+/* Calculate flight category from ceiling and visibility */
+FlightCategory flightCategory(float ceilingFt, float visibilityMeter);
+
+/* Format flag passed to the Metar constructor for reports of the source. Interpolated simulator
+ * reports are the only exception. */
+inline bool simFormat(Source source)
+{
+  return source == SIMULATOR || source == NOAA || source == IVAO;
+}
+
+}
+
+/*
+ * Thread safe cache of decoded METAR reports.
+ *
+ * Keeps two caches: Summaries are keyed by source, report format and the raw report text and are shared by all
+ * requests. Full decoded reports are additionally keyed by station and timestamp since the Metar object keeps both.
+ *
+ * Bulk weather sources decode summaries for all new reports on their worker threads once data arrives. This avoids
+ * parsing thousands of reports on the GUI thread when the airport weather overlay is updated. The summary cache
+ * grows with the size of the indexes passed to decodeMetars() so that pre-decoded reports are not evicted by the
+ * next source.
+ *
+ * Reports which are not in the cache are decoded on first access and inserted.
+ * Returned objects are shared and stay valid even if evicted from the cache.
+ */
+class MetarCache
+{
+public:
+  MetarCache();
+  ~MetarCache();
+
+  /*
+   * Get decoded report. Decodes and inserts report if not found.
+   * Station and timestamp are passed to the Metar constructor and are part of the key.
+   * @param simFormat passed to the Metar constructor
+   */
+  QSharedPointer<const atools::fs::weather::Metar> getMetar(metar::Source source, const QString& metarString,
+                                                            const QString& station = QString(),
+                                                            const QDateTime& timestamp = QDateTime(),
+                                                            bool simFormat = false);
+
+  /* Get summary for report. Decodes and inserts summary if not found. */
+  metar::MetarSummary getSummary(metar::Source source, const QString& metarString, bool simFormat = false);
+
+  /* Decode summaries for all reports not in the cache in the calling thread.
+   * The reports replace the previous list for source when sizing the cache. */
+  void decodeMetars(metar::Source source, const QStringList& metarStrings, bool simFormat);
+
+  /* Same as decodeMetars but runs in a background thread */
+  void decodeMetarsBackground(metar::Source source, const QStringList& metarStrings, bool simFormat);
+
+  void clear();
+
+  /* Summaries kept in addition to the sum of all bulk source sizes */
+  static Q_DECL_CONSTEXPR int ADDITIONAL_SUMMARIES = 5000;
+
+  /* Maximum number of full decoded reports. These are only needed for the information panel and tooltips. */
+  static Q_DECL_CONSTEXPR int MAX_METARS = 1000;
+
+private:
+  struct Key
+  {
+    metar::Source source;
+    bool simFormat;
+    QString metar;
+
+    /* Empty for summaries */
+    QString station;
+    QDateTime timestamp;
+
+    bool operator==(const Key& other) const
+    {
+      return source == other.source && simFormat == other.simFormat && metar == other.metar &&
+             station == other.station && timestamp == other.timestamp;
+    }
+
+    friend uint qHash(const Key& key)
+    {
+      return qHash(key.metar) ^ qHash(key.station) ^ (static_cast<uint>(key.source) << 1) ^
+             static_cast<uint>(key.simFormat);
+    }
+  };
+
+  /* Build summary from decoded report - thread safe */
+  static metar::MetarSummary summary(const atools::fs::weather::Metar& metar);
+
+  /* Adjust maximum size of summary cache to the sum of all source sizes - call with mutex locked */
+  void updateMaxSummaries();
+
+  QCache<Key, metar::MetarSummary> summaries;
+  QCache<Key, QSharedPointer<const atools::fs::weather::Metar> > metars;
+  mutable QMutex mutex;
+
+  /* Number of reports in last decodeMetars() call for each source */
+  QHash<metar::Source, int> sourceSizes;
+
+  /* Running background decoding - waited for in destructor */
+  QList<QFuture<void> > futures;
+};
+
+#endif // LITTLENAVMAP_METARCACHE_H
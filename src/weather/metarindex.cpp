@@ -0,0 +1,241 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "weather/metarindex.h"
+
+#include "fs/weather/weathertypes.h"
+#include "geo/calculations.h"
+
+#include <QRegularExpression>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/* Date line in NOAA cycle files and X-Plane METAR.rwx like "2018/02/09 03:06" */
+static const QRegularExpression DATE_LINE_REGEXP("^\\d{4}/\\d{2}/\\d{2}\\s+\\d{2}:\\d{2}$");
+static const QRegularExpression IDENT_REGEXP("^[A-Z0-9]{3,4}$");
+
+/* Half a month in minutes. Used to detect month changes when comparing report times. */
+static const int HALF_MONTH_MINUTES = 15 * 24 * 60;
+
+MetarIndex::MetarIndex()
+{
+
+}
+
+MetarIndex::~MetarIndex()
+{
+
+}
+
+void MetarIndex::read(const QByteArray& data)
+{
+  QTextStream stream(data);
+  stream.setCodec("UTF-8");
+
+  QString line;
+  while(stream.readLineInto(&line))
+  {
+    line = line.simplified();
+    if(line.isEmpty() || DATE_LINE_REGEXP.match(line).hasMatch())
+      continue;
+
+    if(line.startsWith("METAR ") || line.startsWith("SPECI "))
+      line = line.mid(6);
+
+    QString ident = line.section(' ', 0, 0).toUpper();
+    if(!IDENT_REGEXP.match(ident).hasMatch())
+      continue;
+
+    int timeKey = reportTimeKey(line.section(' ', 1, 1));
+
+    int index = stationIndex.value(ident, -1);
+    if(index == -1)
+    {
+      stationIndex.insert(ident, stations.size());
+      stations.append({ident, line, timeKey});
+    }
+    else
+    {
+      // Keep newer report - consider change of month
+      Station& station = stations[index];
+      int diff = timeKey - station.timeKey;
+      if(timeKey == -1 || station.timeKey == -1 || (diff >= 0 && diff < HALF_MONTH_MINUTES) ||
+         diff < -HALF_MONTH_MINUTES)
+      {
+        station.metar = line;
+        station.timeKey = timeKey;
+      }
+    }
+  }
+}
+
+void MetarIndex::buildIndex(const QHash<QString, atools::geo::Pos>& airportCoordinates)
+{
+  tree.clear();
+  tree.reserve(stations.size());
+
+  for(int i = 0; i < stations.size(); i++)
+  {
+    QHash<QString, atools::geo::Pos>::const_iterator it = airportCoordinates.constFind(stations.at(i).ident);
+    if(it != airportCoordinates.constEnd() && it.value().isValid())
+    {
+      TreeNode node;
+      toVector(it.value(), node.coord);
+      node.stationIndex = i;
+      tree.append(node);
+    }
+  }
+
+  buildTree(0, tree.size(), 0);
+}
+
+void MetarIndex::clear()
+{
+  stations.clear();
+  stationIndex.clear();
+  tree.clear();
+  timestamp = QDateTime();
+}
+
+atools::fs::weather::MetarResult MetarIndex::getMetar(const QString& station, const atools::geo::Pos& pos) const
+{
+  atools::fs::weather::MetarResult result;
+  result.requestIdent = station;
+  result.requestPos = pos;
+  result.timestamp = timestamp;
+
+  int index = stationIndex.value(station, -1);
+  if(index != -1)
+    result.metarForStation = stations.at(index).metar;
+  else if(pos.isValid())
+  {
+    index = nearestIndex(pos);
+    if(index != -1)
+      result.metarForNearest = stations.at(index).metar;
+  }
+  return result;
+}
+
+QString MetarIndex::getMetarString(const QString& station) const
+{
+  int index = stationIndex.value(station, -1);
+  return index != -1 ? stations.at(index).metar : QString();
+}
+
+QString MetarIndex::getNearestStation(const atools::geo::Pos& pos) const
+{
+  int index = nearestIndex(pos);
+  return index != -1 ? stations.at(index).ident : QString();
+}
+
+QStringList MetarIndex::getAllMetars() const
+{
+  QStringList metars;
+  metars.reserve(stations.size());
+  for(const Station& station : stations)
+    metars.append(station.metar);
+  return metars;
+}
+
+int MetarIndex::nearestIndex(const atools::geo::Pos& pos) const
+{
+  if(tree.isEmpty() || !pos.isValid())
+    return -1;
+
+  float point[3];
+  toVector(pos, point);
+
+  int bestIndex = -1;
+  float bestDistance = std::numeric_limits<float>::max();
+  nearest(0, tree.size(), 0, point, bestIndex, bestDistance);
+  return bestIndex;
+}
+
+void MetarIndex::buildTree(int begin, int end, int depth)
+{
+  if(end - begin < 2)
+    return;
+
+  int axis = depth % 3;
+  int median = (begin + end) / 2;
+  std::nth_element(tree.begin() + begin, tree.begin() + median, tree.begin() + end,
+                   [axis](const TreeNode& node1, const TreeNode& node2) -> bool
+  {
+    return node1.coord[axis] < node2.coord[axis];
+  });
+
+  buildTree(begin, median, depth + 1);
+  buildTree(median + 1, end, depth + 1);
+}
+
+void MetarIndex::nearest(int begin, int end, int depth, const float point[3], int& bestIndex,
+                         float& bestDistance) const
+{
+  if(begin >= end)
+    return;
+
+  int median = (begin + end) / 2;
+  const TreeNode& node = tree.at(median);
+
+  // Squared chord distance is monotonic to great circle distance
+  float dx = node.coord[0] - point[0], dy = node.coord[1] - point[1], dz = node.coord[2] - point[2];
+  float distance = dx * dx + dy * dy + dz * dz;
+  if(distance < bestDistance)
+  {
+    bestDistance = distance;
+    bestIndex = node.stationIndex;
+  }
+
+  // Descend into the side containing the point first and into the other only if it can contain a closer node
+  float diff = point[depth % 3] - node.coord[depth % 3];
+  if(diff < 0.f)
+  {
+    nearest(begin, median, depth + 1, point, bestIndex, bestDistance);
+    if(diff * diff < bestDistance)
+      nearest(median + 1, end, depth + 1, point, bestIndex, bestDistance);
+  }
+  else
+  {
+    nearest(median + 1, end, depth + 1, point, bestIndex, bestDistance);
+    if(diff * diff < bestDistance)
+      nearest(begin, median, depth + 1, point, bestIndex, bestDistance);
+  }
+}
+
+void MetarIndex::toVector(const atools::geo::Pos& pos, float vector[3])
+{
+  float lon = atools::geo::toRadians(pos.getLonX()), lat = atools::geo::toRadians(pos.getLatY());
+  vector[0] = std::cos(lat) * std::cos(lon);
+  vector[1] = std::cos(lat) * std::sin(lon);
+  vector[2] = std::sin(lat);
+}
+
+int MetarIndex::reportTimeKey(const QString& timeField)
+{
+  // 091850Z
+  if(timeField.size() == 7 && timeField.endsWith('Z'))
+  {
+    bool ok;
+    int value = timeField.left(6).toInt(&ok);
+    if(ok)
+      return (value / 10000) * 24 * 60 + (value / 100 % 100) * 60 + value % 100;
+  }
+  return -1;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_METARINDEX_H
+#define LITTLENAVMAP_METARINDEX_H
+
+#include "geo/pos.h"
+
+#include <QDateTime>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace weather {
+struct MetarResult;
+}
+}
+}
+
+/*
+ * In-memory store for METAR reports read from bulk files like NOAA cycle files, VATSIM and IVAO dumps or the
+ * X-Plane METAR.rwx file.
+ *
+ * Keeps one report per station and a k-d tree over the station coordinates which allows to find the
+ * nearest station having a report in O(log n).
+ */
+class MetarIndex
+{
+public:
+  MetarIndex();
+  ~MetarIndex();
+
+  /*
+   * Read reports from bulk text data. One report per line. Lines containing only a date like "2018/02/09 03:06"
+   * and empty lines are ignored. A leading "METAR" or "SPECI" is removed. Calling this more than once merges the
+   * reports and keeps the newest report for each station.
+   */
+  void read(const QByteArray& data);
+
+  /* Build the k-d tree for all stations found in the coordinate hash. Call after reading all data. */
+  void buildIndex(const QHash<QString, atools::geo::Pos>& airportCoordinates);
+
+  void clear();
+
+  /* Returns report for the station or for the nearest station if pos is valid and the station has no report */
+  atools::fs::weather::MetarResult getMetar(const QString& station, const atools::geo::Pos& pos) const;
+
+  /* Report for station or empty if station has no report */
+  QString getMetarString(const QString& station) const;
+
+  /* Returns nearest station to pos having a report or empty if none was found */
+  QString getNearestStation(const atools::geo::Pos& pos) const;
+
+  /* Get reports of all stations */
+  QStringList getAllMetars() const;
+
+  bool isEmpty() const
+  {
+    return stations.isEmpty();
+  }
+
+  int size() const
+  {
+    return stations.size();
+  }
+
+  /* Time when the data was read */
+  const QDateTime& getTimestamp() const
+  {
+    return timestamp;
+  }
+
+  void setTimestamp(const QDateTime& value)
+  {
+    timestamp = value;
+  }
+
+private:
+  struct Station
+  {
+    QString ident, metar;
+    int timeKey; /* Day, hour and minute of report as minutes */
+  };
+
+  /* Node of implicit k-d tree. Median of each range is the node. Coordinates are a unit vector. */
+  struct TreeNode
+  {
+    float coord[3];
+    int stationIndex;
+  };
+
+  void buildTree(int begin, int end, int depth);
+  void nearest(int begin, int end, int depth, const float point[3], int& bestIndex, float& bestDistance) const;
+  int nearestIndex(const atools::geo::Pos& pos) const;
+  static void toVector(const atools::geo::Pos& pos, float vector[3]);
+  static int reportTimeKey(const QString& timeField);
+
+  QVector<Station> stations;
+  QHash<QString, int> stationIndex;
+  QVector<TreeNode> tree;
+  QDateTime timestamp;
+};
+
+#endif // LITTLENAVMAP_METARINDEX_H
@@ -0,0 +1,46 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_METARTYPES_H
+#define LITTLENAVMAP_METARTYPES_H
+
+/* Lightweight METAR related types which can be used without including the cache */
+namespace metar {
+
+/* Source of a report. Part of the cache key. */
+enum Source
+{
+  SIMULATOR, /* FSX/P3D SimConnect or X-Plane METAR.rwx */
+  ACTIVESKY,
+  NOAA,
+  VATSIM,
+  IVAO
+};
+
+/* Flight category derived from ceiling and visibility as used by the FAA */
+enum FlightCategory
+{
+  UNKNOWN,
+  VFR,
+  MVFR, /* Marginal VFR */
+  IFR,
+  LIFR /* Low IFR */
+};
+
+}
+
+#endif // LITTLENAVMAP_METARTYPES_H
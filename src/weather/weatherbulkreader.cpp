@@ -0,0 +1,383 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "weather/weatherbulkreader.h"
+
+#include "online/onlinedownloader.h"
+#include "fs/weather/weathertypes.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+
+/* Wait for the file being written completely after a change notification */
+static const int FILE_CHANGE_DELAY_MS = 1000;
+
+WeatherBulkReader::WeatherBulkReader(QObject *parent, const QString& sourceName)
+  : QObject(parent), name(sourceName)
+{
+  connect(&updateTimer, &QTimer::timeout, this, &WeatherBulkReader::update);
+
+  fileTimer.setSingleShot(true);
+  fileTimer.setInterval(FILE_CHANGE_DELAY_MS);
+  connect(&fileTimer, &QTimer::timeout, this, &WeatherBulkReader::startIndexing);
+
+  connect(&indexWatcher, &QFutureWatcher<MetarIndex>::finished, this, &WeatherBulkReader::indexingFinished);
+}
+
+WeatherBulkReader::~WeatherBulkReader()
+{
+  updateTimer.stop();
+  fileTimer.stop();
+  for(OnlineDownloader *downloader : downloaders)
+    downloader->cancelDownload();
+  indexFuture.waitForFinished();
+}
+
+void WeatherBulkReader::setFile(const QString& filepath)
+{
+  clear();
+  file = filepath;
+
+  delete fileWatcher;
+  fileWatcher = nullptr;
+
+  if(!file.isEmpty())
+  {
+    fileWatcher = new QFileSystemWatcher(this);
+    connect(fileWatcher, &QFileSystemWatcher::fileChanged, this, &WeatherBulkReader::fileChanged);
+    if(!fileWatcher->addPath(file))
+      qWarning() << Q_FUNC_INFO << name << "cannot watch" << file;
+
+    startIndexing();
+  }
+}
+
+void WeatherBulkReader::setUpdatePeriod(int seconds)
+{
+  if(seconds > 0)
+    updateTimer.start(seconds * 1000);
+  else
+    updateTimer.stop();
+}
+
+void WeatherBulkReader::setMaxParallelDownloads(int value)
+{
+  maxParallelDownloads = std::max(value, 1);
+}
+
+void WeatherBulkReader::setAirportCoordinates(const QHash<QString, atools::geo::Pos>& value)
+{
+  airportCoordinates = value;
+
+  if(!lastData.isEmpty() || !file.isEmpty())
+    startIndexing();
+}
+
+void WeatherBulkReader::update()
+{
+  startUpdate(false);
+}
+
+void WeatherBulkReader::updateMissing()
+{
+  startUpdate(true);
+}
+
+void WeatherBulkReader::startUpdate(bool missingOnly)
+{
+  if(!urlFunction)
+    return;
+
+  if(isUpdating())
+  {
+    // Already downloading - fetch new URLs once done
+    if(missingOnly)
+      updateMissingPending = true;
+    return;
+  }
+
+  urls = urlFunction();
+  downloadUrls.clear();
+  for(const QString& url : urls)
+  {
+    if(!missingOnly || !lastData.contains(url))
+      downloadUrls.append(url);
+  }
+
+  modified = false;
+  if(downloadUrls.isEmpty())
+  {
+    // Nothing to download but URLs might have been removed
+    cycleFinished();
+    return;
+  }
+
+  pendingDownloads = downloadUrls.size();
+  parallelDownloads = std::min(maxParallelDownloads, downloadUrls.size());
+
+  // Create missing downloaders - these are kept to remember conditions of previous requests
+  while(downloaders.size() < parallelDownloads)
+  {
+    int downloaderIndex = downloaders.size();
+    OnlineDownloader *downloader = new OnlineDownloader(this);
+    connect(downloader, &OnlineDownloader::downloadFinished, this,
+            [this, downloaderIndex](const QByteArray& data, QString url)
+    {
+      downloadFinished(downloaderIndex, data, url);
+    });
+    connect(downloader, &OnlineDownloader::downloadNotModified, this, [this, downloaderIndex](QString url)
+    {
+      downloadNotModified(downloaderIndex, url);
+    });
+    connect(downloader, &OnlineDownloader::downloadFailed, this,
+            [this, downloaderIndex](const QString& error, QString url)
+    {
+      downloadFailed(downloaderIndex, error, url);
+    });
+    downloaders.append(downloader);
+    downloaderUrlIndex.append(-1);
+  }
+
+  for(int i = 0; i < parallelDownloads; i++)
+    downloadNext(i, i);
+}
+
+void WeatherBulkReader::clear()
+{
+  for(OnlineDownloader *downloader : downloaders)
+  {
+    downloader->cancelDownload();
+    downloader->clearConditions();
+  }
+  downloaderUrlIndex.fill(-1);
+  fileTimer.stop();
+  urls.clear();
+  downloadUrls.clear();
+  pendingDownloads = 0;
+  updateMissingPending = false;
+  updateIndexing = false;
+  lastData.clear();
+  index.clear();
+
+  // Discard result of any running indexing
+  generation++;
+  indexPending = false;
+}
+
+void WeatherBulkReader::downloadNext(int downloaderIndex, int urlIndex)
+{
+  downloaderUrlIndex[downloaderIndex] = urlIndex;
+  downloaders.at(downloaderIndex)->setUrl(downloadUrls.at(urlIndex));
+  downloaders.at(downloaderIndex)->startDownload();
+}
+
+void WeatherBulkReader::downloadDone(int downloaderIndex)
+{
+  int next = downloaderUrlIndex.at(downloaderIndex) + parallelDownloads;
+  downloaderUrlIndex[downloaderIndex] = -1;
+  pendingDownloads--;
+
+  if(next < downloadUrls.size())
+    downloadNext(downloaderIndex, next);
+  else if(pendingDownloads == 0)
+    cycleFinished();
+}
+
+void WeatherBulkReader::cycleFinished()
+{
+  // All done - remove data of URLs which are not used anymore
+  for(const QString& url : lastData.keys())
+  {
+    if(!urls.contains(url))
+    {
+      lastData.remove(url);
+      modified = true;
+    }
+  }
+
+  if(modified)
+  {
+    updateIndexing = true;
+    startIndexing();
+  }
+  else
+    emitUpdateFinished();
+}
+
+void WeatherBulkReader::emitUpdateFinished()
+{
+  emit updateFinished();
+
+  if(updateMissingPending)
+  {
+    // URLs were added while updating
+    updateMissingPending = false;
+    updateMissing();
+  }
+}
+
+void WeatherBulkReader::downloadFinished(int downloaderIndex, const QByteArray& data, QString url)
+{
+  int urlIndex = downloaderUrlIndex.at(downloaderIndex);
+  if(urlIndex < 0 || urlIndex >= downloadUrls.size())
+    return;
+
+  qDebug() << Q_FUNC_INFO << name << url << "size" << data.size();
+
+  lastData.insert(downloadUrls.at(urlIndex), data);
+  modified = true;
+  downloadDone(downloaderIndex);
+}
+
+void WeatherBulkReader::downloadNotModified(int downloaderIndex, QString url)
+{
+  int urlIndex = downloaderUrlIndex.at(downloaderIndex);
+  if(urlIndex < 0 || urlIndex >= downloadUrls.size())
+    return;
+
+  if(!lastData.contains(downloadUrls.at(urlIndex)))
+  {
+    // Data was removed - get it completely with next update
+    qWarning() << Q_FUNC_INFO << name << url << "not modified but no data";
+    downloaders.at(downloaderIndex)->clearConditions();
+  }
+
+  downloadDone(downloaderIndex);
+}
+
+void WeatherBulkReader::downloadFailed(int downloaderIndex, const QString& error, QString url)
+{
+  int urlIndex = downloaderUrlIndex.at(downloaderIndex);
+  if(urlIndex < 0 || urlIndex >= downloadUrls.size())
+    return;
+
+  // Continue with remaining URLs and keep old data
+  qWarning() << Q_FUNC_INFO << name << "download from" << url << "failed" << error;
+  downloadDone(downloaderIndex);
+}
+
+void WeatherBulkReader::fileChanged(const QString& path)
+{
+  qDebug() << Q_FUNC_INFO << name << path;
+
+  // Watcher removes files which are deleted and replaced
+  if(!fileWatcher->files().contains(path) && !fileWatcher->addPath(path))
+    qWarning() << Q_FUNC_INFO << name << "cannot watch" << path;
+
+  fileTimer.start();
+}
+
+void WeatherBulkReader::startIndexing()
+{
+  if(indexFuture.isRunning())
+  {
+    // Read again once done
+    indexPending = true;
+    return;
+  }
+
+  // Merge data in URL order to keep newest reports
+  QList<QByteArray> data;
+  for(const QString& url : urls)
+  {
+    if(lastData.contains(url))
+      data.append(lastData.value(url));
+  }
+
+  if(file.isEmpty() && data.isEmpty())
+  {
+    if(!index.isEmpty())
+    {
+      // All URLs were removed
+      index.clear();
+      emit weatherUpdated();
+    }
+
+    if(updateIndexing)
+    {
+      updateIndexing = false;
+      emitUpdateFinished();
+    }
+    return;
+  }
+
+  indexGeneration = generation;
+  // Copy all values for the background thread
+  QString filepath = file;
+  QHash<QString, atools::geo::Pos> coordinates = airportCoordinates;
+  MetarCache *cache = metarCache;
+  metar::Source source = metarSource;
+  indexFuture = QtConcurrent::run([filepath, data, coordinates, cache, source]() -> MetarIndex
+  {
+    return buildIndex(filepath, data, coordinates, cache, source);
+  });
+  indexWatcher.setFuture(indexFuture);
+}
+
+void WeatherBulkReader::indexingFinished()
+{
+  if(indexGeneration == generation)
+  {
+    index = indexFuture.result();
+    qDebug() << Q_FUNC_INFO << name << "stations" << index.size();
+    emit weatherUpdated();
+  }
+
+  if(indexPending)
+  {
+    // Run again with the new data - updateFinished is sent once this is done
+    indexPending = false;
+    startIndexing();
+  }
+  else if(updateIndexing)
+  {
+    updateIndexing = false;
+    emitUpdateFinished();
+  }
+}
+
+MetarIndex WeatherBulkReader::buildIndex(QString filepath, QList<QByteArray> data,
+                                         QHash<QString, atools::geo::Pos> coordinates, MetarCache *cache,
+                                         metar::Source source)
+{
+  MetarIndex metarIndex;
+
+  if(!filepath.isEmpty())
+  {
+    QFile metarFile(filepath);
+    if(metarFile.open(QIODevice::ReadOnly))
+    {
+      metarIndex.read(metarFile.readAll());
+      metarFile.close();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "cannot open" << filepath << metarFile.errorString();
+  }
+
+  for(const QByteArray& bytes : data)
+    metarIndex.read(bytes);
+
+  metarIndex.buildIndex(coordinates);
+  metarIndex.setTimestamp(QDateTime::currentDateTime());
+
+  // Decode new reports here to avoid parsing in the GUI thread
+  if(cache != nullptr)
+    cache->decodeMetars(source, metarIndex.getAllMetars(), metar::simFormat(source));
+  return metarIndex;
+}
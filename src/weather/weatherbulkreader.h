@@ -0,0 +1,170 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_WEATHERBULKREADER_H
+#define LITTLENAVMAP_WEATHERBULKREADER_H
+
+#include "weather/metarindex.h"
+#include "weather/metarcache.h"
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+class OnlineDownloader;
+class QFileSystemWatcher;
+
+/*
+ * Loads METAR reports for one weather source from bulk files and keeps them in a MetarIndex.
+ *
+ * Data is either downloaded from one or more URLs which are merged or read from a local file which is
+ * watched for changes. Reading and indexing is done in a background thread and the signal weatherUpdated
+ * is emitted once the new index is available. All lookups are done in memory.
+ */
+class WeatherBulkReader :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  /* @param sourceName used for logging only */
+  WeatherBulkReader(QObject *parent, const QString& sourceName);
+  virtual ~WeatherBulkReader();
+
+  /* Function returning the URLs to download and merge. Called on each update to allow changing URLs. */
+  void setUrlFunction(const std::function<QStringList()>& value)
+  {
+    urlFunction = value;
+  }
+
+  /* Read the given local file instead of downloading. File is watched for changes. Empty path disables. */
+  void setFile(const QString& filepath);
+
+  /* Download data periodically. -1 disables downloads. */
+  void setUpdatePeriod(int seconds);
+
+  /* Maximum number of URLs downloaded at the same time. Default is one. */
+  void setMaxParallelDownloads(int value);
+
+  /* Decode all new reports into the cache in the background thread after reading */
+  void setMetarCache(MetarCache *cache, metar::Source source)
+  {
+    metarCache = cache;
+    metarSource = source;
+  }
+
+  /* Coordinates used for the nearest station index. Index is rebuilt in background. */
+  void setAirportCoordinates(const QHash<QString, atools::geo::Pos>& value);
+
+  atools::fs::weather::MetarResult getMetar(const QString& station, const atools::geo::Pos& pos) const
+  {
+    return index.getMetar(station, pos);
+  }
+
+  const MetarIndex& getIndex() const
+  {
+    return index;
+  }
+
+  /* Start download or reading now. Does nothing if an update is already running. */
+  void update();
+
+  /* Download only URLs which have no data yet and drop data of URLs not returned by the URL function anymore.
+   * Runs after the current update if one is running. */
+  void updateMissing();
+
+  /* True while downloads or indexing of an update cycle are running */
+  bool isUpdating() const
+  {
+    return pendingDownloads > 0 || updateIndexing;
+  }
+
+  /* Stop downloads and remove all data */
+  void clear();
+
+signals:
+  /* New data was read and indexed */
+  void weatherUpdated();
+
+  /* Update cycle started by update() is done. Emitted after weatherUpdated if data has changed. */
+  void updateFinished();
+
+private:
+  void startUpdate(bool missingOnly);
+
+  /* Remove unused data and start indexing if anything changed after all downloads are done */
+  void cycleFinished();
+
+  /* Emit updateFinished and start a pending updateMissing */
+  void emitUpdateFinished();
+
+  /* Start download of url at urlIndex in downloadUrls using downloader at downloaderIndex */
+  void downloadNext(int downloaderIndex, int urlIndex);
+  void downloadDone(int downloaderIndex);
+  void downloadFinished(int downloaderIndex, const QByteArray& data, QString url);
+  void downloadNotModified(int downloaderIndex, QString url);
+  void downloadFailed(int downloaderIndex, const QString& error, QString url);
+  void fileChanged(const QString& path);
+
+  /* Start indexing of raw data and coordinates in background */
+  void startIndexing();
+  void indexingFinished();
+
+  /* Reads file if given, merges all data and builds the index - runs in background */
+  static MetarIndex buildIndex(QString filepath, QList<QByteArray> data,
+                               QHash<QString, atools::geo::Pos> coordinates, MetarCache *cache,
+                               metar::Source source);
+
+  QString name;
+
+  /* Downloads - downloader n fetches the URLs n, n + parallel, n + 2 * parallel, ... of a cycle */
+  QVector<OnlineDownloader *> downloaders;
+  QVector<int> downloaderUrlIndex; /* Index in downloadUrls of current download per downloader or -1 if idle */
+  int maxParallelDownloads = 1, parallelDownloads = 0;
+  std::function<QStringList()> urlFunction;
+  QTimer updateTimer;
+  QStringList urls; /* URLs of current update cycle */
+  QStringList downloadUrls; /* URLs downloaded in current update cycle - all or the ones without data */
+  bool updateMissingPending = false; /* updateMissing was called while updating */
+  int pendingDownloads = 0; /* Number of URLs not finished yet in this cycle */
+  bool modified = false; /* Any of the URLs delivered new data in this cycle */
+  bool updateIndexing = false; /* Indexing of downloaded data is running */
+  QHash<QString, QByteArray> lastData; /* Raw data by URL - used if not modified */
+
+  /* Local file */
+  QString file;
+  QFileSystemWatcher *fileWatcher = nullptr;
+  QTimer fileTimer; /* Delays reading until file is written completely */
+
+  QHash<QString, atools::geo::Pos> airportCoordinates;
+
+  /* Shared cache for decoded reports - not owned */
+  MetarCache *metarCache = nullptr;
+  metar::Source metarSource = metar::NOAA;
+
+  /* Indexing in background */
+  MetarIndex index;
+  QFuture<MetarIndex> indexFuture;
+  QFutureWatcher<MetarIndex> indexWatcher;
+  bool indexPending = false; /* Data or coordinates changed while indexing */
+  int generation = 0, indexGeneration = 0; /* Used to discard results after clear() */
+};
+
+#endif // LITTLENAVMAP_WEATHERBULKREADER_H
@@ -21,13 +21,17 @@
 #include "settings/settings.h"
 #include "options/optiondata.h"
 #include "common/constants.h"
-#include "fs/weather/xpweatherreader.h"
 #include "navapp.h"
-#include "fs/weather/weathernetdownload.h"
+#include "fs/weather/weathertypes.h"
 #include "fs/sc/simconnecttypes.h"
 #include "query/mapquery.h"
 #include "query/airportquery.h"
 #include "fs/weather/weathernetsingle.h"
+#include "weather/weatherbulkreader.h"
+#include "weather/metarcache.h"
+#include "weather/airportweatheroverlay.h"
+#include "route/route.h"
+#include "geo/calculations.h"
 
 #include <QDebug>
 #include <QDir>
@@ -46,17 +50,40 @@ static const QRegularExpression ASN_VALIDATE_REGEXP("^[A-Z0-9]{3,4}::[A-Z0-9]{3,
 static const QRegularExpression ASN_VALIDATE_FLIGHTPLAN_REGEXP("^DepartureMETAR=.+$");
 static const QRegularExpression ASN_FLIGHTPLAN_REGEXP("^(DepartureMETAR|DestinationMETAR)=([A-Z0-9]{3,4})?(.*)$");
 
+/* Remove NOAA single stations from the periodic update if not requested by preloadWeather for this time */
+static const int NOAA_STATION_EXPIRE_SECONDS = 3600;
+
+/* Wait for route edits to settle before looking for airports near the route */
+static const int PRELOAD_ROUTE_DELAY_MS = 1000;
+
+/* Distance between positions sampled along route legs to find airport grid cells */
+static const float PRELOAD_SAMPLE_DISTANCE_METER = 50000.f;
+
+/* Cell size of the airport grid in degree */
+static const int AIRPORT_GRID_CELL_DEG = 1;
+static const int AIRPORT_GRID_CELLS_X = 360 / AIRPORT_GRID_CELL_DEG;
+static const int AIRPORT_GRID_CELLS_Y = 180 / AIRPORT_GRID_CELL_DEG;
+
 using atools::fs::FsPaths;
-using atools::fs::weather::WeatherNetDownload;
 using atools::fs::weather::WeatherNetSingle;
 
 WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::SimulatorType type)
   : QObject(parentWindow), simType(type),
   mainWindow(parentWindow)
 {
-  onlineWeatherTimeoutSecs = atools::settings::Settings::instance().valueInt(lnm::OPTIONS_WEATHER_UPDATE, 600);
-
-  xpWeatherReader = new atools::fs::weather::XpWeatherReader(this);
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  onlineWeatherTimeoutSecs = settings.valueInt(lnm::OPTIONS_WEATHER_UPDATE, 600);
+  noaaBulkUrl = settings.getAndStoreValue(lnm::OPTIONS_WEATHER_NOAA_BULK_URL,
+                                          "http://tgftp.nws.noaa.gov/data/observations/metar/cycles/%1Z.TXT").
+                toString();
+  preloadTrackDistanceNm = settings.getAndStoreValue(lnm::OPTIONS_WEATHER_PRELOAD_TRACK_DIST_NM, 10.).toFloat();
+
+  preloadRouteTimer.setSingleShot(true);
+  preloadRouteTimer.setInterval(PRELOAD_ROUTE_DELAY_MS);
+  connect(&preloadRouteTimer, &QTimer::timeout, this, [this]()
+  {
+    preloadRouteWeather(NavApp::getRouteConst());
+  });
 
   bool verbose = false;
 #ifdef DEBUG_INFORMATION
@@ -64,47 +91,103 @@ WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::
 #endif
 
   noaaWeather = new WeatherNetSingle(parentWindow, onlineWeatherTimeoutSecs, verbose);
-  QString noaaUrl(OptionData::instance().getWeatherNoaaUrl());
-  noaaWeather->setRequestUrl(noaaUrl);
-  noaaWeather->setStationIndexUrl(noaaUrl.left(noaaUrl.lastIndexOf("/")) + "/", noaaIndexParser);
+  weatherNoaaUrl = OptionData::instance().getWeatherNoaaUrl();
+  weatherVatsimUrl = OptionData::instance().getWeatherVatsimUrl();
+  weatherIvaoUrl = OptionData::instance().getWeatherIvaoUrl();
+  noaaWeather->setRequestUrl(weatherNoaaUrl);
+  noaaWeather->setStationIndexUrl(weatherNoaaUrl.left(weatherNoaaUrl.lastIndexOf("/")) + "/", noaaIndexParser);
   noaaWeather->setFetchAirportCoords(fetchAirportCoordinates);
 
-  vatsimWeather = new WeatherNetSingle(parentWindow, onlineWeatherTimeoutSecs, verbose);
-  vatsimWeather->setRequestUrl(OptionData::instance().getWeatherVatsimUrl());
+  metarCache = new MetarCache;
+  airportWeatherOverlay = new AirportWeatherOverlay(this);
 
-  ivaoWeather = new WeatherNetDownload(parentWindow, verbose);
-  ivaoWeather->setRequestUrl(OptionData::instance().getWeatherIvaoUrl());
-  // Set callback so the reader can build an index for nearest airports
-  ivaoWeather->setFetchAirportCoords(fetchAirportCoordinates);
-  if(OptionData::instance().getFlags2() & opts::WEATHER_INFO_IVAO ||
-     OptionData::instance().getFlags2() & opts::WEATHER_TOOLTIP_IVAO)
-    ivaoWeather->setUpdatePeriod(onlineWeatherTimeoutSecs);
-  else
-    ivaoWeather->setUpdatePeriod(-1);
+  // NOAA cycle files for the previous and current hour - reports in the later file override older ones
+  noaaBulk = new WeatherBulkReader(this, "NOAA");
+  noaaBulk->setUrlFunction([this]() -> QStringList
+  {
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    return {noaaBulkUrl.arg(now.addSecs(-3600).toString("HH")), noaaBulkUrl.arg(now.toString("HH"))};
+  });
 
-  initActiveSkyNext();
+  // Use "all" instead of station to get all reports
+  vatsimBulk = new WeatherBulkReader(this, "VATSIM");
+  vatsimBulk->setUrlFunction([]() -> QStringList
+  {
+    return {OptionData::instance().getWeatherVatsimUrl().arg("all")};
+  });
+
+  ivaoBulk = new WeatherBulkReader(this, "IVAO");
+  ivaoBulk->setUrlFunction([]() -> QStringList
+  {
+    return {OptionData::instance().getWeatherIvaoUrl()};
+  });
 
-  // Set callback so the reader can build an index for nearest airports
-  xpWeatherReader->setFetchAirportCoords(fetchAirportCoordinates);
+  xplaneBulk = new WeatherBulkReader(this, "X-Plane");
+
+  // Decode reports in the reader threads
+  noaaBulk->setMetarCache(metarCache, metar::NOAA);
+  vatsimBulk->setMetarCache(metarCache, metar::VATSIM);
+  ivaoBulk->setMetarCache(metarCache, metar::IVAO);
+  xplaneBulk->setMetarCache(metarCache, metar::SIMULATOR);
+
+  // Single station reports for preloadWeather if NOAA bulk files are disabled
+  noaaStations = new WeatherBulkReader(this, "NOAA stations");
+  noaaStations->setMaxParallelDownloads(settings.getAndStoreValue(lnm::OPTIONS_WEATHER_PRELOAD_PARALLEL, 4).toInt());
+  noaaStations->setUrlFunction([this]() -> QStringList
+  {
+    QStringList urls;
+    QString url = OptionData::instance().getWeatherNoaaUrl();
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for(auto it = noaaStationTimes.constBegin(); it != noaaStationTimes.constEnd(); ++it)
+    {
+      // Leave out expired stations which removes their data
+      if(now - it.value() <= NOAA_STATION_EXPIRE_SECONDS * 1000L)
+        urls.append(url.arg(it.key()));
+    }
+    return urls;
+  });
+  noaaStations->setMetarCache(metarCache, metar::NOAA);
+
+  // Coordinates for nearest station index
+  updateAirportCoordinates();
+
+  updateBulkReaders();
+  initActiveSkyNext();
   initXplane();
 
-  connect(xpWeatherReader, &atools::fs::weather::XpWeatherReader::weatherUpdated,
-          this, &WeatherReporter::xplaneWeatherFileChanged);
+  connect(xplaneBulk, &WeatherBulkReader::weatherUpdated, this, &WeatherReporter::xplaneWeatherFileChanged);
 
   // Forward signals from clients
   connect(noaaWeather, &WeatherNetSingle::weatherUpdated, this, &WeatherReporter::weatherUpdated);
-  connect(vatsimWeather, &WeatherNetSingle::weatherUpdated, this, &WeatherReporter::weatherUpdated);
-  connect(ivaoWeather, &WeatherNetDownload::weatherUpdated, this, &WeatherReporter::weatherUpdated);
+  // Recalculate overlay on any weather change
+  connect(this, &WeatherReporter::weatherUpdated, airportWeatherOverlay, &AirportWeatherOverlay::weatherChanged);
+
+  for(WeatherBulkReader *reader : {noaaBulk, vatsimBulk, ivaoBulk, noaaStations})
+  {
+    connect(reader, &WeatherBulkReader::weatherUpdated, this, [this, reader]()
+    {
+      bulkReaderWeatherUpdated(reader);
+    });
+    connect(reader, &WeatherBulkReader::updateFinished, this, [this, reader]()
+    {
+      bulkReaderUpdateFinished(reader);
+    });
+  }
 }
 
 WeatherReporter::~WeatherReporter()
 {
   deleteFsWatcher();
   delete noaaWeather;
-  delete vatsimWeather;
-  delete ivaoWeather;
-
-  delete xpWeatherReader;
+  delete noaaBulk;
+  delete vatsimBulk;
+  delete ivaoBulk;
+  delete xplaneBulk;
+  delete noaaStations;
+
+  // Delete after readers and overlay since these use it in background threads
+  delete airportWeatherOverlay;
+  delete metarCache;
 }
 
 atools::geo::Pos WeatherReporter::fetchAirportCoordinates(const QString& airportIdent)
@@ -174,7 +257,302 @@ void WeatherReporter::createFsWatcher()
 void WeatherReporter::initXplane()
 {
   if(simType == atools::fs::FsPaths::XPLANE11)
-    xpWeatherReader->readWeatherFile(NavApp::getCurrentSimulatorBasePath() + QDir::separator() + "METAR.rwx");
+    xplaneBulk->setFile(NavApp::getCurrentSimulatorBasePath() + QDir::separator() + "METAR.rwx");
+  else
+    xplaneBulk->setFile(QString());
+}
+
+void WeatherReporter::updateAirportCoordinates()
+{
+  airportCoordinates.clear();
+  NavApp::getAirportQuerySim()->getAllAirportCoordinates(airportCoordinates);
+  qDebug() << Q_FUNC_INFO << "airports" << airportCoordinates.size();
+
+  airportGrid.clear();
+  for(auto it = airportCoordinates.constBegin(); it != airportCoordinates.constEnd(); ++it)
+  {
+    int x = static_cast<int>((it.value().getLonX() + 180.f) / AIRPORT_GRID_CELL_DEG);
+    int y = static_cast<int>((it.value().getLatY() + 90.f) / AIRPORT_GRID_CELL_DEG);
+    x = std::max(0, std::min(x, AIRPORT_GRID_CELLS_X - 1));
+    y = std::max(0, std::min(y, AIRPORT_GRID_CELLS_Y - 1));
+    airportGrid[y * AIRPORT_GRID_CELLS_X + x].append(it.key());
+  }
+
+  for(WeatherBulkReader *reader : {noaaBulk, vatsimBulk, ivaoBulk, xplaneBulk, noaaStations})
+    reader->setAirportCoordinates(airportCoordinates);
+}
+
+void WeatherReporter::updateBulkReaders()
+{
+  const OptionData& od = OptionData::instance();
+
+  bool noaa = od.getFlags() & opts::WEATHER_INFO_NOAA || od.getFlags() & opts::WEATHER_TOOLTIP_NOAA;
+  enableBulkReader(noaaBulk, noaa && !noaaBulkUrl.isEmpty());
+  enableBulkReader(noaaStations, noaa && noaaBulkUrl.isEmpty());
+  enableBulkReader(vatsimBulk, od.getFlags() & opts::WEATHER_INFO_VATSIM ||
+                   od.getFlags() & opts::WEATHER_TOOLTIP_VATSIM);
+  enableBulkReader(ivaoBulk, od.getFlags2() & opts::WEATHER_INFO_IVAO ||
+                   od.getFlags2() & opts::WEATHER_TOOLTIP_IVAO);
+}
+
+void WeatherReporter::enableBulkReader(WeatherBulkReader *reader, bool enable)
+{
+  if(enable)
+  {
+    enabledReaders.insert(reader);
+    reader->setUpdatePeriod(onlineWeatherTimeoutSecs);
+    if(reader->getIndex().isEmpty())
+      reader->update();
+  }
+  else
+  {
+    enabledReaders.remove(reader);
+    reader->setUpdatePeriod(-1);
+    clearBulkReader(reader);
+  }
+}
+
+void WeatherReporter::clearBulkReader(WeatherBulkReader *reader)
+{
+  batchReaders.remove(reader);
+  reader->clear();
+
+  if(reader == noaaStations)
+    noaaStationTimes.clear();
+}
+
+QVector<WeatherReporter::MetarLookup> WeatherReporter::getMetarLookups() const
+{
+  const OptionData& od = OptionData::instance();
+  QVector<MetarLookup> lookups;
+
+  // Same order as in the information panel
+  if(simType == atools::fs::FsPaths::XPLANE11 &&
+     (od.getFlags() & opts::WEATHER_INFO_FS || od.getFlags() & opts::WEATHER_TOOLTIP_FS))
+  {
+    MetarIndex index = xplaneBulk->getIndex();
+    lookups.append(std::make_pair(metar::SIMULATOR, [index](const QString& ident) -> QString
+    {
+      return index.getMetarString(ident);
+    }));
+  }
+
+  if(od.getFlags() & opts::WEATHER_INFO_ACTIVESKY || od.getFlags() & opts::WEATHER_TOOLTIP_ACTIVESKY)
+  {
+    ActiveSkySnapshot snapshot = activeSkySnapshot;
+    QString depIdent = activeSkyDepartureIdent, depMetar = activeSkyDepartureMetar,
+            destIdent = activeSkyDestinationIdent, destMetar = activeSkyDestinationMetar;
+    MetarLookupFunc func = [snapshot, depIdent, depMetar, destIdent, destMetar](const QString& ident) -> QString
+    {
+      if(ident == depIdent)
+        return depMetar;
+      else if(ident == destIdent)
+        return destMetar;
+      else
+        return snapshot.getMetar(ident);
+    };
+    lookups.append(std::make_pair(metar::ACTIVESKY, func));
+  }
+
+  if(od.getFlags() & opts::WEATHER_INFO_NOAA || od.getFlags() & opts::WEATHER_TOOLTIP_NOAA)
+  {
+    MetarIndex index = noaaBulkUrl.isEmpty() ? noaaStations->getIndex() : noaaBulk->getIndex();
+    lookups.append(std::make_pair(metar::NOAA, [index](const QString& ident) -> QString
+    {
+      return index.getMetarString(ident);
+    }));
+  }
+
+  if(od.getFlags() & opts::WEATHER_INFO_VATSIM || od.getFlags() & opts::WEATHER_TOOLTIP_VATSIM)
+  {
+    MetarIndex index = vatsimBulk->getIndex();
+    lookups.append(std::make_pair(metar::VATSIM, [index](const QString& ident) -> QString
+    {
+      return index.getMetarString(ident);
+    }));
+  }
+
+  if(od.getFlags2() & opts::WEATHER_INFO_IVAO || od.getFlags2() & opts::WEATHER_TOOLTIP_IVAO)
+  {
+    MetarIndex index = ivaoBulk->getIndex();
+    lookups.append(std::make_pair(metar::IVAO, [index](const QString& ident) -> QString
+    {
+      return index.getMetarString(ident);
+    }));
+  }
+  return lookups;
+}
+
+void WeatherReporter::routeChanged(bool geometryChanged)
+{
+  if(geometryChanged)
+    // Restart timer on each edit
+    preloadRouteTimer.start();
+}
+
+void WeatherReporter::preloadRouteWeather(const Route& route)
+{
+  QStringList idents;
+  QSet<QString> identSet;
+
+  // All airports of the plan =========================
+  for(int i = 0; i < route.size(); i++)
+  {
+    const RouteLeg& leg = route.at(i);
+    if(leg.getMapObjectType() == map::AIRPORT && !identSet.contains(leg.getIdent()))
+    {
+      idents.append(leg.getIdent());
+      identSet.insert(leg.getIdent());
+    }
+  }
+
+  // Airports near the legs =========================
+  // Bulk sources contain all stations - only needed for single station requests
+  if(preloadTrackDistanceNm > 0.f && route.size() > 1 && enabledReaders.contains(noaaStations))
+  {
+    float maxDistMeter = atools::geo::nmToMeter(preloadTrackDistanceNm);
+    float radiusMeter = maxDistMeter + PRELOAD_SAMPLE_DISTANCE_METER / 2.f;
+
+    for(int i = 1; i < route.size(); i++)
+    {
+      const atools::geo::Pos& from = route.getPositionAt(i - 1), & to = route.getPositionAt(i);
+      if(!from.isValid() || !to.isValid())
+        continue;
+
+      // Collect grid cells around positions sampled along the great circle line
+      QSet<int> cells;
+      float distMeter = from.distanceMeterTo(to);
+      int steps = static_cast<int>(std::ceil(distMeter / PRELOAD_SAMPLE_DISTANCE_METER));
+      for(int step = 0; step <= steps; step++)
+      {
+        atools::geo::Pos pos = steps > 0 ? from.interpolate(to, distMeter, static_cast<float>(step) / steps) : from;
+        airportGridCells(cells, pos, radiusMeter);
+      }
+
+      // Check distance for airports in these cells only
+      for(int cell : cells)
+      {
+        auto gridIt = airportGrid.constFind(cell);
+        if(gridIt == airportGrid.constEnd())
+          continue;
+
+        for(const QString& ident : gridIt.value())
+        {
+          if(identSet.contains(ident))
+            continue;
+
+          atools::geo::LineDistance result;
+          airportCoordinates.value(ident).distanceMeterToLine(from, to, result);
+          if(std::abs(result.distance) < maxDistMeter)
+          {
+            idents.append(ident);
+            identSet.insert(ident);
+          }
+        }
+      }
+    }
+  }
+
+  preloadWeather(idents);
+}
+
+void WeatherReporter::airportGridCells(QSet<int>& cells, const atools::geo::Pos& pos, float radiusMeter)
+{
+  float latDeg = atools::geo::meterToNm(radiusMeter) / 60.f;
+  int y1 = std::max(static_cast<int>((pos.getLatY() - latDeg + 90.f) / AIRPORT_GRID_CELL_DEG), 0);
+  int y2 = std::min(static_cast<int>((pos.getLatY() + latDeg + 90.f) / AIRPORT_GRID_CELL_DEG),
+                    AIRPORT_GRID_CELLS_Y - 1);
+
+  // Longitude degrees get smaller towards the poles - use the latitude nearest to the pole
+  float maxLat = std::min(std::abs(pos.getLatY()) + latDeg, 89.f);
+  float lonDeg = latDeg / std::cos(atools::geo::toRadians(maxLat));
+
+  int x1 = 0, x2 = AIRPORT_GRID_CELLS_X - 1;
+  if(lonDeg < 180.f)
+  {
+    x1 = static_cast<int>(std::floor((pos.getLonX() - lonDeg + 180.f) / AIRPORT_GRID_CELL_DEG));
+    x2 = static_cast<int>(std::floor((pos.getLonX() + lonDeg + 180.f) / AIRPORT_GRID_CELL_DEG));
+  }
+
+  for(int y = y1; y <= y2; y++)
+  {
+    for(int x = x1; x <= x2; x++)
+      // Wrap around at the anti-meridian
+      cells.insert(y * AIRPORT_GRID_CELLS_X + (x % AIRPORT_GRID_CELLS_X + AIRPORT_GRID_CELLS_X) % AIRPORT_GRID_CELLS_X);
+  }
+}
+
+void WeatherReporter::preloadWeather(const QStringList& airportIdents)
+{
+  QVector<WeatherBulkReader *> readers;
+
+  // Bulk sources contain all stations - download only if not loaded yet
+  for(WeatherBulkReader *reader : {noaaBulk, vatsimBulk, ivaoBulk})
+  {
+    if(enabledReaders.contains(reader) && reader->getIndex().isEmpty())
+      readers.append(reader);
+  }
+
+  if(enabledReaders.contains(noaaStations))
+  {
+    // Add new stations and remove the ones not requested for a while
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool changed = false;
+    for(const QString& ident : airportIdents)
+    {
+      if(!noaaStationTimes.contains(ident))
+        changed = true;
+      noaaStationTimes.insert(ident, now);
+    }
+
+    for(auto it = noaaStationTimes.begin(); it != noaaStationTimes.end();)
+    {
+      if(now - it.value() > NOAA_STATION_EXPIRE_SECONDS * 1000L)
+      {
+        it = noaaStationTimes.erase(it);
+        changed = true;
+      }
+      else
+        ++it;
+    }
+
+    if(changed)
+      readers.append(noaaStations);
+  }
+
+  qDebug() << Q_FUNC_INFO << "airports" << airportIdents.size() << "sources" << readers.size();
+
+  // Add all before starting since update might finish immediately
+  for(WeatherBulkReader *reader : readers)
+    batchReaders.insert(reader);
+
+  for(WeatherBulkReader *reader : readers)
+  {
+    if(reader == noaaStations)
+      // Download only new stations - all are refreshed by the periodic update
+      reader->updateMissing();
+    else
+      reader->update();
+  }
+}
+
+void WeatherReporter::bulkReaderWeatherUpdated(WeatherBulkReader *reader)
+{
+  if(batchReaders.contains(reader))
+    // Send signal once the batch is done
+    batchUpdated = true;
+  else
+    emit weatherUpdated();
+}
+
+void WeatherReporter::bulkReaderUpdateFinished(WeatherBulkReader *reader)
+{
+  if(batchReaders.remove(reader) && batchReaders.isEmpty())
+  {
+    if(batchUpdated)
+      emit weatherUpdated();
+    batchUpdated = false;
+  }
 }
 
 void WeatherReporter::initActiveSkyNext()
@@ -182,7 +560,8 @@ void WeatherReporter::initActiveSkyNext()
   deleteFsWatcher();
 
   activeSkyType = NONE;
-  activeSkyMetars.clear();
+  activeSkySnapshot.clear();
+  activeSkyFlightplanStamp = ActiveSkySnapshot::FileStamp();
   activeSkyDepartureMetar.clear();
   activeSkyDestinationMetar.clear();
   activeSkyDepartureIdent.clear();
@@ -253,51 +632,22 @@ void WeatherReporter::initActiveSkyNext()
   }
 }
 
-/* Loads complete ASN file into a hash map */
-void WeatherReporter::loadActiveSkySnapshot(const QString& path)
+/* Loads complete ASN file into the snapshot index */
+bool WeatherReporter::loadActiveSkySnapshot(const QString& path)
 {
-  // ASN
-  // C:\Users\USER\AppData\Roaming\HiFi\ASNFSX\Weather\current_wx_snapshot.txt or wx_station_list.txt
-  // AS16
-  // C:\Users\USER\AppData\Roaming\HiFi\AS16_FSX\Weather\current_wx_snapshot.txt or wx_station_list.txt
-
-  // AGGH::AGGH 261800Z 20002KT 9999 FEW014 SCT027 25/24 Q1009::AGGH 261655Z 2618/2718 VRB03KT 9999 FEW017 SCT028 FM270000
-  // 34010KT 9999 -SH SCT019 SCT03 FM271200 VRB03KT 9999 -SH FEW017 SCT028 PROB30 INTER 2703/27010 5000 TSSH SCT016 FEW017CB BKN028
-  // T 25 27 31 32 Q 1009 1011 1011 1009::278,11,24.0/267,12,19.0/263,13,16.1/233,12,7.2/290,7,-3.0/338,8,-13.0/348,18,-27.9/9,19,-37.9/26,15,-51.3
-
   // TODO overrride with settings
   if(path.isEmpty())
-    return;
+    return false;
 
-  QFile file(path);
-  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-  {
-    activeSkyMetars.clear();
-
-    QTextStream weatherSnapshot(&file);
-
-    int lineNum = 1;
-    QString line;
-    while(weatherSnapshot.readLineInto(&line))
-    {
-      QStringList list = line.split("::");
-      if(list.size() >= 2)
-        activeSkyMetars.insert(list.at(0), list.at(1));
-      else
-      {
-        qWarning() << "AS file" << file.fileName() << "has invalid entries";
-        qWarning() << "line #" << lineNum << line;
-      }
-      lineNum++;
-    }
-    file.close();
-  }
-  else
-    qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
+  bool changed = activeSkySnapshot.read(path);
+  if(changed)
+    metarCache->decodeMetarsBackground(metar::ACTIVESKY, activeSkySnapshot.getAllMetars(),
+                                       metar::simFormat(metar::ACTIVESKY));
+  return changed;
 }
 
 /* Loads flight plan weather for start and destination */
-void WeatherReporter::loadActiveSkyFlightplanSnapshot(const QString& path)
+bool WeatherReporter::loadActiveSkyFlightplanSnapshot(const QString& path)
 {
   // DepartureMETAR=NZTU 282151Z 33112KT 9999 FEW030 FEW168 11/05 Q0998 RMK ADVANCED INTERPOLATION
   // DestinationMETAR=NZHR 282151Z 31706KT 9999 -RA SCT020 SCT085 11/07 Q1000 RMK ADVANCED INTERPOLATION
@@ -309,17 +659,27 @@ void WeatherReporter::loadActiveSkyFlightplanSnapshot(const QString& path)
   // CruiseSpeed=300
 
   if(path.isEmpty())
-    return;
+    return false;
+
+  QFileInfo fileInfo(path);
+  if(ActiveSkySnapshot::isSameFile(activeSkyFlightplanStamp, fileInfo))
+    return false;
 
   QFile file(path);
   if(file.open(QIODevice::ReadOnly | QIODevice::Text))
   {
+    QByteArray content = file.readAll();
+    file.close();
+
+    if(!ActiveSkySnapshot::updateStamp(activeSkyFlightplanStamp, fileInfo, content.constData(), content.size()))
+      return false;
+
     activeSkyDepartureMetar.clear();
     activeSkyDestinationMetar.clear();
     activeSkyDepartureIdent.clear();
     activeSkyDestinationIdent.clear();
 
-    QTextStream flightplanFile(&file);
+    QTextStream flightplanFile(&content, QIODevice::ReadOnly);
 
     QString line;
     while(flightplanFile.readLineInto(&line))
@@ -341,11 +701,11 @@ void WeatherReporter::loadActiveSkyFlightplanSnapshot(const QString& path)
         }
       }
     }
-    file.close();
+    return true;
   }
   else
     qWarning() << "cannot open" << file.fileName() << "reason" << file.errorString();
-
+  return false;
 }
 
 bool WeatherReporter::validateActiveSkyFile(const QString& path)
@@ -474,28 +834,37 @@ QString WeatherReporter::getActiveSkyMetar(const QString& airportIcao)
   else if(activeSkyDestinationIdent == airportIcao)
     return activeSkyDestinationMetar;
   else
-    return activeSkyMetars.value(airportIcao, QString());
+    return activeSkySnapshot.getMetar(airportIcao);
 }
 
 atools::fs::weather::MetarResult WeatherReporter::getXplaneMetar(const QString& station, const atools::geo::Pos& pos)
 {
-  return xpWeatherReader->getXplaneMetar(station, pos);
+  return xplaneBulk->getMetar(station, pos);
 }
 
 atools::fs::weather::MetarResult WeatherReporter::getNoaaMetar(const QString& airportIcao, const atools::geo::Pos& pos)
 {
-  return noaaWeather->getMetar(airportIcao, pos);
+  if(noaaBulkUrl.isEmpty())
+  {
+    // Use preloaded reports if available
+    if(!noaaStations->getIndex().getMetarString(airportIcao).isEmpty())
+      return noaaStations->getMetar(airportIcao, pos);
+    else
+      return noaaWeather->getMetar(airportIcao, pos);
+  }
+  else
+    return noaaBulk->getMetar(airportIcao, pos);
 }
 
 QString WeatherReporter::getVatsimMetar(const QString& airportIcao)
 {
   // VATSIM does not use nearest station
-  return vatsimWeather->getMetar(airportIcao, atools::geo::EMPTY_POS).metarForStation;
+  return vatsimBulk->getIndex().getMetarString(airportIcao);
 }
 
 atools::fs::weather::MetarResult WeatherReporter::getIvaoMetar(const QString& airportIcao, const atools::geo::Pos& pos)
 {
-  return ivaoWeather->getMetar(airportIcao, pos);
+  return ivaoBulk->getMetar(airportIcao, pos);
 }
 
 void WeatherReporter::preDatabaseLoad()
@@ -505,6 +874,8 @@ void WeatherReporter::preDatabaseLoad()
 
 void WeatherReporter::postDatabaseLoad(atools::fs::FsPaths::SimulatorType type)
 {
+  updateAirportCoordinates();
+
   if(type != simType)
   {
     // Simulator has changed - reload files
@@ -516,29 +887,51 @@ void WeatherReporter::postDatabaseLoad(atools::fs::FsPaths::SimulatorType type)
 
 void WeatherReporter::optionsChanged()
 {
-  vatsimWeather->setRequestUrl(OptionData::instance().getWeatherVatsimUrl());
-  noaaWeather->setRequestUrl(OptionData::instance().getWeatherNoaaUrl());
-  ivaoWeather->setRequestUrl(OptionData::instance().getWeatherIvaoUrl());
+  const OptionData& od = OptionData::instance();
 
-  if(OptionData::instance().getFlags2() & opts::WEATHER_INFO_IVAO ||
-     OptionData::instance().getFlags2() & opts::WEATHER_TOOLTIP_IVAO)
-    ivaoWeather->setUpdatePeriod(onlineWeatherTimeoutSecs);
-  else
-    ivaoWeather->setUpdatePeriod(-1);
+  // Reload only readers with changed URLs - enabling and disabling is done in updateBulkReaders()
+  if(od.getWeatherNoaaUrl() != weatherNoaaUrl)
+  {
+    weatherNoaaUrl = od.getWeatherNoaaUrl();
+    noaaWeather->setRequestUrl(weatherNoaaUrl);
+    clearBulkReader(noaaStations);
+  }
+
+  if(od.getWeatherVatsimUrl() != weatherVatsimUrl)
+  {
+    weatherVatsimUrl = od.getWeatherVatsimUrl();
+    clearBulkReader(vatsimBulk);
+  }
+
+  if(od.getWeatherIvaoUrl() != weatherIvaoUrl)
+  {
+    weatherIvaoUrl = od.getWeatherIvaoUrl();
+    clearBulkReader(ivaoBulk);
+  }
+
+  // Downloads all enabled readers without reports
+  updateBulkReaders();
 
   initActiveSkyNext();
   initXplane();
+
+  // Enabled sources might have changed
+  airportWeatherOverlay->weatherChanged();
 }
 
 void WeatherReporter::activeSkyWeatherFileChanged(const QString& path)
 {
   Q_UNUSED(path);
   qDebug() << Q_FUNC_INFO << "file" << path << "changed";
-  loadActiveSkySnapshot(asPath);
-  loadActiveSkyFlightplanSnapshot(asFlightplanPath);
-  mainWindow->setStatusMessage(tr("Active Sky weather information updated."));
 
-  emit weatherUpdated();
+  // Watcher fires often while Active Sky is writing - reload only what has changed
+  bool snapshotChanged = loadActiveSkySnapshot(asPath);
+  bool flightplanChanged = loadActiveSkyFlightplanSnapshot(asFlightplanPath);
+  if(snapshotChanged || flightplanChanged)
+  {
+    mainWindow->setStatusMessage(tr("Active Sky weather information updated."));
+    emit weatherUpdated();
+  }
 }
 
 void WeatherReporter::xplaneWeatherFileChanged()
@@ -19,37 +19,45 @@
 #define LITTLENAVMAP_WEATHERREPORTER_H
 
 #include "fs/fspaths.h"
+#include "geo/pos.h"
+#include "weather/activeskysnapshot.h"
+#include "weather/metartypes.h"
 
 #include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
 
 namespace atools {
-namespace geo {
-class Pos;
-}
 namespace fs {
 namespace weather {
 struct MetarResult;
 
 class WeatherNetSingle;
-class WeatherNetDownload;
-class XpWeatherReader;
 }
 }
 }
 
 class QFileSystemWatcher;
 class MainWindow;
+class MetarCache;
+class WeatherBulkReader;
+class AirportWeatherOverlay;
+class Route;
 
 /*
- * Provides a source of metar data for airports. Supports ActiveSkyNext, NOAA and VATSIM weather.
+ * Provides a source of metar data for airports. Supports ActiveSkyNext, NOAA, VATSIM, IVAO and X-Plane weather.
  * The Active Sky (Next and 16) weather files are monitored for changes and the signal
  * weatherUpdated will be emitted if the file has changed.
- * NOAA and VATSIM start a request in background and emit the signal weatherUpdated.
  *
- * Uses hashmaps to cache online requests. Cache entries will timeout after 15 minutes.
+ * NOAA, VATSIM and IVAO reports are downloaded periodically as bulk files if enabled in options. The X-Plane
+ * METAR.rwx file is watched for changes. All are indexed in background and kept in memory which makes
+ * lookups for stations and nearest stations cheap. The signal weatherUpdated is emitted when new data arrives.
  *
- * Only one request is done. If a request is already waiting a new one will cancel the old one.
+ * NOAA falls back to requests for single stations if the bulk URL is empty.
  */
 // TODO better support for mutliple simulators
 class WeatherReporter :
@@ -93,12 +101,28 @@ public:
   /* Does nothing currently */
   void preDatabaseLoad();
 
-  /* Will reload new Active Sky data for the changed simulator type, but only if the path was not set manually */
+  /* Will reload new Active Sky data for the changed simulator type, but only if the path was not set manually.
+   * Reloads airport coordinates for nearest station lookup. */
   void postDatabaseLoad(atools::fs::FsPaths::SimulatorType type);
 
   /* Options dialog changed settings. Will reinitialize Active Sky file */
   void optionsChanged();
 
+  /*
+   * Fetch weather for all given airports in one batch. Bulk sources which are not loaded yet are downloaded
+   * and NOAA single station reports are requested with a limited number of parallel downloads if
+   * the bulk URL is not set. Only stations not loaded yet are requested. Stations not passed in for an hour
+   * are dropped. weatherUpdated is emitted once when all requests are done.
+   */
+  void preloadWeather(const QStringList& airportIdents);
+
+  /* Calls preloadWeather for all airports of the route. Airports near the route legs are added only if
+   * NOAA single station reports are used. */
+  void preloadRouteWeather(const Route& route);
+
+  /* Preloads weather for the changed route after edits settled */
+  void routeChanged(bool geometryChanged);
+
   /* Return true if the file at the given path exists and has valid content */
   static bool validateActiveSkyFile(const QString& path);
 
@@ -144,6 +168,29 @@ public:
     return activeSkyDestinationIdent;
   }
 
+  /* Cache for decoded reports of all sources */
+  MetarCache *getMetarCache() const
+  {
+    return metarCache;
+  }
+
+  /* Flight category and wind for visible airports */
+  AirportWeatherOverlay *getAirportWeatherOverlay() const
+  {
+    return airportWeatherOverlay;
+  }
+
+  /* Get report for station ident or empty string if not available */
+  typedef std::function<QString(const QString& ident)> MetarLookupFunc;
+  typedef std::pair<metar::Source, MetarLookupFunc> MetarLookup;
+
+  /*
+   * Get lookup functions for all enabled sources having station reports in memory in order of priority.
+   * Functions work on copies of the implicitly shared data and can be used in background threads.
+   * Sources which need requests for single stations are not included.
+   */
+  QVector<MetarLookup> getMetarLookups() const;
+
 signals:
   /* Emitted when Active Sky or X-Plane weather file changes or a request to weather was fullfilled */
   void weatherUpdated();
@@ -152,8 +199,9 @@ private:
   void activeSkyWeatherFileChanged(const QString& path);
   void xplaneWeatherFileChanged();
 
-  void loadActiveSkySnapshot(const QString& path);
-  void loadActiveSkyFlightplanSnapshot(const QString& path);
+  /* Both return true if the file was read and has changed */
+  bool loadActiveSkySnapshot(const QString& path);
+  bool loadActiveSkyFlightplanSnapshot(const QString& path);
   void initActiveSkyNext();
   void findActiveSkyFiles(QString& asnSnapshot, QString& flightplanSnapshot, const QString& activeSkyPrefix,
                           const QString& activeSkySimSuffix);
@@ -163,14 +211,62 @@ private:
   void createFsWatcher();
   void initXplane();
 
+  /* Load coordinates of all airports and pass them to the bulk readers for nearest station index.
+   * Also builds the airport grid. */
+  void updateAirportCoordinates();
+
+  /* Add keys of all airport grid cells within radius around pos */
+  static void airportGridCells(QSet<int>& cells, const atools::geo::Pos& pos, float radiusMeter);
+
+  /* Enable or disable bulk downloads depending on options */
+  void updateBulkReaders();
+  void enableBulkReader(WeatherBulkReader *reader, bool enable);
+
+  /* Remove all reports and drop reader from the current batch. Enabled readers download again on next update. */
+  void clearBulkReader(WeatherBulkReader *reader);
+
+  /* Collects signals of bulk readers to send only one weatherUpdated for a batch */
+  void bulkReaderWeatherUpdated(WeatherBulkReader *reader);
+  void bulkReaderUpdateFinished(WeatherBulkReader *reader);
+
   static void noaaIndexParser(QString& icao, QDateTime& lastUpdate, const QString& line);
   static atools::geo::Pos fetchAirportCoordinates(const QString& airportIdent);
 
+  /* Single station requests - only used if NOAA bulk URL is empty */
   atools::fs::weather::WeatherNetSingle *noaaWeather = nullptr;
-  atools::fs::weather::WeatherNetSingle *vatsimWeather = nullptr;
-  atools::fs::weather::WeatherNetDownload *ivaoWeather = nullptr;
 
-  QHash<QString, QString> activeSkyMetars;
+  WeatherBulkReader *noaaBulk = nullptr, *vatsimBulk = nullptr, *ivaoBulk = nullptr, *xplaneBulk = nullptr;
+
+  /* Single NOAA station reports requested by preloadWeather - only used if NOAA bulk URL is empty */
+  WeatherBulkReader *noaaStations = nullptr;
+  QHash<QString, qint64> noaaStationTimes; /* Station ident to time of last request in milliseconds since epoch */
+
+  /* Readers of the current preload batch which are not finished yet */
+  QSet<WeatherBulkReader *> batchReaders, enabledReaders;
+  bool batchUpdated = false;
+
+  /* Preload airports within this distance to the route legs */
+  float preloadTrackDistanceNm = 10.f;
+
+  /* URL for NOAA cycle files with placeholder for UTC hour */
+  QString noaaBulkUrl;
+
+  /* URLs from options used by the readers. Used to reload only readers with changed URLs. */
+  QString weatherNoaaUrl, weatherVatsimUrl, weatherIvaoUrl;
+
+  QHash<QString, atools::geo::Pos> airportCoordinates;
+
+  /* Airport idents by grid cell key to find airports near the route */
+  QHash<int, QVector<QString> > airportGrid;
+
+  /* Delays preloadRouteWeather while route is edited */
+  QTimer preloadRouteTimer;
+
+  MetarCache *metarCache = nullptr;
+  AirportWeatherOverlay *airportWeatherOverlay = nullptr;
+
+  ActiveSkySnapshot activeSkySnapshot;
+  ActiveSkySnapshot::FileStamp activeSkyFlightplanStamp;
   QString activeSkyDepartureMetar, activeSkyDestinationMetar,
           activeSkyDepartureIdent, activeSkyDestinationIdent;
 
@@ -178,8 +274,6 @@ private:
   QFileSystemWatcher *fsWatcher = nullptr;
   atools::fs::FsPaths::SimulatorType simType = atools::fs::FsPaths::UNKNOWN;
 
-  atools::fs::weather::XpWeatherReader *xpWeatherReader = nullptr;
-
   MainWindow *mainWindow;
 
   ActiveSkyType activeSkyType = NONE;